@@ -9,7 +9,7 @@ __version__ = '0.2.4'
 VERSION = __version__
 
 __all__ = ["SerialPort", "SerialPortOptions", "SerialPortEvent", 
-           "SerialPortParity", "set_async_worker", "SerialPortError"]
+           "SerialPortParity", "SerialPortIOEngine", "SerialPortSchedPolicy", "SerialPortReconfigure", "SerialPortReconnectPolicy", "SerialPortOverflowPolicy", "SerialPortLagPolicy", "SerialPortRS485", "set_async_worker", "SerialPortError"]
 
 sys_platform = sys.platform
     
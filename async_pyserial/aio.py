@@ -0,0 +1,338 @@
+import asyncio
+
+from async_pyserial.common import SerialPortOptions, SerialPortEvent, SerialPortError, PlatformNotSupported
+
+# the receive buffer of a transport when options.read_bufsize is smaller
+READ_BUFFER_LIMIT = 1 << 20
+
+class SerialTransport(asyncio.Transport):
+    """
+    An `asyncio.Transport` over an open `SerialPort`, made by `create_serial_connection()`.
+
+    Received data is buffered by the native core, which wakes the event loop through an eventfd once
+    per batch instead of calling into Python per chunk. Everything received since the last wakeup is
+    passed to `protocol.data_received()` at once, on the loop thread.
+
+    `pause_reading()` stops reading the device, so the driver applies flow control once its buffer fills.
+    Writes are queued natively, `protocol.pause_writing()` and `resume_writing()` are called around the
+    write buffer limits (64 KiB / 16 KiB by default).
+
+    The `SerialPort` is available as `get_extra_info('serial')`.
+    """
+    def __init__(self, loop: asyncio.AbstractEventLoop, protocol: asyncio.BaseProtocol, serial, read_limit: int = READ_BUFFER_LIMIT) -> None:
+        super().__init__(extra={'serial': serial, 'port_name': serial.portName})
+
+        self._loop = loop
+        self._protocol = protocol
+        self._serial = serial
+        self._internal = serial._internal
+
+        self._read_limit = max(read_limit, 1)
+
+        # batches are taken from the native buffer, no python callback per chunk
+        self._internal.set_read_buffer(self._read_limit)
+        self._internal.set_data_callback(None)
+
+        self._fd = self._internal.notify_fd()
+
+        self._reading = True
+        self._closing = False
+        self._conn_lost = False
+
+        self._protocol_paused = False
+        self._set_write_buffer_limits()
+
+        def on_disconnect():
+            loop.call_soon_threadsafe(self._on_disconnect)
+
+        serial.on(SerialPortEvent.ON_DISCONNECT, on_disconnect)
+
+        self._loop.add_reader(self._fd, self._on_notify)
+        self._loop.call_soon(self._protocol.connection_made, self)
+
+    def __repr__(self) -> str:
+        state = 'closed' if self._conn_lost else 'closing' if self._closing else 'open'
+        return f'<SerialTransport {self._serial.portName} {state}>'
+
+    def get_protocol(self):
+        return self._protocol
+
+    def set_protocol(self, protocol):
+        self._protocol = protocol
+
+    def is_closing(self) -> bool:
+        return self._closing
+
+    def is_reading(self) -> bool:
+        return self._reading and not self._closing
+
+    def pause_reading(self):
+        if self._closing or not self._reading:
+            return
+
+        self._reading = False
+        self._internal.pause_reading()
+
+    def resume_reading(self):
+        if self._closing or self._reading:
+            return
+
+        self._reading = True
+        self._internal.resume_reading()
+
+        # data buffered before the pause
+        if self._internal.in_waiting() > 0:
+            self._loop.call_soon(self._on_notify)
+
+    def _set_write_buffer_limits(self, high: int | None = None, low: int | None = None):
+        if high is None:
+            high = 64 * 1024 if low is None else 4 * low
+
+        if low is None:
+            low = high // 4
+
+        if not high >= low >= 0:
+            raise ValueError(f'high ({high!r}) must be >= low ({low!r}) must be >= 0')
+
+        self._high_water = high
+        self._low_water = low
+
+    def set_write_buffer_limits(self, high: int | None = None, low: int | None = None):
+        self._set_write_buffer_limits(high, low)
+        self._maybe_pause_protocol()
+
+    def get_write_buffer_limits(self) -> tuple[int, int]:
+        return (self._low_water, self._high_water)
+
+    def get_write_buffer_size(self) -> int:
+        return self._internal.write_buffer_size()
+
+    def write(self, data):
+        if not isinstance(data, (bytes, bytearray, memoryview)):
+            raise TypeError(f'data argument must be a bytes-like object, not {type(data).__name__!r}')
+
+        if self._conn_lost or not data:
+            return
+
+        if isinstance(data, memoryview) and not data.c_contiguous:
+            data = bytes(data)
+
+        # copied natively, completions only wake the loop through notify_fd()
+        self._internal.write(data, None)
+
+        self._maybe_pause_protocol()
+
+    def writelines(self, list_of_data):
+        """
+        Write the buffers as one unit, gathered natively instead of joined.
+        """
+        buffers = []
+
+        for data in list_of_data:
+            if not isinstance(data, (bytes, bytearray, memoryview)):
+                raise TypeError(f'data argument must be a bytes-like object, not {type(data).__name__!r}')
+
+            if isinstance(data, memoryview) and not data.c_contiguous:
+                data = bytes(data)
+
+            buffers.append(data)
+
+        if self._conn_lost or not buffers:
+            return
+
+        self._internal.write_many(buffers, None)
+
+        self._maybe_pause_protocol()
+
+    def can_write_eof(self) -> bool:
+        return False
+
+    def write_eof(self):
+        raise NotImplementedError('serial ports do not support write_eof()')
+
+    def close(self):
+        """
+        Stop reading and close the port once the queued writes are written, then call `protocol.connection_lost(None)`.
+        """
+        if self._closing:
+            return
+
+        self._closing = True
+        self._internal.pause_reading()
+
+        if self.get_write_buffer_size() == 0:
+            self._loop.call_soon(self._finish_close, None)
+
+    def abort(self):
+        """
+        Close the port at once, queued writes fail.
+        """
+        self._force_close(None)
+
+    def _on_notify(self):
+        if self._conn_lost:
+            return
+
+        data = self._internal.read_batch(self._read_limit if self.is_reading() else 0)
+
+        if data:
+            try:
+                self._protocol.data_received(data)
+            except (SystemExit, KeyboardInterrupt):
+                raise
+            except BaseException as exc:
+                self._fatal_error(exc, 'Fatal error: protocol.data_received() call failed.')
+                return
+
+        err = self._internal.take_write_error()
+
+        # with options.reconnect writes failing while disconnected are expected
+        if err != 0 and not self._serial.options.reconnect:
+            self._fatal_error(SerialPortError(f'Write Error: {err}'), 'Fatal write error on serial transport')
+            return
+
+        self._maybe_resume_protocol()
+
+        if self._closing and self.get_write_buffer_size() == 0:
+            self._finish_close(None)
+
+    def _on_disconnect(self):
+        if not self._serial.options.reconnect:
+            self._force_close(SerialPortError('serial port disconnected'))
+
+    def _maybe_pause_protocol(self):
+        if self._protocol_paused or self.get_write_buffer_size() <= self._high_water:
+            return
+
+        self._protocol_paused = True
+
+        try:
+            self._protocol.pause_writing()
+        except (SystemExit, KeyboardInterrupt):
+            raise
+        except BaseException as exc:
+            self._loop.call_exception_handler({
+                'message': 'protocol.pause_writing() failed',
+                'exception': exc,
+                'transport': self,
+                'protocol': self._protocol,
+            })
+
+    def _maybe_resume_protocol(self):
+        if not self._protocol_paused or self.get_write_buffer_size() > self._low_water:
+            return
+
+        self._protocol_paused = False
+
+        try:
+            self._protocol.resume_writing()
+        except (SystemExit, KeyboardInterrupt):
+            raise
+        except BaseException as exc:
+            self._loop.call_exception_handler({
+                'message': 'protocol.resume_writing() failed',
+                'exception': exc,
+                'transport': self,
+                'protocol': self._protocol,
+            })
+
+    def _fatal_error(self, exc: BaseException, message: str):
+        if not isinstance(exc, SerialPortError):
+            self._loop.call_exception_handler({
+                'message': message,
+                'exception': exc,
+                'transport': self,
+                'protocol': self._protocol,
+            })
+
+        self._force_close(exc)
+
+    def _force_close(self, exc: BaseException | None):
+        if self._conn_lost:
+            return
+
+        self._closing = True
+        self._loop.call_soon(self._finish_close, exc)
+
+    def _finish_close(self, exc: BaseException | None):
+        if self._conn_lost:
+            return
+
+        self._conn_lost = True
+
+        self._loop.remove_reader(self._fd)
+
+        try:
+            self._serial.close()
+        finally:
+            self._protocol.connection_lost(exc)
+
+async def create_serial_connection(loop: asyncio.AbstractEventLoop, protocol_factory, port: str,
+                                   options: SerialPortOptions | None = None):
+    """
+    Open `port` and connect it to a protocol, like `loop.create_connection()`.
+
+    Args:
+        loop (asyncio.AbstractEventLoop): The event loop running the protocol.
+        protocol_factory (Callable[[], asyncio.Protocol]): Returns the protocol.
+        port (str): The port name, e.g. '/dev/ttyUSB0'.
+        options (SerialPortOptions | None): The port options. The receive buffer holds
+            max(`read_bufsize`, 1 MiB) bytes, data received beyond it while the loop is busy is dropped.
+
+    Returns:
+        tuple[SerialTransport, asyncio.Protocol]
+
+    Raises:
+        PlatformNotSupported: On platforms other than linux.
+        SerialPortError: If the port cannot be opened.
+
+    Example:
+        transport, protocol = await create_serial_connection(loop, MyProtocol, '/dev/ttyUSB0')
+    """
+    from async_pyserial.native_serialport import SerialPort
+
+    if options is None:
+        options = SerialPortOptions()
+
+    serial = SerialPort(port, options)
+
+    if not hasattr(serial._internal, 'notify_fd'):
+        raise PlatformNotSupported('serial transports are only supported on linux')
+
+    try:
+        serial.open()
+    except RuntimeError as err:
+        raise SerialPortError(str(err)) from err
+
+    protocol = protocol_factory()
+
+    try:
+        transport = SerialTransport(loop, protocol, serial, max(options.read_bufsize, READ_BUFFER_LIMIT))
+    except BaseException:
+        serial.close()
+        raise
+
+    return transport, protocol
+
+async def open_serial_connection(port: str, options: SerialPortOptions | None = None, *, limit: int = 2 ** 16):
+    """
+    Open `port` as an `asyncio.StreamReader` and `asyncio.StreamWriter` pair, like `asyncio.open_connection()`.
+
+    `StreamWriter.drain()` waits while more than the write buffer high water mark is queued.
+
+    Example:
+        reader, writer = await open_serial_connection('/dev/ttyUSB0')
+        writer.write(b'AT\\r\\n')
+        await writer.drain()
+        line = await reader.readuntil(b'\\r\\n')
+    """
+    loop = asyncio.get_running_loop()
+
+    reader = asyncio.StreamReader(limit=limit, loop=loop)
+    protocol = asyncio.StreamReaderProtocol(reader, loop=loop)
+
+    transport, _ = await create_serial_connection(loop, lambda: protocol, port, options)
+
+    writer = asyncio.StreamWriter(transport, protocol, reader, loop)
+
+    return reader, writer
@@ -1,5 +1,8 @@
 from __future__ import annotations
-__all__ = ['SerialPort', 'SerialPortOptions']
+__all__ = ['SerialPort', 'SerialPortOptions', 'ThreadStatus', 'ReceiveStats', 'WriteStats', 'ScheduledWrite', 'BroadcastSubscriber', 'PatternMatch', 'PatternWatch', 'TimeoutException', 'LineIterator', 'PortGroup', 'PollScheduler', 'PollStats', 'trace_enable', 'trace_disable', 'trace_clear', 'trace_dump',
+           'Loopback', 'LoopbackOptions', 'LoopbackPair', 'LoopbackStats',
+           'Replayer', 'ReplayOptions', 'CaptureLog', 'CaptureLogOptions', 'CaptureLogStats',
+           'PortInfo', 'list_ports']
 class SerialPort:
     def __init__(self, arg0: str, arg1: SerialPortOptions) -> None:
         ...
@@ -7,10 +10,70 @@ class SerialPort:
         ...
     def open(self) -> None:
         ...
-    def write(self, data: str, callback: function) -> None:
+    def write(self, data: bytes, callback: function | None) -> None:
+        ...
+    def write_many(self, buffers: list[bytes], callback: function | None) -> None:
         ...
     def set_data_callback(self, callback: function) -> None:
         ...
+    def read(self, size: int, timeout_ms: int) -> bytes:
+        ...
+    def read_nowait(self, size: int) -> bytes:
+        ...
+    def read_until(self, delimiter: bytes, max_bytes: int, timeout_ms: int) -> bytes:
+        ...
+    def lines(self, delimiter: bytes, max_bytes: int, timeout_ms: int) -> LineIterator:
+        ...
+    def in_waiting(self) -> int:
+        ...
+    def write_all(self, data: bytes | list[bytes], timeout_ms: int) -> None:
+        ...
+    def set_read_buffer(self, capacity: int) -> None:
+        ...
+    def write_buffer_size(self) -> int:
+        ...
+    def start_recording(self, path: str) -> None:
+        ...
+    def stop_recording(self) -> None:
+        ...
+    def attach_capture_log(self, log: CaptureLog, channel: int) -> None:
+        ...
+    def detach_capture_log(self) -> None:
+        ...
+    def io_engine(self) -> int:
+        ...
+    def rs485_mode(self) -> int:
+        ...
+    def thread_status(self) -> ThreadStatus:
+        ...
+    def reconfigure(self, options: SerialPortOptions, mode: int) -> None:
+        ...
+    def set_event_callback(self, callback: function) -> None:
+        ...
+    def is_connected(self) -> bool:
+        ...
+    def pause_reading(self) -> None:
+        ...
+    def resume_reading(self) -> None:
+        ...
+    def notify_fd(self) -> int:
+        ...
+    def read_batch(self, size: int) -> bytes:
+        ...
+    def take_write_error(self) -> int:
+        ...
+    def receive_stats(self) -> ReceiveStats:
+        ...
+    def write_stats(self) -> WriteStats:
+        ...
+    def schedule_write(self, data: bytes, at_ns: int, period_ns: int) -> ScheduledWrite:
+        ...
+    def set_overflow_callback(self, callback: function) -> None:
+        ...
+    def subscribe(self, lag_policy: int) -> BroadcastSubscriber:
+        ...
+    def watch(self, patterns: list[bytes], context: int, callback: function) -> PatternWatch:
+        ...
 class SerialPortOptions:
     baudrate: int
     bytesize: int
@@ -18,5 +81,219 @@ class SerialPortOptions:
     stopbits: int
     read_timeout: int
     write_timeout: int
+    io_engine: int
+    read_buffer_size: int
+    read_budget: int
+    cpu_affinity: list[int]
+    sched_policy: int
+    sched_priority: int
+    thread_name: str
+    reconnect: bool
+    reconnect_interval: int
+    reconnect_max_interval: int
+    reconnect_write_policy: int
+    overflow_policy: int
+    broadcast_bufsize: int
+    rs485: int
+    rs485_rts_on_send: bool
+    rs485_delay_before_send: int
+    rs485_delay_after_send: int
+    rs485_suppress_echo: bool
     def __init__(self) -> None:
         ...
+class BroadcastSubscriber:
+    def read(self, size: int, timeout_ms: int) -> bytes:
+        ...
+    def read_into(self, buffer: bytearray | memoryview, timeout_ms: int) -> int:
+        ...
+    def available(self) -> int:
+        ...
+    def lost(self) -> int:
+        ...
+    def dropped(self) -> bool:
+        ...
+    def close(self) -> None:
+        ...
+class PatternMatch:
+    @property
+    def pattern(self) -> int:
+        ...
+    @property
+    def offset(self) -> int:
+        ...
+    @property
+    def context(self) -> bytes:
+        ...
+    @property
+    def context_offset(self) -> int:
+        ...
+class PatternWatch:
+    def close(self) -> None:
+        ...
+    def position(self) -> int:
+        ...
+    def matches(self) -> int:
+        ...
+class ReceiveStats:
+    overrun: int
+    buf_overrun: int
+    frame: int
+    parity: int
+    brk: int
+    dropped: int
+class WriteStats:
+    requests: int
+    heap_payloads: int
+    slab_allocations: int
+    pooled: int
+class ScheduledWrite:
+    def cancel(self) -> None:
+        ...
+    def active(self) -> bool:
+        ...
+    def fired(self) -> int:
+        ...
+    def missed(self) -> int:
+        ...
+class ThreadStatus:
+    applied: bool
+    cpu_affinity: list[int]
+    affinity_error: int
+    sched_policy: int
+    sched_priority: int
+    sched_error: int
+    name: str
+    name_error: int
+class PortGroup:
+    def __init__(self, callback: function, max_events: int, max_delay_us: int) -> None:
+        ...
+    def add(self, port: SerialPort, key: object) -> None:
+        ...
+    def remove(self, port: SerialPort) -> None:
+        ...
+    def close(self) -> None:
+        ...
+    def pending(self) -> int:
+        ...
+class PollScheduler:
+    def __init__(self, callback: function, changes_only: bool, max_results: int, max_delay_us: int) -> None:
+        ...
+    def add(self, port: SerialPort, request: bytes, length: int, terminator: bytes, max_bytes: int, period_us: int, timeout_us: int, key: object) -> None:
+        ...
+    def close(self) -> None:
+        ...
+    def stats(self) -> PollStats:
+        ...
+class PollStats:
+    requests: int
+    responses: int
+    timeouts: int
+    errors: int
+    unsolicited: int
+    suppressed: int
+class LineIterator:
+    def __iter__(self) -> LineIterator:
+        ...
+    def __next__(self) -> bytes:
+        ...
+class TimeoutException(TimeoutError):
+    ...
+def trace_enable(capacity: int = 65536) -> None:
+    ...
+def trace_disable() -> None:
+    ...
+def trace_clear() -> None:
+    ...
+def trace_dump() -> str:
+    ...
+class LoopbackOptions:
+    baudrate: int
+    bits_per_char: int
+    chunk_size: int
+    drop_rate: float
+    corrupt_rate: float
+    seed: int
+    def __init__(self) -> None:
+        ...
+class LoopbackPair:
+    port_a: str
+    port_b: str
+class LoopbackStats:
+    forwarded: int
+    dropped: int
+    corrupted: int
+class Loopback:
+    def __init__(self, arg0: LoopbackOptions) -> None:
+        ...
+    def open(self, arg0: int) -> list[LoopbackPair]:
+        ...
+    def close(self) -> None:
+        ...
+    def is_open(self) -> bool:
+        ...
+    def stats(self) -> LoopbackStats:
+        ...
+class ReplayOptions:
+    speed: float
+    loop: bool
+    include_tx: bool
+    def __init__(self) -> None:
+        ...
+class Replayer:
+    def __init__(self) -> None:
+        ...
+    def add_pty(self, path: str, options: ReplayOptions) -> str:
+        ...
+    def add_port(self, path: str, options: ReplayOptions, port: SerialPort) -> None:
+        ...
+    def start(self) -> None:
+        ...
+    def stop(self) -> None:
+        ...
+    def is_running(self) -> bool:
+        ...
+    def active(self) -> int:
+        ...
+    def wait(self, timeout_ms: int) -> bool:
+        ...
+class CaptureLogOptions:
+    directory: str
+    prefix: str
+    segment_size: int
+    max_segments: int
+    flush_interval_ms: int
+    def __init__(self) -> None:
+        ...
+class CaptureLogStats:
+    records: int
+    bytes: int
+    segments: int
+    dropped: int
+class CaptureLog:
+    def __init__(self, arg0: CaptureLogOptions) -> None:
+        ...
+    def close(self) -> None:
+        ...
+    def is_open(self) -> bool:
+        ...
+    def stats(self) -> CaptureLogStats:
+        ...
+    def current_segment(self) -> str:
+        ...
+class PortInfo:
+    device: str
+    name: str
+    subsystem: str
+    driver: str
+    hwid: str
+    vid: int
+    pid: int
+    interface_number: int
+    serial_number: str
+    manufacturer: str
+    product: str
+    interface: str
+    location: str
+    links: list[str]
+def list_ports(refresh: bool = False) -> list[PortInfo]:
+    ...
@@ -0,0 +1,89 @@
+from async_pyserial.common import SerialPortError
+
+class Subscriber:
+    """
+    An independent reader of everything a port receives, made by `SerialPort.subscribe()`.
+
+    All subscribers of a port read from one native ring written by the I/O thread, which never
+    waits for them. Each keeps its own position, so a parser, a logger and a monitor can all
+    see the full stream at their own pace. A subscriber that falls more than `broadcast_bufsize`
+    bytes behind is handled by its `SerialPortLagPolicy`.
+
+    Only one thread should read a subscriber at a time.
+
+    Example:
+        with serial.subscribe() as subscriber:
+            for chunk in subscriber:
+                log.write(chunk)
+    """
+    def __init__(self, internal) -> None:
+        self._internal = internal
+
+    def read(self, size: int = 65536, timeout: float | None = None) -> bytes:
+        """
+        Read up to `size` bytes, waiting natively with the GIL released until at least one is available.
+
+        Raises:
+            TimeoutError: If nothing arrives within `timeout` seconds (None waits forever).
+            SerialPortError: If the subscriber or the port is closed, or the subscriber was dropped.
+        """
+        try:
+            return self._internal.read(size, self._timeout_ms(timeout))
+        except TimeoutError:
+            raise
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def read_into(self, buffer, timeout: float | None = None) -> int:
+        """
+        Like `read()`, but copies straight from the ring into a writable buffer (e.g. a bytearray
+        or memoryview) and returns the number of bytes copied.
+        """
+        try:
+            return self._internal.read_into(buffer, self._timeout_ms(timeout))
+        except TimeoutError:
+            raise
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def in_waiting(self) -> int:
+        return self._internal.available()
+
+    @property
+    def lost(self) -> int:
+        """
+        The bytes skipped because this subscriber fell behind with `SerialPortLagPolicy.SKIP`.
+        """
+        return self._internal.lost()
+
+    def is_dropped(self) -> bool:
+        """
+        True once this subscriber fell behind with `SerialPortLagPolicy.DROP`, a new one must be made with `subscribe()`.
+        """
+        return self._internal.dropped()
+
+    def close(self):
+        """
+        Stop reading, a waiting `read()` raises `SerialPortError`.
+        """
+        self._internal.close()
+
+    def __iter__(self):
+        """
+        Yields chunks until the subscriber or the port is closed.
+        """
+        while True:
+            try:
+                yield self.read()
+            except SerialPortError:
+                return
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    @staticmethod
+    def _timeout_ms(timeout: float | None) -> int:
+        return -1 if timeout is None else max(int(timeout * 1000), 0)
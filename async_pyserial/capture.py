@@ -0,0 +1,110 @@
+import struct
+
+from async_pyserial.common import PlatformNotSupported
+
+SEGMENT_HEADER = struct.Struct('<4sHHII6Q')
+RECORD_HEADER = struct.Struct('<QIHBB')
+
+RX = 0
+TX = 1
+
+class CaptureLog:
+    """
+    Always-on capture log of serial traffic.
+
+    Chunks are appended by the native I/O threads to memory-mapped, preallocated segment
+    files, so logging costs a memory copy per chunk and never calls into Python.
+    Segments are named `<prefix>-<index>.seg` and a new one is started once `segment_size`
+    is reached.
+
+    Example:
+        log = CaptureLog('/var/log/serial')
+
+        serial.attach_capture_log(log, channel=1)
+        ...
+        log.close()
+
+    Args:
+        `directory` (str): Where the segments are written, created if missing.
+        `prefix` (str): Segment file name prefix. Default is 'capture'.
+        `segment_size` (int): Preallocated size of each segment in bytes. Default is 64 MiB.
+        `max_segments` (int): Remove the oldest segments beyond this count, 0 keeps everything. Default is 0.
+        `flush_interval_ms` (int): Schedule writeback of dirty pages at this interval, 0 leaves it to the kernel. Default is 1000.
+    """
+    def __init__(self, directory: str, prefix: str = 'capture', segment_size: int = 64 * 1024 * 1024,
+                 max_segments: int = 0, flush_interval_ms: int = 1000) -> None:
+        from async_pyserial import async_pyserial_core
+
+        if not hasattr(async_pyserial_core, 'CaptureLog'):
+            raise PlatformNotSupported('capture log is only supported on linux')
+
+        options = async_pyserial_core.CaptureLogOptions()
+        options.directory = directory
+        options.prefix = prefix
+        options.segment_size = segment_size
+        options.max_segments = max_segments
+        options.flush_interval_ms = flush_interval_ms
+
+        self._internal = async_pyserial_core.CaptureLog(options)
+
+    def close(self):
+        """
+        Seal the current segment. Chunks of still attached ports are dropped afterwards.
+        """
+        self._internal.close()
+
+    def is_open(self) -> bool:
+        return self._internal.is_open()
+
+    def current_segment(self) -> str:
+        return self._internal.current_segment()
+
+    def stats(self) -> dict:
+        stats = self._internal.stats()
+
+        return {
+            'records': stats.records,
+            'bytes': stats.bytes,
+            'segments': stats.segments,
+            'dropped': stats.dropped
+        }
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+def read_segment(path: str):
+    """
+    Iterate over the records of a segment file, including the one still being written.
+
+    Only records before the committed tail marker are returned, so a segment left behind
+    by a crashed process never yields a partial record.
+
+    Yields:
+        tuple[int, int, int, bytes]: The monotonic timestamp in nanoseconds, channel, direction (`RX` or `TX`) and data.
+    """
+    with open(path, 'rb') as f:
+        content = f.read()
+
+    magic, version, _flags, header_size, _reserved, _index, _size, \
+        _created_realtime, _created_monotonic, committed, _records = SEGMENT_HEADER.unpack_from(content)
+
+    if magic != b'APSC' or version != 1:
+        raise ValueError(f'invalid capture segment: {path}')
+
+    offset = header_size
+    end = min(committed, len(content))
+
+    while offset + RECORD_HEADER.size <= end:
+        ts_ns, size, channel, direction, _ = RECORD_HEADER.unpack_from(content, offset)
+
+        start = offset + RECORD_HEADER.size
+
+        if start + size > end:
+            break
+
+        yield ts_ns, channel, direction, content[start:start + size]
+
+        offset = (start + size + 7) & ~7
@@ -61,12 +61,51 @@ class SerialPortOptions:
         `parity` (SerialPortParity): The parity check setting. Default is SerialPortParity.NONE.
                                    Options are SerialPortParity.NONE (0), SerialPortParity.ODD (1), 
                                    SerialPortParity.EVEN (2).
-        `write_timeout` (int): The write timeout in milliseconds. Default is 50.
+        `write_timeout` (int): The write timeout in milliseconds, plus the line time of the write and of
+            the output the driver still holds on Linux. Default is 50.
         `read_timeout` (int): The read timeout in milliseconds. Default is 50.
         `read_bufsize` (int): The read buffer size. Default is 0. When read_bufsize is 0, the internal buffer 
                             is not used, and the user will only get the data received after the read call. 
                             If read_bufsize is not 0, the user will get the data present in the internal buffer
                             as well as any new data received after the read call.
+        `io_engine` (SerialPortIOEngine): The I/O engine on linux. Default is SerialPortIOEngine.EPOLL.
+                                   SerialPortIOEngine.IO_URING shares one io_uring instance between all ports
+                                   and falls back to epoll when io_uring is unavailable. Ignored on other platforms.
+        `read_buffer_size` (int): The minimum size of each native read on linux. Reads are sized by the bytes
+                                  waiting in the driver, with io_uring the first port opened sizes the shared
+                                  buffers. Default is 1024.
+        `read_budget` (int): The max bytes read per wakeup on linux. Everything read in one wakeup is delivered
+                             as a single `SerialPortEvent.ON_DATA` event. Default is 65536.
+        `cpu_affinity` (list[int]): The CPUs the I/O worker thread may run on, linux only. Default is [], any CPU.
+        `sched_policy` (SerialPortSchedPolicy): The scheduling policy of the I/O worker thread, linux only.
+                                   Default is SerialPortSchedPolicy.OTHER.
+        `sched_priority` (int): The real-time priority used with SerialPortSchedPolicy.FIFO and RR. Default is 0.
+        `thread_name` (str): The I/O worker thread name, linux only. Default is '', meaning `serial:<device>`.
+                             Options that cannot be applied are reported by `SerialPort.thread_status()`.
+        `reconnect` (bool): Supervise the port on linux. When the device hangs up or fails, emit
+                            `SerialPortEvent.ON_DISCONNECT` and reopen it with the same options when it reappears,
+                            then emit `SerialPortEvent.ON_RECONNECT`. Uses the epoll engine. Default is False.
+        `reconnect_interval` (int): The ms before the first retry, doubled after each failed retry. Device
+                                    directories are also watched with inotify to retry at once. Default is 100.
+        `reconnect_max_interval` (int): The max ms between retries. Default is 5000.
+        `reconnect_write_policy` (SerialPortReconnectPolicy): What happens to writes while disconnected.
+                                   Default is SerialPortReconnectPolicy.FAIL_WRITES.
+        `overflow_policy` (SerialPortOverflowPolicy): What happens when `read_bufsize` bytes are buffered.
+                                   SerialPortOverflowPolicy.DROP (default) drops the rest and emits
+                                   `SerialPortEvent.ON_OVERFLOW`. SerialPortOverflowPolicy.PAUSE stops reading the
+                                   device until reads make room, so the driver applies flow control (linux only).
+        `broadcast_bufsize` (int): The bytes kept for `SerialPort.subscribe()` subscribers, linux only. The ring is
+                                   allocated by the first subscription. Default is 1 MiB.
+        `rs485` (SerialPortRS485): RS-485 half duplex with RTS as the driver enable, linux only. Default is
+                                   SerialPortRS485.OFF. SerialPortRS485.KERNEL enables it with `TIOCSRS485`, and when
+                                   the driver has no RS-485 mode the I/O worker toggles RTS around each transmission,
+                                   releasing the bus once `TIOCOUTQ` reports the output sent. SerialPortRS485.SOFTWARE
+                                   always toggles it in user space. The user-space toggle uses the epoll engine.
+        `rs485_rts_on_send` (bool): RTS is high while sending and low while idle, False inverts it. Default is True.
+        `rs485_delay_before_send` (int): The ms from enabling the driver to the first bit. Default is 0.
+        `rs485_delay_after_send` (int): The ms from the last bit to disabling the driver. Default is 0.
+        `rs485_suppress_echo` (bool): Drop the local echo of our own transmissions from the received data,
+                                      linux only. Default is False.
     """
     def __init__(self) -> None:
         self.baudrate = 9600
@@ -76,10 +115,61 @@ class SerialPortOptions:
         self.write_timeout = 50
         self.read_timeout = 50
         self.read_bufsize = 0
+        self.io_engine = SerialPortIOEngine.EPOLL
+        self.read_buffer_size = 1024
+        self.read_budget = 65536
+        self.cpu_affinity = []
+        self.sched_policy = SerialPortSchedPolicy.OTHER
+        self.sched_priority = 0
+        self.thread_name = ''
+        self.reconnect = False
+        self.reconnect_interval = 100
+        self.reconnect_max_interval = 5000
+        self.reconnect_write_policy = SerialPortReconnectPolicy.FAIL_WRITES
+        self.overflow_policy = SerialPortOverflowPolicy.DROP
+        self.broadcast_bufsize = 1 << 20
+        self.rs485 = SerialPortRS485.OFF
+        self.rs485_rts_on_send = True
+        self.rs485_delay_before_send = 0
+        self.rs485_delay_after_send = 0
+        self.rs485_suppress_echo = False
 
 class SerialPortEvent:
     ON_DATA = 'data'
+    ON_DISCONNECT = 'disconnect'
+    ON_RECONNECT = 'reconnect'
+    ON_OVERFLOW = 'overflow'
     
+class SerialPortIOEngine:
+    EPOLL = 0
+    IO_URING = 1
+
+class SerialPortReconnectPolicy:
+    FAIL_WRITES = 0
+    BUFFER_WRITES = 1
+
+class SerialPortOverflowPolicy:
+    DROP = 0
+    PAUSE = 1
+
+class SerialPortLagPolicy:
+    SKIP = 0
+    DROP = 1
+
+class SerialPortRS485:
+    OFF = 0
+    KERNEL = 1
+    SOFTWARE = 2
+
+class SerialPortReconfigure:
+    NOW = 0
+    DRAIN = 1
+
+class SerialPortSchedPolicy:
+    OTHER = 0
+    FIFO = 1
+    RR = 2
+
 class SerialPortParity:
     NONE = 0
     ODD = 1
@@ -95,14 +185,40 @@ class SerialPortBase(EventEmitter):
         self.portName = portName
         
         self.options = options
-        self.internal_options = async_pyserial_core.SerialPortOptions()
+        self.internal_options = self._to_internal_options(options)
+
+    @staticmethod
+    def _to_internal_options(options: SerialPortOptions):
+        from async_pyserial import async_pyserial_core
+
+        internal_options = async_pyserial_core.SerialPortOptions()
         
-        self.internal_options.baudrate = options.baudrate
-        self.internal_options.bytesize = options.bytesize
-        self.internal_options.stopbits = options.stopbits
-        self.internal_options.parity = options.parity
-        self.internal_options.write_timeout = options.write_timeout
-        self.internal_options.read_timeout = options.read_timeout
+        internal_options.baudrate = options.baudrate
+        internal_options.bytesize = options.bytesize
+        internal_options.stopbits = options.stopbits
+        internal_options.parity = options.parity
+        internal_options.write_timeout = options.write_timeout
+        internal_options.read_timeout = options.read_timeout
+        internal_options.io_engine = options.io_engine
+        internal_options.read_buffer_size = options.read_buffer_size
+        internal_options.read_budget = options.read_budget
+        internal_options.cpu_affinity = list(options.cpu_affinity)
+        internal_options.sched_policy = options.sched_policy
+        internal_options.sched_priority = options.sched_priority
+        internal_options.thread_name = options.thread_name
+        internal_options.reconnect = options.reconnect
+        internal_options.reconnect_interval = options.reconnect_interval
+        internal_options.reconnect_max_interval = options.reconnect_max_interval
+        internal_options.reconnect_write_policy = options.reconnect_write_policy
+        internal_options.overflow_policy = options.overflow_policy
+        internal_options.broadcast_bufsize = options.broadcast_bufsize
+        internal_options.rs485 = options.rs485
+        internal_options.rs485_rts_on_send = options.rs485_rts_on_send
+        internal_options.rs485_delay_before_send = options.rs485_delay_before_send
+        internal_options.rs485_delay_after_send = options.rs485_delay_after_send
+        internal_options.rs485_suppress_echo = options.rs485_suppress_echo
+
+        return internal_options
 
 class SerialPortError(Exception):
     pass
\ No newline at end of file
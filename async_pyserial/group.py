@@ -0,0 +1,77 @@
+from typing import Callable
+
+from async_pyserial.common import SerialPortError
+
+class PortGroup:
+    """
+    Delivers the received data and write completions of many ports to one callback, in batches.
+
+    Without a group every port takes the GIL for each chunk it receives, so with hundreds of ports
+    their I/O threads contend for it. Ports added to a group queue their events natively instead,
+    and a group thread passes them to `callback` as one list, once `max_events` are queued or the
+    oldest waited `max_delay` seconds, taking the GIL once per batch.
+
+    Each event is a tuple `(key, kind, payload)`: `PortGroup.DATA` with the received bytes, or
+    `PortGroup.WRITE` with the error code of a completed write (0 on success). The callbacks passed
+    to `SerialPort.write()` are still called, in the same batch and before `callback`.
+    `SerialPortEvent.ON_DATA` listeners of a port in a group are not called, blocking reads work as usual.
+
+    Example:
+        def on_events(events):
+            for key, kind, payload in events:
+                if kind == PortGroup.DATA:
+                    parsers[key].feed(payload)
+
+        with PortGroup(on_events, max_events=512, max_delay=0.002) as group:
+            for name, serial in ports.items():
+                group.add(serial, name)
+            ...
+
+    Args:
+        `callback` (Callable[[list[tuple]], None]): Called on the group thread.
+        `max_events` (int): Deliver once this many events are queued. Default is 256.
+        `max_delay` (float): Deliver once the oldest queued event waited this many seconds. Default is 1 ms.
+    """
+    DATA = 0
+    WRITE = 1
+
+    def __init__(self, callback: Callable, max_events: int = 256, max_delay: float = 0.001) -> None:
+        from async_pyserial import async_pyserial_core
+
+        self._internal = async_pyserial_core.PortGroup(callback, max(max_events, 1), max(int(max_delay * 1000000), 0))
+
+    def add(self, serial, key=None):
+        """
+        Deliver the events of `serial` tagged with `key`, the port itself by default.
+
+        Raises:
+            SerialPortError: If the port is in another group or this group is closed.
+        """
+        try:
+            self._internal.add(serial._internal, serial if key is None else key)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def remove(self, serial):
+        """
+        Return `serial` to delivering its own events, the ones already queued are still delivered here.
+        """
+        self._internal.remove(serial._internal)
+
+    def pending(self) -> int:
+        return self._internal.pending()
+
+    def close(self):
+        """
+        Remove every port and deliver the queued events. Cannot be called from `callback`.
+        """
+        try:
+            self._internal.close()
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
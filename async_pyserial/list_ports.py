@@ -0,0 +1,63 @@
+from async_pyserial.common import PlatformNotSupported
+
+class PortInfo:
+    """
+    A serial port found by `list_ports()`.
+
+    Attributes:
+        `device` (str): The device path, e.g. '/dev/ttyUSB0'.
+        `name` (str): The device name, e.g. 'ttyUSB0'.
+        `subsystem` (str): The bus of the device the port belongs to, e.g. 'usb', 'usb-serial', 'pci' or 'pnp'.
+        `driver` (str): The driver of that device.
+        `hwid` (str): The sysfs path of that device.
+        `vid` (int | None): The usb vendor id.
+        `pid` (int | None): The usb product id.
+        `serial_number` (str | None): The usb serial number.
+        `manufacturer` (str | None): The usb manufacturer string.
+        `product` (str | None): The usb product string.
+        `interface` (str | None): The usb interface string.
+        `interface_number` (int | None): The usb interface number, to tell apart the ports of multi-port adapters.
+        `location` (str | None): The usb port path and interface, e.g. '1-1.2:1.0'.
+        `links` (list[str]): The /dev/serial/by-id and /dev/serial/by-path symlinks to the device.
+    """
+    def __init__(self, info) -> None:
+        self.device = info.device
+        self.name = info.name
+        self.subsystem = info.subsystem
+        self.driver = info.driver
+        self.hwid = info.hwid
+        self.vid = info.vid if info.vid >= 0 else None
+        self.pid = info.pid if info.pid >= 0 else None
+        self.serial_number = info.serial_number or None
+        self.manufacturer = info.manufacturer or None
+        self.product = info.product or None
+        self.interface = info.interface or None
+        self.interface_number = info.interface_number if info.interface_number >= 0 else None
+        self.location = info.location or None
+        self.links = list(info.links)
+
+    def __repr__(self) -> str:
+        if self.vid is not None:
+            return f'PortInfo({self.device!r}, vid=0x{self.vid:04x}, pid=0x{self.pid:04x}, serial_number={self.serial_number!r})'
+
+        return f'PortInfo({self.device!r}, subsystem={self.subsystem!r})'
+
+def list_ports(refresh: bool = False) -> list[PortInfo]:
+    """
+    List the serial ports backed by a device, sorted by device path.
+
+    Ports are read natively from /sys/class/tty and the usb descriptors in sysfs. The result is
+    cached until an entry in /dev or /dev/serial changes, so repeated calls cost no scan.
+
+    Args:
+        `refresh` (bool): Scan even when nothing changed.
+
+    Note:
+        list_ports is only supported on linux.
+    """
+    from async_pyserial import async_pyserial_core
+
+    if not hasattr(async_pyserial_core, 'list_ports'):
+        raise PlatformNotSupported('list_ports is only supported on linux')
+
+    return [PortInfo(info) for info in async_pyserial_core.list_ports(refresh)]
@@ -0,0 +1,89 @@
+from async_pyserial.common import PlatformNotSupported
+
+class LoopbackOptions:
+    """
+    LoopbackOptions class defines how data is carried between the two ports of a loopback pair.
+
+    Attributes:
+        `baudrate` (int): The emulated line rate. Default is 0, which means unlimited.
+        `bits_per_char` (int): Bits per character on the emulated line (start, data, parity and stop bits). Default is 10.
+        `chunk_size` (int): The maximum number of bytes delivered to the peer per write. Default is 0, which means unlimited.
+        `drop_rate` (float): The probability that a received chunk is dropped. Default is 0.
+        `corrupt_rate` (float): The probability that a byte gets one bit flipped. Default is 0.
+        `seed` (int): The seed of the fault injection random generator. Default is 0.
+    """
+    def __init__(self) -> None:
+        self.baudrate = 0
+        self.bits_per_char = 10
+        self.chunk_size = 0
+        self.drop_rate = 0.0
+        self.corrupt_rate = 0.0
+        self.seed = 0
+
+class Loopback:
+    """
+    In-process virtual serial port pairs built on `openpty()`, replacing an external `socat` process.
+
+    Every pair is made of two pseudo terminals; data written to one port is read from the other.
+    All pairs are pumped by a single native thread.
+
+    Example:
+        with Loopback() as loopback:
+            (port_a, port_b), = loopback.open(1)
+    """
+    def __init__(self, options: LoopbackOptions | None = None) -> None:
+        from async_pyserial import async_pyserial_core
+
+        if not hasattr(async_pyserial_core, 'Loopback'):
+            raise PlatformNotSupported('loopback ports are only supported on linux')
+
+        if options is None:
+            options = LoopbackOptions()
+
+        self.options = options
+
+        internal_options = async_pyserial_core.LoopbackOptions()
+        internal_options.baudrate = options.baudrate
+        internal_options.bits_per_char = options.bits_per_char
+        internal_options.chunk_size = options.chunk_size
+        internal_options.drop_rate = options.drop_rate
+        internal_options.corrupt_rate = options.corrupt_rate
+        internal_options.seed = options.seed
+
+        self._internal = async_pyserial_core.Loopback(internal_options)
+
+    def open(self, count: int = 1) -> list:
+        """
+        Create `count` linked port pairs.
+
+        Returns:
+            list[tuple[str, str]]: The device paths of each pair.
+        """
+        pairs = self._internal.open(count)
+
+        return [(pair.port_a, pair.port_b) for pair in pairs]
+
+    def close(self):
+        self._internal.close()
+
+    def is_open(self):
+        return self._internal.is_open()
+
+    def stats(self) -> dict:
+        """
+        Returns:
+            dict: The number of `forwarded`, `dropped` and `corrupted` bytes.
+        """
+        s = self._internal.stats()
+
+        return {
+            'forwarded': s.forwarded,
+            'dropped': s.dropped,
+            'corrupted': s.corrupted,
+        }
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
@@ -1,13 +1,11 @@
-from async_pyserial.common import SerialPortOptions, SerialPortEvent, SerialPortBase, SerialPortError
+from async_pyserial.common import SerialPortOptions, SerialPortEvent, SerialPortBase, SerialPortError, PlatformNotSupported, SerialPortReconfigure, SerialPortLagPolicy
 
 from typing import Callable
 
-from concurrent.futures import Future
+import time
 
 from async_pyserial import backend
 
-from threading import RLock
-
 class SerialPort(SerialPortBase):
     def __init__(self, portName: str, options: SerialPortOptions) -> None:
         
@@ -21,22 +19,29 @@ class SerialPort(SerialPortBase):
         
         self._read_bufsize = options.read_bufsize
         
-        self._read_buf = b''
-        
-        self._rlock = RLock()
+        # received data is kept natively, up to read_bufsize bytes
+        self._internal.set_read_buffer(max(self._read_bufsize, 0))
             
         def on_receieved(data):
-            if self._read_bufsize > 0:
-                with self._rlock:
-                    actual_size = min(len(data), max(self._read_bufsize - len(self._read_buf), 0))
-                    
-                    if actual_size > 0:
-                        self._read_buf += data[:actual_size]
-            
             self.emit(SerialPortEvent.ON_DATA, data)
         
         self._internal.set_data_callback(on_receieved)
 
+        if hasattr(self._internal, 'set_event_callback'):
+            # ON_DISCONNECT: 2, ON_RECONNECT: 3
+            events = {2: SerialPortEvent.ON_DISCONNECT, 3: SerialPortEvent.ON_RECONNECT}
+
+            def on_event(event):
+                self.emit(events[event])
+
+            self._internal.set_event_callback(on_event)
+
+        if hasattr(self._internal, 'set_overflow_callback'):
+            def on_overflow(increment):
+                self.emit(SerialPortEvent.ON_OVERFLOW, increment)
+
+            self._internal.set_overflow_callback(on_overflow)
+
     def _calculate_stt(self, data_size):
         """
         Calculate the Serial Transmission Time (STT).
@@ -51,12 +56,16 @@ class SerialPort(SerialPortBase):
         stt = (data_size * 10) / self.options.baudrate
         return stt
     
-    def read(self, bufsize: int = 512, callback: Callable | None = None):
+    def read(self, bufsize: int = 512, callback: Callable | None = None, timeout: float | None = None):
         """
         Read data from the serial port. If a callback is provided, the read will be asynchronous and 
         the callback will be called with the read data. Otherwise, the read will be synchronous or asynchronous
         depending on whether an async_worker is set.
 
+        A synchronous read waits natively with the GIL released and returns as soon as some data,
+        at most `bufsize` bytes, is available. It raises TimeoutError when nothing arrives within
+        `timeout` seconds (None waits forever).
+
         Note:
             It is recommended to set SerialPortEvent.ON_DATA to receive data.
             If you use read(), ensure that the read_bufsize in options is set appropriately
@@ -83,7 +92,7 @@ class SerialPort(SerialPortBase):
         elif callback is not None:
             self._callback_read(bufsize, callback)
         else:
-            return self._sync_read(bufsize)
+            return self._sync_read(bufsize, timeout)
         
     def _callback_read(self, bufsize: int, callback: Callable):
         if self._read_bufsize <= 0:            
@@ -100,45 +109,32 @@ class SerialPort(SerialPortBase):
             
             return
         
-        if self._read_buf != b'':
+        if self._internal.in_waiting() > 0:
             # some data have in internal read buf
             # return buf with max bufsize directly
-            with self._rlock:
-                actual_size = min(len(self._read_buf), bufsize)
-                
-                buf = self._read_buf[:actual_size]
-                
-                self._read_buf = self._read_buf[actual_size:]
-                
-            callback(buf)
+            callback(self._internal.read_nowait(bufsize))
                 
             return
                 
         def on_receieved(_: bytes):
             self.off(SerialPortEvent.ON_DATA, on_receieved)
             
-            # read from _read_buf
-            actual_size = min(len(self._read_buf), bufsize)
-
-            print(f'size: {len(self._read_buf)}')
-                
-            buf = self._read_buf[:actual_size]
-            
-            self._read_buf = self._read_buf[actual_size:]
-            
-            callback(buf)
+            # the chunk is already in the native read buf
+            callback(self._internal.read_nowait(bufsize))
             
         self.on(SerialPortEvent.ON_DATA, on_receieved)
         
-    def _sync_read(self, bufsize: int):
-        future = Future()
-        
-        def on_receieved(data):
-            future.set_result(data)
-        
-        self._callback_read(bufsize, on_receieved)
-        
-        return future.result()
+    def _sync_read(self, bufsize: int, timeout: float | None = None):
+        try:
+            return self._internal.read(bufsize, self._timeout_ms(timeout))
+        except TimeoutError:
+            raise
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    @staticmethod
+    def _timeout_ms(timeout: float | None) -> int:
+        return -1 if timeout is None else max(int(timeout * 1000), 0)
         
     def _gevent_read(self, bufsize: int):
         
@@ -224,7 +220,7 @@ class SerialPort(SerialPortBase):
             the write method will use asynchronous processing.
 
         Args:
-            data (bytes): The data to be written to the serial port.
+            data (bytes): The data to be written to the serial port, any bytes-like object.
             callback (Callable, optional): The callback to be called with the result of the write operation.
 
         Raises:
@@ -240,6 +236,28 @@ class SerialPort(SerialPortBase):
             self._callback_write(data, callback)
         else:
             self._sync_write(data)
+
+    def write_many(self, buffers, callback: Callable | None = None):
+        """
+        Write several buffers as one unit, e.g. a header, a payload and a CRC trailer, without joining them
+        in Python. They are gathered natively into a single queued write with a single completion and nothing
+        else is written between them. Blocks or not like `write()`.
+
+        Args:
+            buffers (Iterable): Bytes-like objects written back to back, copied before returning.
+            callback (Callable, optional): The callback to be called once with the result of the write operation.
+
+        Raises:
+            SerialPortError: If the write operation fails.
+        """
+        return self.write(list(buffers), callback)
+
+    @staticmethod
+    def _nbytes(data) -> int:
+        if isinstance(data, list):
+            return sum(memoryview(buffer).nbytes for buffer in data)
+
+        return len(data)
             
     def _callback_write(self, data: bytes, callback: Callable):
         def cb(err):
@@ -251,7 +269,10 @@ class SerialPort(SerialPortBase):
             
             callback(None)
             
-        self._internal.write(data, cb)
+        if isinstance(data, list):
+            self._internal.write_many(data, cb)
+        else:
+            self._internal.write(data, cb)
         
     def _gevent_write(self, data: bytes):
         import gevent
@@ -264,7 +285,7 @@ class SerialPort(SerialPortBase):
 
         self._callback_write(data, cb)
 
-        stt = self._calculate_stt(len(data))
+        stt = self._calculate_stt(self._nbytes(data))
         wt = stt / 20.0
 
         if wt > 0.05:
@@ -300,7 +321,7 @@ class SerialPort(SerialPortBase):
 
         self._callback_write(data, cb)
 
-        stt = self._calculate_stt(len(data))
+        stt = self._calculate_stt(self._nbytes(data))
         wt = stt / 20.0
 
         if wt > 0.05:
@@ -335,19 +356,53 @@ class SerialPort(SerialPortBase):
 
         return future
     
-    def _sync_write(self, data: bytes):
-        future = Future()
+    def read_until(self, delimiter: bytes = b'\n', max_bytes: int = 65536, timeout: float | None = None) -> bytes:
+        """
+        Read through the first `delimiter`, waiting natively with the GIL released. The delimiter search
+        runs in the native core and resumes where the previous one stopped as data arrives.
 
-        def cb(err):
-            if err is not None:
-                future.set_exception(err)
-                return
-            
-            future.set_result(None)
+        Returns:
+            bytes: The data including the delimiter, or `max_bytes` bytes when no delimiter is found within them.
 
-        self._callback_write(data, cb)
+        Raises:
+            TimeoutError: If no delimiter arrives within `timeout` seconds (None waits forever). The data stays buffered.
+            SerialPortError: If the port is not open or gets closed.
+        """
+        try:
+            return self._internal.read_until(delimiter, max_bytes, self._timeout_ms(timeout))
+        except TimeoutError:
+            raise
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def readline(self, timeout: float | None = None) -> bytes:
+        return self.read_until(b'\n', timeout=timeout)
+
+    def lines(self, delimiter: bytes = b'\n', max_bytes: int = 65536, timeout: float | None = None):
+        """
+        Iterate over `read_until(delimiter, max_bytes, timeout)` results natively until the port is closed.
+        """
+        return self._internal.lines(delimiter, max_bytes, self._timeout_ms(timeout))
 
-        future.result()
+    def _sync_write(self, data: bytes):
+        self.write_all(data)
+
+    def write_all(self, data: bytes, timeout: float | None = None):
+        """
+        Write data and wait natively, with the GIL released, until it is written.
+        `data` may also be a list of bytes-like objects, written as one like `write_many()`.
+
+        Raises:
+            TimeoutError: If the data is not written within `timeout` seconds (None waits forever).
+                          The data stays queued and is written later.
+            SerialPortError: If the write operation fails.
+        """
+        try:
+            self._internal.write_all(data, self._timeout_ms(timeout))
+        except TimeoutError:
+            raise
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
         
     def open(self):
         self._internal.open()
@@ -358,4 +413,268 @@ class SerialPort(SerialPortBase):
         self._is_open = False
 
     def is_open(self):
-        return self._is_open
\ No newline at end of file
+        return self._is_open
+
+    def is_connected(self):
+        """
+        Returns:
+            bool: False while a port opened with `options.reconnect` waits for its device to come back,
+            otherwise the same as `is_open()`.
+        """
+        if not hasattr(self._internal, 'is_connected'):
+            return self._is_open
+
+        return self._internal.is_connected()
+
+    def receive_stats(self):
+        """
+        Returns:
+            ReceiveStats | None: Received data lost since the port was opened on linux. `overrun`, `buf_overrun`,
+            `frame`, `parity` and `brk` are the driver counters (`TIOCGICOUNT`, always 0 for ptys and drivers
+            without them), `dropped` counts the bytes that did not fit in `read_bufsize`. None on other platforms.
+
+        Note:
+            `SerialPortEvent.ON_OVERFLOW` listeners receive the same fields holding the increments.
+        """
+        if not hasattr(self._internal, 'receive_stats'):
+            return None
+
+        return self._internal.receive_stats()
+
+    def write_stats(self):
+        """
+        Returns:
+            WriteStats | None: How write requests were allocated on linux. `requests` counts the writes queued,
+            `heap_payloads` those over 64 bytes, whose data is copied to the heap instead of the pooled request,
+            `slab_allocations` the slabs of 64 requests the pool grew by and `pooled` the requests it holds.
+            None on other platforms.
+        """
+        if not hasattr(self._internal, 'write_stats'):
+            return None
+
+        return self._internal.write_stats()
+
+    def schedule_write(self, data: bytes, at: int | None = None):
+        """
+        Write `data` once at `at`, a `time.monotonic_ns()` time, without waking Python.
+
+        The write is queued by the I/O thread when a timerfd expires, so it is not delayed by the GIL or
+        an event loop. A time in the past, or None, writes at once.
+
+        Returns:
+            ScheduledWrite: `cancel()` drops the write if it is not queued yet, `active()` is False once it is
+            queued or cancelled, `fired()` is 1 once queued and `missed()` 1 if the device was disconnected then.
+
+        Note:
+            Scheduled writes are only supported on linux.
+        """
+        if not hasattr(self._internal, 'schedule_write'):
+            raise PlatformNotSupported('schedule_write is only supported on linux')
+
+        if at is None:
+            at = time.monotonic_ns()
+
+        try:
+            return self._internal.schedule_write(bytes(data), max(at, 0), 0)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def write_periodic(self, data: bytes, period_us: int, start: int | None = None):
+        """
+        Write `data` every `period_us` microseconds from `start`, a `time.monotonic_ns()` time (default now),
+        until cancelled or the port is closed, for heartbeats and polling frames.
+
+        Each write is due one period after the previous deadline, not after the previous write, so the
+        writes do not drift. Periods the I/O thread wakes up too late for, or that come while the device is
+        disconnected, are skipped instead of written in a burst and counted by `missed()`.
+
+        Returns:
+            ScheduledWrite: `cancel()` stops the writes, `fired()` counts those queued and `missed()` those skipped.
+
+        Note:
+            Scheduled writes are only supported on linux.
+        """
+        if not hasattr(self._internal, 'schedule_write'):
+            raise PlatformNotSupported('write_periodic is only supported on linux')
+
+        if period_us <= 0:
+            raise ValueError('period_us must be positive')
+
+        if start is None:
+            start = time.monotonic_ns()
+
+        try:
+            return self._internal.schedule_write(bytes(data), max(start, 0), int(period_us) * 1000)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def subscribe(self, lag_policy: int = SerialPortLagPolicy.SKIP):
+        """
+        Make an independent reader of every byte received from now on, without any Python listener.
+
+        Args:
+            lag_policy (SerialPortLagPolicy): What happens when the subscriber falls more than `broadcast_bufsize`
+                bytes behind. `SerialPortLagPolicy.SKIP` (default) continues at the oldest byte still buffered and
+                counts the skipped ones in `lost`, `SerialPortLagPolicy.DROP` makes its reads fail.
+
+        Returns:
+            async_pyserial.broadcast.Subscriber
+
+        Note:
+            Subscriptions are only supported on linux.
+        """
+        if not hasattr(self._internal, 'subscribe'):
+            raise PlatformNotSupported('subscribe is only supported on linux')
+
+        from async_pyserial.broadcast import Subscriber
+
+        return Subscriber(self._internal.subscribe(lag_policy))
+
+    def watch(self, patterns: list[bytes], callback: Callable, context: int = 16):
+        """
+        Find byte patterns, like sync words, alarm codes or prompts, in the received stream without waking
+        Python for the chunks that contain none.
+
+        The patterns are matched natively on the I/O thread, across chunk boundaries, and `callback` is
+        called there with a list of the matches a chunk completed. Each match has `pattern` (the index in
+        `patterns`), `offset` (of its first byte in the stream received since `watch()`), and `context`,
+        up to `context` bytes before the match, the match and up to `context` bytes after it, the match
+        starting at `context_offset`. A match is reported with the chunk completing it, so the bytes after
+        it are those received in the same chunk. Overlapping matches are all reported.
+
+        Returns:
+            PatternWatch: `close()` stops matching, `position()` is the number of bytes scanned and `matches()`
+            the number reported.
+
+        Example:
+            def on_match(matches):
+                for match in matches:
+                    print(patterns[match.pattern], match.offset, match.context)
+
+            watch = serial.watch([b'ALARM', b'\x7e\x7e'], on_match)
+
+        Note:
+            Pattern matching is only supported on linux.
+        """
+        if not hasattr(self._internal, 'watch'):
+            raise PlatformNotSupported('watch is only supported on linux')
+
+        try:
+            return self._internal.watch(list(patterns), context, callback)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def pause_reading(self):
+        """
+        Stop reading the device, so the driver applies flow control once its buffer fills.
+        A chunk already being read is still delivered.
+
+        Note:
+            Pausing is only supported on linux.
+        """
+        if not hasattr(self._internal, 'pause_reading'):
+            raise PlatformNotSupported('pause_reading is only supported on linux')
+
+        self._internal.pause_reading()
+
+    def resume_reading(self):
+        if hasattr(self._internal, 'resume_reading'):
+            self._internal.resume_reading()
+
+    def start_recording(self, path: str):
+        """
+        Record every received and sent chunk, with a monotonic timestamp and its direction,
+        to a compact binary file. The file can be replayed with `async_pyserial.replay.Replayer`.
+
+        Note:
+            Recording is only supported on linux.
+        """
+        if not hasattr(self._internal, 'start_recording'):
+            raise PlatformNotSupported('recording is only supported on linux')
+
+        self._internal.start_recording(path)
+
+    def stop_recording(self):
+        """
+        Stop recording and flush the record file.
+        """
+        if hasattr(self._internal, 'stop_recording'):
+            self._internal.stop_recording()
+
+    def attach_capture_log(self, log, channel: int = 0):
+        """
+        Append every received and sent chunk to `log`, an `async_pyserial.capture.CaptureLog`,
+        tagged with `channel`. Many ports can share one log.
+
+        Note:
+            Capture logs are only supported on linux.
+        """
+        if not hasattr(self._internal, 'attach_capture_log'):
+            raise PlatformNotSupported('capture log is only supported on linux')
+
+        self._internal.attach_capture_log(log._internal, channel)
+
+    def detach_capture_log(self):
+        if hasattr(self._internal, 'detach_capture_log'):
+            self._internal.detach_capture_log()
+
+    def io_engine(self) -> int | None:
+        """
+        Returns:
+            int | None: The `SerialPortIOEngine` actually used by an open port on linux, which is
+            `SerialPortIOEngine.EPOLL` when io_uring was requested but is unavailable. None on other platforms.
+        """
+        if not hasattr(self._internal, 'io_engine'):
+            return None
+
+        return self._internal.io_engine()
+
+    def rs485_mode(self) -> int | None:
+        """
+        Returns:
+            int | None: How `rs485` was applied to the open port on linux, `SerialPortRS485.SOFTWARE` when
+            `SerialPortRS485.KERNEL` was requested but the driver has no RS-485 mode. None on other platforms.
+        """
+        if not hasattr(self._internal, 'rs485_mode'):
+            return None
+
+        return self._internal.rs485_mode()
+
+    def thread_status(self):
+        """
+        Returns:
+            ThreadStatus | None: How `cpu_affinity`, `sched_policy`, `sched_priority` and `thread_name` were applied
+            to the open port's I/O worker thread on linux, each `*_error` is 0 or an errno value. None on other platforms.
+        """
+        if not hasattr(self._internal, 'thread_status'):
+            return None
+
+        return self._internal.thread_status()
+
+    def reconfigure(self, options: SerialPortOptions, mode: int = SerialPortReconfigure.DRAIN):
+        """
+        Apply the baudrate, bytesize, stopbits and parity of `options` to the open port without closing it.
+        The worker thread, queued writes and buffered input are kept.
+
+        Args:
+            options (SerialPortOptions): The new settings, other attributes are ignored.
+            mode (SerialPortReconfigure): `SerialPortReconfigure.DRAIN` (default) waits until the writes queued
+                before this call are transmitted and holds later writes until the new settings apply.
+                `SerialPortReconfigure.NOW` applies them immediately.
+
+        Raises:
+            SerialPortError: If the port is not open, the settings are invalid, a queued write failed, or DRAIN
+                is called from a callback on the port's I/O thread.
+
+        Note:
+            Reconfiguration is only supported on linux. With DRAIN this call blocks until the earlier writes are sent.
+        """
+        if not hasattr(self._internal, 'reconfigure'):
+            raise PlatformNotSupported('reconfigure is only supported on linux')
+
+        try:
+            self._internal.reconfigure(self._to_internal_options(options), mode)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+        self.options = options
\ No newline at end of file
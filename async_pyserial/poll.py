@@ -0,0 +1,117 @@
+from typing import Callable
+
+from async_pyserial.common import SerialPortError, PlatformNotSupported
+
+class PollScheduler:
+    """
+    Polls request/response devices, like RS-485 slaves, on many ports natively and passes only the
+    results to one callback, in batches.
+
+    Each entry of the table is a port, a request, a response matcher, a period and a timeout. A port
+    has one request outstanding at a time. Its I/O thread matches the response, then writes the next
+    due request of the port at once, so the port is kept busy back-to-back without Python in the loop.
+    Due entries of a port take turns. A result is queued when the response ends, the timeout expires or
+    the request could not be written. A scheduler thread passes the queued results to `callback` as one
+    list, once `max_results` are queued or the oldest waited `max_delay` seconds.
+
+    Each result is a tuple `(key, status, response, latency)`: `PollScheduler.OK` with the response,
+    `PollScheduler.TIMEOUT` with what arrived before the timeout, `PollScheduler.WRITE_ERROR` (reported
+    once the timeout expired, so a closed port is not spun on) or `PollScheduler.OVERFLOW` when no
+    terminator was found in `max_bytes`. `latency` is the time in seconds from queueing the request.
+
+    The matcher is an int, the length of the response, or bytes ending it. Bytes received while no
+    request is waiting, or after the end of a response, are dropped and counted in `stats().unsolicited`.
+
+    Example:
+        def on_results(results):
+            for (port, slave), status, response, latency in results:
+                if status == PollScheduler.OK:
+                    registers[slave] = parse(response)
+
+        table = [(serial, read_request(slave), 9, 0.1, 0.05, (name, slave)) for name, serial in ports.items()
+                 for slave in slaves[name]]
+
+        with PollScheduler(on_results, table, changes_only=True) as scheduler:
+            ...
+
+    Args:
+        `callback` (Callable[[list[tuple]], None]): Called on the scheduler thread.
+        `table` (Iterable[tuple]): `(serial, request, matcher, period, timeout)` rows, with an optional
+            key as a sixth item, passed to `add()`.
+        `changes_only` (bool): Drop results equal to the previous result of their entry. Default is False.
+        `max_results` (int): Deliver once this many results are queued. Default is 256.
+        `max_delay` (float): Deliver once the oldest queued result waited this many seconds. Default is 1 ms.
+
+    Note:
+        The poll scheduler is only supported on linux.
+    """
+    OK = 0
+    TIMEOUT = 1
+    WRITE_ERROR = 2
+    OVERFLOW = 3
+
+    def __init__(self, callback: Callable, table=(), changes_only: bool = False, max_results: int = 256, max_delay: float = 0.001) -> None:
+        from async_pyserial import async_pyserial_core
+
+        if not hasattr(async_pyserial_core, 'PollScheduler'):
+            raise PlatformNotSupported('the poll scheduler is only supported on linux')
+
+        self._internal = async_pyserial_core.PollScheduler(callback, changes_only, max(max_results, 1), max(int(max_delay * 1000000), 0))
+
+        for row in table:
+            self.add(*row)
+
+    def add(self, serial, request: bytes, matcher: int | bytes, period: float = 0.0, timeout: float = 0.1, key=None, max_bytes: int = 256):
+        """
+        Poll the open `serial` with `request` every `period` seconds, 0 as often as the port allows.
+        The first request is due at once.
+
+        Args:
+            `matcher` (int | bytes): The response length, or the bytes ending a response.
+            `timeout` (float): How long a response is waited for, in seconds.
+            `key`: Tags the results of the entry, the `(serial, request)` pair by default.
+            `max_bytes` (int): Responses without a terminator are cut at this size.
+
+        Raises:
+            SerialPortError: If this scheduler is closed.
+            ValueError: If `matcher` is empty or 0.
+        """
+        if isinstance(matcher, int):
+            length, terminator = matcher, b''
+        else:
+            length, terminator = 0, bytes(matcher)
+
+        if length <= 0 and not terminator:
+            raise ValueError('matcher must be a positive length or non-empty bytes')
+
+        if key is None:
+            key = (serial, bytes(request))
+
+        try:
+            self._internal.add(serial._internal, bytes(request), length, terminator, max_bytes,
+                               max(int(period * 1000000), 0), max(int(timeout * 1000000), 0), key)
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def stats(self):
+        """
+        Returns:
+            PollStats: The `requests` written, `responses`, `timeouts`, `errors` (write errors and overflows),
+            `unsolicited` bytes and `suppressed` results with `changes_only`.
+        """
+        return self._internal.stats()
+
+    def close(self):
+        """
+        Stop polling and deliver the queued results. Cannot be called from `callback`.
+        """
+        try:
+            self._internal.close()
+        except RuntimeError as err:
+            raise SerialPortError(str(err)) from err
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
@@ -0,0 +1,91 @@
+from async_pyserial.common import PlatformNotSupported
+
+class ReplayOptions:
+    """
+    ReplayOptions class defines how a record file is played back.
+
+    Attributes:
+        `speed` (float): 1.0 keeps the recorded timing, N plays N times faster and 0 plays as fast as possible. Default is 1.0.
+        `loop` (bool): Restart from the beginning when the end of the file is reached. Default is False.
+        `include_tx` (bool): Replay the sent chunks as well as the received ones. Default is False.
+    """
+    def __init__(self) -> None:
+        self.speed = 1.0
+        self.loop = False
+        self.include_tx = False
+
+class Replayer:
+    """
+    Replays files written by `SerialPort.start_recording()`.
+
+    All replays added to one Replayer run on a single native reactor thread, so many
+    streams can be replayed at once to load-test parsers.
+
+    Example:
+        replayer = Replayer()
+
+        path = replayer.add_pty('capture.bin')   # open `path` with a SerialPort
+        replayer.add_port('capture.bin', serial) # or feed an open SerialPort directly
+
+        replayer.start()
+        replayer.wait()
+    """
+    def __init__(self) -> None:
+        from async_pyserial import async_pyserial_core
+
+        if not hasattr(async_pyserial_core, 'Replayer'):
+            raise PlatformNotSupported('replay is only supported on linux')
+
+        self._core = async_pyserial_core
+        self._internal = async_pyserial_core.Replayer()
+
+    def _internal_options(self, options: ReplayOptions | None):
+        if options is None:
+            options = ReplayOptions()
+
+        internal_options = self._core.ReplayOptions()
+        internal_options.speed = options.speed
+        internal_options.loop = options.loop
+        internal_options.include_tx = options.include_tx
+
+        return internal_options
+
+    def add_pty(self, path: str, options: ReplayOptions | None = None) -> str:
+        """
+        Replay `path` through a new pty.
+
+        Returns:
+            str: The pty device path to open with a SerialPort.
+        """
+        return self._internal.add_pty(path, self._internal_options(options))
+
+    def add_port(self, path: str, serial, options: ReplayOptions | None = None):
+        """
+        Replay `path` directly into `serial` as `SerialPortEvent.ON_DATA` events, without going through a device.
+        """
+        self._internal.add_port(path, self._internal_options(options), serial._internal)
+
+    def start(self):
+        self._internal.start()
+
+    def stop(self):
+        self._internal.stop()
+
+    def is_running(self) -> bool:
+        return self._internal.is_running()
+
+    def active(self) -> int:
+        """
+        Returns:
+            int: The number of replays which have not finished yet.
+        """
+        return self._internal.active()
+
+    def wait(self, timeout: float | None = None) -> bool:
+        """
+        Wait until all replays finish.
+
+        Returns:
+            bool: False if the timeout (in seconds) expired first.
+        """
+        return self._internal.wait(-1 if timeout is None else int(timeout * 1000))
@@ -0,0 +1,47 @@
+def enable(capacity: int = 65536):
+    """
+    Enable event tracing in the native core.
+
+    Each thread records into its own ring buffer which keeps the latest `capacity` records.
+    When tracing is disabled the instrumented paths only pay a single branch.
+    """
+    from async_pyserial import async_pyserial_core
+
+    async_pyserial_core.trace_enable(capacity)
+
+def disable():
+    """
+    Disable event tracing. Recorded events are kept until `clear()` is called.
+    """
+    from async_pyserial import async_pyserial_core
+
+    async_pyserial_core.trace_disable()
+
+def clear():
+    """
+    Drop all recorded events.
+    """
+    from async_pyserial import async_pyserial_core
+
+    async_pyserial_core.trace_clear()
+
+def dump(path: str | None = None) -> str:
+    """
+    Dump recorded events as Chrome trace JSON, which can be opened with
+    chrome://tracing or https://ui.perfetto.dev.
+
+    Args:
+        path (str, optional): When provided, the JSON is also written to this file.
+
+    Returns:
+        str: The trace JSON.
+    """
+    from async_pyserial import async_pyserial_core
+
+    data = async_pyserial_core.trace_dump()
+
+    if path is not None:
+        with open(path, 'w', encoding='utf-8') as f:
+            f.write(data)
+
+    return data
@@ -0,0 +1,113 @@
+import os
+import tty
+import resource
+import threading
+
+import pytest
+
+from async_pyserial import set_async_worker
+
+def raise_fd_limit():
+    # every port needs a pty pair plus the worker's epoll and eventfd
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+
+    if soft < hard:
+        resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+def cpu_seconds() -> float:
+    usage = resource.getrusage(resource.RUSAGE_SELF)
+
+    return usage.ru_utime + usage.ru_stime
+
+class PtyPair:
+    def __init__(self) -> None:
+        self.master_fd, self.slave_fd = os.openpty()
+
+        tty.setraw(self.master_fd)
+
+        self.path = os.ttyname(self.slave_fd)
+
+    def write_all(self, data: bytes):
+        view = memoryview(data)
+
+        while view:
+            n = os.write(self.master_fd, view)
+            view = view[n:]
+
+    def read_exactly(self, size: int) -> bytes:
+        buf = b''
+
+        while len(buf) < size:
+            buf += os.read(self.master_fd, size - len(buf))
+
+        return buf
+
+    def close(self):
+        os.close(self.master_fd)
+        os.close(self.slave_fd)
+
+class Worker:
+    """
+    Uniform blocking read/write over each async worker so the same
+    benchmark body can run on sync, callback, asyncio, gevent and eventlet.
+    """
+    def __init__(self, name: str) -> None:
+        self.name = name
+        self.loop = None
+
+        if name == 'asyncio':
+            import asyncio
+
+            self.loop = asyncio.new_event_loop()
+
+            set_async_worker('asyncio', self.loop)
+        elif name in ('gevent', 'eventlet'):
+            pytest.importorskip(name)
+
+            set_async_worker(name)
+        else:
+            set_async_worker('none')
+
+    def read(self, serial, size: int) -> bytes:
+        if self.name == 'asyncio':
+            return self.loop.run_until_complete(serial.read(size))
+        
+        if self.name == 'callback':
+            event = threading.Event()
+            result = []
+
+            def on_read(data):
+                result.append(data)
+                event.set()
+
+            serial.read(size, on_read)
+            event.wait()
+
+            return result[0]
+        
+        return serial.read(size)
+
+    def read_exactly(self, serial, size: int) -> bytes:
+        buf = b''
+
+        while len(buf) < size:
+            buf += self.read(serial, size - len(buf))
+
+        return buf
+
+    def write(self, serial, data: bytes):
+        if self.name == 'asyncio':
+            self.loop.run_until_complete(serial.write(data))
+        elif self.name == 'callback':
+            event = threading.Event()
+
+            serial.write(data, lambda err: event.set())
+            event.wait()
+        else:
+            serial.write(data)
+
+    def close(self):
+        if self.loop is not None:
+            self.loop.close()
+
+        set_async_worker('none')
@@ -0,0 +1,34 @@
+import pytest
+
+pytest.importorskip('pytest_benchmark')
+
+from benchmarks.bench_util import PtyPair, Worker, raise_fd_limit
+
+raise_fd_limit()
+
+@pytest.fixture
+def pty_pairs():
+    """
+    Factory fixture creating `n` pty pairs without an external `socat` process.
+    """
+    pairs = []
+
+    def factory(n: int = 1):
+        created = [PtyPair() for _ in range(n)]
+
+        pairs.extend(created)
+
+        return created
+
+    yield factory
+
+    for pair in pairs:
+        pair.close()
+
+@pytest.fixture(params=['sync', 'callback', 'asyncio', 'gevent', 'eventlet'])
+def worker(request):
+    w = Worker(request.param)
+
+    yield w
+
+    w.close()
@@ -0,0 +1,172 @@
+import threading
+import time
+
+import pytest
+
+from async_pyserial import SerialPort, SerialPortOptions
+
+from benchmarks.bench_util import cpu_seconds
+
+MESSAGE_SIZES = [16, 256, 4096]
+
+PORT_COUNTS = [1, 10, 100, 500]
+
+MB = 1024 * 1024
+
+def open_serial(path: str, read_bufsize: int = 4 * MB) -> SerialPort:
+    options = SerialPortOptions()
+    options.baudrate = 115200
+    options.read_bufsize = read_bufsize
+
+    serial = SerialPort(path, options)
+    serial.open()
+
+    return serial
+
+def percentiles(samples: list) -> dict:
+    ordered = sorted(samples)
+
+    def pick(p):
+        return ordered[min(len(ordered) - 1, int(p * len(ordered)))]
+    
+    return {
+        'p50_us': pick(0.5) * 1e6,
+        'p90_us': pick(0.9) * 1e6,
+        'p99_us': pick(0.99) * 1e6,
+        'max_us': ordered[-1] * 1e6,
+    }
+
+@pytest.mark.parametrize('size', MESSAGE_SIZES)
+def test_rx_throughput(benchmark, pty_pairs, worker, size):
+    pair, = pty_pairs(1)
+    serial = open_serial(pair.path)
+
+    total = size * 256
+    message = b'*' * size
+
+    def feed():
+        for _ in range(total // size):
+            pair.write_all(message)
+
+    def run():
+        t = threading.Thread(target=feed, daemon=True)
+        t.start()
+
+        worker.read_exactly(serial, total)
+
+        t.join()
+
+    cpu_start = cpu_seconds()
+
+    benchmark.pedantic(run, rounds=10, iterations=1)
+
+    cpu = cpu_seconds() - cpu_start
+
+    benchmark.extra_info['bytes_per_round'] = total
+    benchmark.extra_info['cpu_s_per_mb'] = cpu / (total * 10 / MB)
+
+    serial.close()
+
+@pytest.mark.parametrize('size', MESSAGE_SIZES)
+def test_tx_throughput(benchmark, pty_pairs, worker, size):
+    pair, = pty_pairs(1)
+    serial = open_serial(pair.path)
+
+    total = size * 256
+    message = b'*' * size
+
+    def run():
+        received = []
+
+        t = threading.Thread(target=lambda: received.append(pair.read_exactly(total)), daemon=True)
+        t.start()
+
+        for _ in range(total // size):
+            worker.write(serial, message)
+
+        t.join()
+
+    cpu_start = cpu_seconds()
+
+    benchmark.pedantic(run, rounds=10, iterations=1)
+
+    cpu = cpu_seconds() - cpu_start
+
+    benchmark.extra_info['bytes_per_round'] = total
+    benchmark.extra_info['cpu_s_per_mb'] = cpu / (total * 10 / MB)
+
+    serial.close()
+
+@pytest.mark.parametrize('size', MESSAGE_SIZES)
+def test_roundtrip_latency(benchmark, pty_pairs, worker, size):
+    pair, = pty_pairs(1)
+    serial = open_serial(pair.path)
+
+    message = b'*' * size
+
+    # the far end echoes everything back
+    stop = threading.Event()
+
+    def echo():
+        try:
+            while not stop.is_set():
+                pair.write_all(pair.read_exactly(size))
+        except OSError:
+            pass
+
+    t = threading.Thread(target=echo, daemon=True)
+    t.start()
+
+    samples = []
+
+    def run():
+        start = time.perf_counter()
+
+        worker.write(serial, message)
+        worker.read_exactly(serial, size)
+
+        samples.append(time.perf_counter() - start)
+
+    benchmark.pedantic(run, rounds=200, iterations=1, warmup_rounds=10)
+
+    benchmark.extra_info.update(percentiles(samples))
+
+    stop.set()
+    serial.close()
+
+@pytest.mark.parametrize('size', MESSAGE_SIZES)
+@pytest.mark.parametrize('ports', PORT_COUNTS)
+def test_multi_port_rx_throughput(benchmark, pty_pairs, worker, ports, size):
+    pairs = pty_pairs(ports)
+
+    total_per_port = size * 64
+    message = b'*' * size
+
+    # every port buffers a whole round while the others are read
+    serials = [open_serial(pair.path, read_bufsize=total_per_port * 2) for pair in pairs]
+
+    def feed():
+        for _ in range(total_per_port // size):
+            for pair in pairs:
+                pair.write_all(message)
+
+    def run():
+        t = threading.Thread(target=feed, daemon=True)
+        t.start()
+
+        for serial in serials:
+            worker.read_exactly(serial, total_per_port)
+
+        t.join()
+
+    cpu_start = cpu_seconds()
+
+    benchmark.pedantic(run, rounds=5, iterations=1)
+
+    cpu = cpu_seconds() - cpu_start
+
+    benchmark.extra_info['bytes_per_round'] = total_per_port * ports
+    benchmark.extra_info['cpu_s_per_mb'] = cpu / (total_per_port * ports * 5 / MB)
+
+    for serial in serials:
+        serial.close()
@@ -0,0 +1,537 @@
+// Throughput / latency benchmark for internal::SerialPort over pty pairs.
+//
+// build (linux):
+//   g++ -std=c++17 -O2 -DLINUX -Icore/include -o serialport_bench core/benchmarks/serialport_bench.cpp
+//       core/lib/common/*.cpp core/lib/linux/*.cpp -lpthread -lutil
+//
+// usage:
+//   serialport_bench [--sizes 16,256,4096] [--ports 1,10,100,500] [--duration 2] [--samples 2000] [--engine epoll|io_uring]
+//                   [--output result.json]
+
+#ifdef LINUX
+
+#include <linux/serialport.h>
+#include <common/util.h>
+
+#include <pty.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace async_pyserial;
+
+namespace
+{
+    struct PtyPair
+    {
+        int master_fd;
+        int slave_fd;
+        std::string path;
+    };
+
+    struct BenchPort
+    {
+        PtyPair pty;
+        std::unique_ptr<internal::SerialPort> serial;
+        std::atomic<uint64_t> received{0};
+    };
+
+    uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    double cpu_seconds()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+               usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    }
+
+    std::vector<size_t> parse_list(const std::string &s)
+    {
+        std::vector<size_t> values;
+        std::stringstream ss(s);
+        std::string item;
+
+        while (std::getline(ss, item, ','))
+        {
+            values.push_back(std::stoul(item));
+        }
+
+        return values;
+    }
+
+    void raise_fd_limit()
+    {
+        struct rlimit limit;
+
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    PtyPair open_pty()
+    {
+        PtyPair pty;
+        char name[128];
+
+        if (openpty(&pty.master_fd, &pty.slave_fd, name, nullptr, nullptr) != 0)
+        {
+            throw common::OSException("openpty failure");
+        }
+
+        struct termios tty;
+        tcgetattr(pty.master_fd, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(pty.master_fd, TCSANOW, &tty);
+
+        fcntl(pty.master_fd, F_SETFL, fcntl(pty.master_fd, F_GETFL) | O_NONBLOCK);
+
+        pty.path = name;
+
+        return pty;
+    }
+
+    unsigned char io_engine = internal::EPOLL_ENGINE;
+
+    std::vector<std::unique_ptr<BenchPort>> open_ports(size_t count)
+    {
+        base::SerialPortOptions options;
+        options.baudrate = 115200;
+        options.bytesize = 8;
+        options.stopbits = 1;
+        options.parity = 0;
+        options.io_engine = io_engine;
+
+        std::vector<std::unique_ptr<BenchPort>> ports;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto port = std::make_unique<BenchPort>();
+            port->pty = open_pty();
+            port->serial = std::make_unique<internal::SerialPort>(
+                std::wstring(port->pty.path.begin(), port->pty.path.end()), options);
+
+            BenchPort *p = port.get();
+            port->serial->on(internal::SerialPortEvent::ON_DATA, [p](const std::vector<std::any> &args) {
+                p->received += std::any_cast<const std::string &>(args[0]).size();
+            });
+
+            port->serial->open();
+
+            ports.push_back(std::move(port));
+        }
+
+        return ports;
+    }
+
+    void close_ports(std::vector<std::unique_ptr<BenchPort>> &ports)
+    {
+        for (auto &port : ports)
+        {
+            port->serial->close();
+            ::close(port->pty.master_fd);
+            ::close(port->pty.slave_fd);
+        }
+
+        ports.clear();
+    }
+
+    // master -> SerialPort, all ports driven from one epoll loop
+    std::string bench_rx_throughput(size_t port_count, size_t msg_size, double duration)
+    {
+        auto ports = open_ports(port_count);
+
+        std::string msg(msg_size, '*');
+
+        int ep = epoll_create1(0);
+        for (size_t i = 0; i < ports.size(); i++)
+        {
+            struct epoll_event evt;
+            evt.events = EPOLLOUT;
+            evt.data.u64 = i;
+            epoll_ctl(ep, EPOLL_CTL_ADD, ports[i]->pty.master_fd, &evt);
+        }
+
+        std::vector<uint64_t> sent(ports.size(), 0);
+        std::vector<struct epoll_event> evts(ports.size());
+
+        double cpu_start = cpu_seconds();
+        uint64_t start = now_ns();
+        uint64_t deadline = start + static_cast<uint64_t>(duration * 1e9);
+
+        while (now_ns() < deadline)
+        {
+            int n = epoll_wait(ep, evts.data(), evts.size(), 10);
+
+            for (int i = 0; i < n; i++)
+            {
+                size_t idx = evts[i].data.u64;
+                ssize_t w = ::write(ports[idx]->pty.master_fd, msg.data(), msg.size());
+
+                if (w > 0)
+                {
+                    sent[idx] += w;
+                }
+            }
+        }
+
+        // let the workers drain what is left in the pty buffers
+        uint64_t total_sent = 0;
+        for (auto v : sent)
+        {
+            total_sent += v;
+        }
+
+        uint64_t drain_deadline = now_ns() + 2000000000ULL;
+        uint64_t total_received = 0;
+
+        do
+        {
+            total_received = 0;
+            for (auto &port : ports)
+            {
+                total_received += port->received;
+            }
+
+            if (total_received >= total_sent)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } while (now_ns() < drain_deadline);
+
+        uint64_t end = now_ns();
+        double cpu = cpu_seconds() - cpu_start;
+
+        ::close(ep);
+        close_ports(ports);
+
+        double elapsed = (end - start) / 1e9;
+        double mb = total_received / (1024.0 * 1024.0);
+
+        std::ostringstream out;
+        out << "{\"mode\":\"rx_throughput\",\"ports\":" << port_count << ",\"message_size\":" << msg_size
+            << ",\"elapsed_s\":" << elapsed << ",\"bytes\":" << total_received
+            << ",\"mb_per_s\":" << (mb / elapsed) << ",\"cpu_s_per_mb\":" << (mb > 0 ? cpu / mb : 0) << "}";
+
+        return out.str();
+    }
+
+    // SerialPort::write -> master, keeping a bounded number of writes in flight per port
+    std::string bench_tx_throughput(size_t port_count, size_t msg_size, double duration)
+    {
+        auto ports = open_ports(port_count);
+
+        std::string msg(msg_size, '*');
+
+        const int max_inflight = 16;
+
+        // what the write callbacks share, one capture keeps them in place in the WriteCallback
+        struct Flight
+        {
+            std::mutex mutex;
+            std::condition_variable cv;
+            int inflight = 0;
+            std::atomic<uint64_t> written{0};
+        } flight;
+
+        std::atomic<bool> stop{false};
+
+        int ep = epoll_create1(0);
+        for (size_t i = 0; i < ports.size(); i++)
+        {
+            struct epoll_event evt;
+            evt.events = EPOLLIN;
+            evt.data.u64 = i;
+            epoll_ctl(ep, EPOLL_CTL_ADD, ports[i]->pty.master_fd, &evt);
+        }
+
+        std::thread drain([&]() {
+            std::vector<struct epoll_event> evts(ports.size());
+            char buffer[65536];
+
+            while (!stop)
+            {
+                int n = epoll_wait(ep, evts.data(), evts.size(), 10);
+
+                for (int i = 0; i < n; i++)
+                {
+                    while (::read(ports[evts[i].data.u64]->pty.master_fd, buffer, sizeof(buffer)) > 0)
+                    {
+                    }
+                }
+            }
+        });
+
+        double cpu_start = cpu_seconds();
+        uint64_t start = now_ns();
+        uint64_t deadline = start + static_cast<uint64_t>(duration * 1e9);
+
+        while (now_ns() < deadline)
+        {
+            for (auto &port : ports)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(flight.mutex);
+                    flight.cv.wait(lock, [&]() { return flight.inflight < max_inflight * (int)ports.size(); });
+                    flight.inflight++;
+                }
+
+                port->serial->write(msg, [&flight, msg_size](unsigned long err) {
+                    if (err == common::SUCCESS)
+                    {
+                        flight.written += msg_size;
+                    }
+
+                    std::lock_guard<std::mutex> lock(flight.mutex);
+                    flight.inflight--;
+                    flight.cv.notify_one();
+                });
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(flight.mutex);
+            flight.cv.wait_for(lock, std::chrono::seconds(2), [&]() { return flight.inflight == 0; });
+        }
+
+        uint64_t end = now_ns();
+        double cpu = cpu_seconds() - cpu_start;
+
+        stop = true;
+        drain.join();
+
+        ::close(ep);
+        close_ports(ports);
+
+        double elapsed = (end - start) / 1e9;
+        double mb = flight.written / (1024.0 * 1024.0);
+
+        std::ostringstream out;
+        out << "{\"mode\":\"tx_throughput\",\"ports\":" << port_count << ",\"message_size\":" << msg_size
+            << ",\"elapsed_s\":" << elapsed << ",\"bytes\":" << flight.written
+            << ",\"mb_per_s\":" << (mb / elapsed) << ",\"cpu_s_per_mb\":" << (mb > 0 ? cpu / mb : 0) << "}";
+
+        return out.str();
+    }
+
+    // master writes a message, the SerialPort echoes it back
+    std::string bench_latency(size_t msg_size, size_t samples)
+    {
+        auto ports = open_ports(1);
+        auto &port = ports[0];
+
+        std::string msg(msg_size, '*');
+
+        std::mutex mutex;
+        std::string pending;
+
+        port->serial->on(internal::SerialPortEvent::ON_DATA, [&](const std::vector<std::any> &args) {
+            auto &data = std::any_cast<const std::string &>(args[0]);
+
+            std::string echo;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending += data;
+
+                if (pending.size() < msg_size)
+                {
+                    return;
+                }
+
+                echo.swap(pending);
+            }
+
+            port->serial->write(echo, [](unsigned long) {});
+        });
+
+        int ep = epoll_create1(0);
+        struct epoll_event evt;
+        evt.events = EPOLLIN;
+        evt.data.fd = port->pty.master_fd;
+        epoll_ctl(ep, EPOLL_CTL_ADD, port->pty.master_fd, &evt);
+
+        std::vector<double> rtts;
+        std::vector<char> buffer(msg_size + 4096);
+
+        for (size_t i = 0; i < samples; i++)
+        {
+            uint64_t t0 = now_ns();
+
+            size_t off = 0;
+            while (off < msg.size())
+            {
+                ssize_t w = ::write(port->pty.master_fd, msg.data() + off, msg.size() - off);
+                if (w > 0)
+                {
+                    off += w;
+                }
+            }
+
+            size_t got = 0;
+            while (got < msg_size)
+            {
+                struct epoll_event out;
+                if (epoll_wait(ep, &out, 1, 1000) <= 0)
+                {
+                    break;
+                }
+
+                ssize_t r = ::read(port->pty.master_fd, buffer.data(), buffer.size());
+                if (r > 0)
+                {
+                    got += r;
+                }
+            }
+
+            if (got < msg_size)
+            {
+                break;
+            }
+
+            rtts.push_back((now_ns() - t0) / 1000.0);
+        }
+
+        ::close(ep);
+        close_ports(ports);
+
+        std::sort(rtts.begin(), rtts.end());
+
+        auto percentile = [&](double p) {
+            if (rtts.empty())
+            {
+                return 0.0;
+            }
+            return rtts[std::min(rtts.size() - 1, static_cast<size_t>(p * rtts.size()))];
+        };
+
+        std::ostringstream out;
+        out << "{\"mode\":\"latency\",\"ports\":1,\"message_size\":" << msg_size << ",\"samples\":" << rtts.size()
+            << ",\"p50_us\":" << percentile(0.5) << ",\"p90_us\":" << percentile(0.9)
+            << ",\"p99_us\":" << percentile(0.99) << ",\"p999_us\":" << percentile(0.999)
+            << ",\"max_us\":" << (rtts.empty() ? 0 : rtts.back()) << "}";
+
+        return out.str();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = {16, 256, 4096};
+    std::vector<size_t> port_counts = {1, 10, 100, 500};
+    double duration = 2.0;
+    size_t samples = 2000;
+    std::string output;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--sizes")
+        {
+            sizes = parse_list(argv[i + 1]);
+        }
+        else if (arg == "--ports")
+        {
+            port_counts = parse_list(argv[i + 1]);
+        }
+        else if (arg == "--duration")
+        {
+            duration = std::stod(argv[i + 1]);
+        }
+        else if (arg == "--samples")
+        {
+            samples = std::stoul(argv[i + 1]);
+        }
+        else if (arg == "--engine")
+        {
+            io_engine = std::string(argv[i + 1]) == "io_uring" ? internal::IO_URING_ENGINE : internal::EPOLL_ENGINE;
+        }
+        else if (arg == "--output")
+        {
+            output = argv[i + 1];
+        }
+        else
+        {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    raise_fd_limit();
+
+    std::vector<std::string> results;
+
+    for (auto size : sizes)
+    {
+        results.push_back(bench_latency(size, samples));
+
+        for (auto count : port_counts)
+        {
+            results.push_back(bench_rx_throughput(count, size, duration));
+            results.push_back(bench_tx_throughput(count, size, duration));
+
+            std::cerr << results[results.size() - 2] << std::endl
+                      << results.back() << std::endl;
+        }
+    }
+
+    std::ostringstream out;
+    out << "{\"benchmark\":\"serialport_bench\",\"engine\":\""
+        << (io_engine == internal::IO_URING_ENGINE ? "io_uring" : "epoll") << "\",\"timestamp\":"
+        << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+        << ",\"results\":[";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        out << (i ? "," : "") << results[i];
+    }
+
+    out << "]}";
+
+    if (output.empty())
+    {
+        std::cout << out.str() << std::endl;
+    }
+    else
+    {
+        std::ofstream(output) << out.str() << std::endl;
+    }
+
+    return 0;
+}
+
+#else
+
+#include <iostream>
+
+int main()
+{
+    std::cerr << "serialport_bench only supports linux" << std::endl;
+    return 1;
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef ASYNC_PYSERIAL_BASE_SERIALPORT_H
 #define ASYNC_PYSERIAL_BASE_SERIALPORT_H
 
+#include <string>
+#include <vector>
+
 namespace async_pyserial {
     namespace base {
         struct SerialPortOptions
@@ -11,6 +14,42 @@ namespace async_pyserial {
             unsigned char parity;
             unsigned long read_timeout = 50;
             unsigned long write_timeout = 50;
+            // linux only, minimum size of each read and max bytes drained into one ON_DATA event per wakeup
+            unsigned long read_buffer_size = 1024;
+            unsigned long read_budget = 65536;
+            // linux only, 0: epoll, 1: io_uring (falls back to epoll when unavailable)
+            unsigned char io_engine = 0;
+            // linux only, I/O worker thread tuning, failures are reported instead of raised
+            // cpus the worker may run on, empty means any
+            std::vector<int> cpu_affinity;
+            // 0: SCHED_OTHER, 1: SCHED_FIFO, 2: SCHED_RR
+            int sched_policy = 0;
+            int sched_priority = 0;
+            // empty means "serial:<device>", truncated to 15 characters
+            std::string thread_name;
+            // linux only, reopen the device with the same options when it disappears (uses the epoll engine)
+            bool reconnect = false;
+            // ms before the first retry, doubled after each failed one up to reconnect_max_interval,
+            // the device directories are also watched with inotify to retry as soon as it reappears
+            unsigned long reconnect_interval = 100;
+            unsigned long reconnect_max_interval = 5000;
+            // 0: writes fail while disconnected, 1: writes are queued until the device is back
+            unsigned char reconnect_write_policy = 0;
+            // when the receive buffer (read_bufsize) is full, 0: the rest is dropped and reported,
+            // 1 (linux only): reading stops until reads make room, so the driver applies flow control
+            unsigned char overflow_policy = 0;
+            // linux only, bytes kept for broadcast subscribers, allocated by the first subscription
+            unsigned long broadcast_bufsize = 1 << 20;
+            // linux only, RS-485 half duplex with RTS as driver enable, 0: off, 1: TIOCSRS485, toggled in user space
+            // by the worker when the driver has no RS-485 mode, 2: always in user space (uses the epoll engine)
+            unsigned char rs485 = 0;
+            // RTS level while sending, the other one while idle
+            bool rs485_rts_on_send = true;
+            // ms from raising the driver enable to the first bit and from the last bit to dropping it
+            unsigned long rs485_delay_before_send = 0;
+            unsigned long rs485_delay_after_send = 0;
+            // linux only, drop the local echo of our own transmissions from the received data
+            bool rs485_suppress_echo = false;
         };
     }
 }
@@ -0,0 +1,100 @@
+#ifndef ASYNC_PYSERIAL_COMMON_BROADCAST_RING_H
+#define ASYNC_PYSERIAL_COMMON_BROADCAST_RING_H
+
+#include <string>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+
+#include <common/record.h>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        // what a subscriber that fell more than the ring capacity behind gets
+        enum LagPolicy : unsigned char
+        {
+            // continues at the oldest byte still in the ring, the skipped bytes are counted as lost
+            LAG_SKIP = 0,
+            // reads fail until it resubscribes
+            LAG_DROP = 1
+        };
+
+        // received bytes kept for any number of subscribers, each reading at its own pace
+        //
+        // written by the I/O thread as a StreamSink, which never waits for subscribers: positions only grow,
+        // the ring keeps the last capacity bytes and readers validate their copy against the writer's
+        // reservation afterwards, like a seqlock
+        class BroadcastRing : public StreamSink
+        {
+        public:
+            // capacity is rounded up to a power of two
+            explicit BroadcastRing(size_t capacity);
+
+            void onChunk(StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) override;
+
+            // reads fail while closed, close wakes the waiting ones
+            void open();
+            void close();
+
+            size_t capacity() const;
+
+            // total bytes written
+            uint64_t position() const;
+
+        private:
+            friend class BroadcastSubscriber;
+
+            std::unique_ptr<char[]> buffer;
+            size_t mask;
+
+            // bytes before head are complete, bytes before reserved may be in the middle of being overwritten
+            std::atomic<uint64_t> head{0};
+            std::atomic<uint64_t> reserved{0};
+
+            // only taken to wake waiting subscribers
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::atomic<int> waiters{0};
+            std::atomic<bool> closed{false};
+        };
+
+        class BroadcastSubscriber
+        {
+        public:
+            // starts at the current end of the ring, only data received afterwards is read
+            BroadcastSubscriber(const std::shared_ptr<BroadcastRing> &ring, LagPolicy policy);
+
+            // copies up to size bytes into out, waiting until at least one is available,
+            // timeout_ms < 0 waits forever, throws TimeoutException, or SerialPortException when closed or dropped
+            size_t read(char *out, size_t size, long timeout_ms);
+
+            // bytes waiting, up to the ring capacity
+            size_t available() const;
+
+            // bytes skipped with LAG_SKIP
+            uint64_t lost() const;
+
+            bool dropped() const;
+
+            void close();
+
+        private:
+            // returns false when the subscriber fell behind, after applying the lag policy
+            bool catchUp();
+
+            std::shared_ptr<BroadcastRing> ring;
+            LagPolicy policy;
+
+            std::atomic<uint64_t> cursor;
+            std::atomic<uint64_t> skipped{0};
+            std::atomic<bool> is_dropped{false};
+            std::atomic<bool> closed{false};
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,623 @@
+#ifndef ASYNC_PYSERIAL_COMMON_CORO_H
+#define ASYNC_PYSERIAL_COMMON_CORO_H
+
+// C++20 coroutines over internal::SerialPort, for C++ code linking the core directly,
+// the python extension is built as C++17 and does not use them
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+
+#ifdef Win32
+
+#include <win32/serialport.h>
+
+#endif
+
+#ifdef LINUX
+
+#include <linux/serialport.h>
+
+#endif
+
+#ifdef __darwin__
+
+#include <darwin/serialport.h>
+
+#endif
+
+#ifdef __bsd__
+
+#include <bsd/serialport.h>
+
+#endif
+
+#include <common/exception.h>
+#include <common/search.h>
+
+#include <any>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        namespace coro
+        {
+            template <typename T = void>
+            class Task;
+
+            class Executor;
+
+            // a coroutine waiting for the executor, linked in place so queueing never allocates
+            struct ExecutorNode
+            {
+                ExecutorNode *next = nullptr;
+                std::coroutine_handle<> handle;
+                // set once a spawned task completed, run() then destroys it
+                bool finished = false;
+                std::exception_ptr *exception = nullptr;
+            };
+
+            class PromiseBase
+            {
+            public:
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                // resumes the awaiting coroutine, or hands a spawned task back to its executor
+                struct FinalAwaiter
+                {
+                    bool await_ready() noexcept { return false; }
+
+                    template <typename Promise>
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                    {
+                        PromiseBase &promise = handle.promise();
+
+                        if (promise.continuation)
+                        {
+                            return promise.continuation;
+                        }
+
+                        if (promise.executor != nullptr)
+                        {
+                            promise.finish();
+                        }
+
+                        return std::noop_coroutine();
+                    }
+
+                    void await_resume() noexcept {}
+                };
+
+                FinalAwaiter final_suspend() noexcept { return {}; }
+
+                void unhandled_exception() { exception = std::current_exception(); }
+
+            protected:
+                friend class Executor;
+
+                template <typename T>
+                friend class Task;
+
+                void finish();
+
+                std::coroutine_handle<> continuation;
+                std::exception_ptr exception;
+
+                Executor *executor = nullptr;
+                ExecutorNode node;
+            };
+
+            template <typename T>
+            class Promise : public PromiseBase
+            {
+            public:
+                Task<T> get_return_object();
+
+                template <typename U>
+                void return_value(U &&result) { value.emplace(std::forward<U>(result)); }
+
+                T result()
+                {
+                    if (exception)
+                    {
+                        std::rethrow_exception(exception);
+                    }
+
+                    return std::move(*value);
+                }
+
+            private:
+                std::optional<T> value;
+            };
+
+            template <>
+            class Promise<void> : public PromiseBase
+            {
+            public:
+                Task<void> get_return_object();
+
+                void return_void() {}
+
+                void result()
+                {
+                    if (exception)
+                    {
+                        std::rethrow_exception(exception);
+                    }
+                }
+            };
+
+            // a lazily started coroutine returning T, run by co_await or Executor::spawn
+            template <typename T>
+            class Task
+            {
+            public:
+                using promise_type = Promise<T>;
+
+                explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+                Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+                Task(const Task &) = delete;
+                Task &operator=(const Task &) = delete;
+
+                ~Task()
+                {
+                    if (handle)
+                    {
+                        handle.destroy();
+                    }
+                }
+
+                bool await_ready() const noexcept { return false; }
+
+                // symmetric transfer, so awaiting chains of tasks don't grow the stack
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    handle.promise().continuation = awaiting;
+
+                    return handle;
+                }
+
+                T await_resume() { return handle.promise().result(); }
+
+            private:
+                friend class Executor;
+
+                std::coroutine_handle<promise_type> handle;
+            };
+
+            template <typename T>
+            Task<T> Promise<T>::get_return_object()
+            {
+                return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+            }
+
+            inline Task<void> Promise<void>::get_return_object()
+            {
+                return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+            }
+
+            // runs coroutines on the thread calling run(), so protocol logic can be written sequentially
+            // without threads of its own
+            //
+            // I/O operations resume on the port's I/O thread, `co_await executor.schedule()` continues on
+            // the executor thread again, e.g. before blocking work. run() must return before it is destroyed
+            class Executor
+            {
+            public:
+                Executor() = default;
+
+                Executor(const Executor &) = delete;
+                Executor &operator=(const Executor &) = delete;
+
+                // starts task on the executor thread, the executor owns it until it completes
+                void spawn(Task<void> task)
+                {
+                    auto handle = std::exchange(task.handle, nullptr);
+                    PromiseBase &promise = handle.promise();
+
+                    promise.executor = this;
+                    promise.node.handle = handle;
+                    promise.node.exception = &promise.exception;
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+
+                        active++;
+                    }
+
+                    post(&promise.node);
+                }
+
+                // resumes queued coroutines until every spawned task completed,
+                // then rethrows the first exception a spawned task ended with
+                void run()
+                {
+                    std::exception_ptr failure;
+
+                    while (true)
+                    {
+                        ExecutorNode *node;
+
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+
+                            cv.wait(lock, [this]
+                                    { return head != nullptr || active == 0; });
+
+                            if (head == nullptr)
+                            {
+                                break;
+                            }
+
+                            node = head;
+                            head = node->next;
+
+                            if (head == nullptr)
+                            {
+                                tail = nullptr;
+                            }
+
+                            node->next = nullptr;
+                        }
+
+                        if (!node->finished)
+                        {
+                            node->handle.resume();
+                            continue;
+                        }
+
+                        if (!failure && node->exception != nullptr && *node->exception)
+                        {
+                            failure = *node->exception;
+                        }
+
+                        node->handle.destroy();
+
+                        std::lock_guard<std::mutex> lock(mutex);
+
+                        active--;
+                    }
+
+                    if (failure)
+                    {
+                        std::rethrow_exception(failure);
+                    }
+                }
+
+                struct ScheduleAwaiter
+                {
+                    Executor &executor;
+                    ExecutorNode node;
+
+                    bool await_ready() noexcept { return false; }
+
+                    void await_suspend(std::coroutine_handle<> handle)
+                    {
+                        node.handle = handle;
+
+                        executor.post(&node);
+                    }
+
+                    void await_resume() noexcept {}
+                };
+
+                ScheduleAwaiter schedule() { return ScheduleAwaiter{*this, {}}; }
+
+            private:
+                friend class PromiseBase;
+
+                void post(ExecutorNode *node)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    if (tail != nullptr)
+                    {
+                        tail->next = node;
+                    }
+                    else
+                    {
+                        head = node;
+                    }
+
+                    tail = node;
+
+                    cv.notify_one();
+                }
+
+                std::mutex mutex;
+                std::condition_variable cv;
+
+                ExecutorNode *head = nullptr;
+                ExecutorNode *tail = nullptr;
+
+                size_t active = 0;
+            };
+
+            inline void PromiseBase::finish()
+            {
+                node.finished = true;
+
+                executor->post(&node);
+            }
+
+            // awaitable reads and writes of an internal::SerialPort
+            //
+            // received data is buffered from one ON_DATA listener, up to capacity bytes, the rest is dropped,
+            // a read completes on the I/O thread as soon as the data it waits for arrives. Operations keep
+            // their state in the awaiting coroutine's frame, so they allocate nothing else (writes still hand
+            // the port a copy of the data). One read may wait at a time, writes are queued by the port.
+            //
+            // make and destroy it while the port is closed, the port's listeners are not thread safe
+            class Port
+            {
+            public:
+                explicit Port(internal::SerialPort &serial, size_t capacity = 65536)
+                    : serial(serial), capacity(capacity)
+                {
+                    listener = serial.on(internal::SerialPortEvent::ON_DATA, [this](const std::vector<std::any> &args)
+                                         { this->onData(std::any_cast<const std::string &>(args[0])); });
+                }
+
+                ~Port()
+                {
+                    cancel();
+
+                    serial.removeListener(internal::SerialPortEvent::ON_DATA, listener);
+                }
+
+                Port(const Port &) = delete;
+                Port &operator=(const Port &) = delete;
+
+                // a waiting read with the state it needs
+                struct ReadOperation
+                {
+                    ReadOperation(Port &port, size_t size, std::string delimiter)
+                        : port(port), size(size), delimiter(std::move(delimiter)) {}
+
+                    Port &port;
+                    size_t size;
+                    std::string delimiter;
+
+                    std::coroutine_handle<> handle;
+                    std::string result;
+                    bool cancelled = false;
+
+                    bool await_ready() noexcept { return false; }
+
+                    // completes at once when the buffer already holds what it waits for
+                    bool await_suspend(std::coroutine_handle<> awaiting)
+                    {
+                        handle = awaiting;
+
+                        return port.wait(this);
+                    }
+
+                    std::string await_resume()
+                    {
+                        if (cancelled)
+                        {
+                            throw SerialPortException("read cancelled");
+                        }
+
+                        return std::move(result);
+                    }
+                };
+
+                // up to size bytes, once at least one is available
+                ReadOperation read(size_t size) { return ReadOperation{*this, size, std::string()}; }
+
+                // through the first delimiter, or max_bytes without one
+                ReadOperation read_until(std::string_view delimiter, size_t max_bytes)
+                {
+                    return ReadOperation{*this, max_bytes, std::string(delimiter)};
+                }
+
+                struct WriteOperation
+                {
+                    WriteOperation(Port &port, std::string_view data) : port(port), data(data) {}
+
+                    Port &port;
+                    std::string_view data;
+
+                    std::coroutine_handle<> handle;
+                    unsigned long err = SUCCESS;
+                    // set by whichever of the completion and await_suspend comes first
+                    std::atomic<bool> raced{false};
+
+                    bool await_ready() noexcept { return data.empty(); }
+
+                    bool await_suspend(std::coroutine_handle<> awaiting)
+                    {
+                        handle = awaiting;
+
+                        // a pointer fits internal::WriteCallback
+                        port.serial.write(data.data(), data.size(), [this](unsigned long result)
+                                          {
+                            err = result;
+
+                            if (raced.exchange(true))
+                            {
+                                handle.resume();
+                            } });
+
+                        // false when the write already completed, then the coroutine just continues
+                        return !raced.exchange(true);
+                    }
+
+                    // throws SerialPortException when the write failed
+                    void await_resume()
+                    {
+                        if (err != SUCCESS)
+                        {
+                            throw SerialPortException("write failed: " + std::to_string(err));
+                        }
+                    }
+                };
+
+                // resumes once data is written, data must stay valid until then
+                WriteOperation write(std::string_view data) { return WriteOperation{*this, data}; }
+
+                // the waiting read fails with SerialPortException
+                void cancel()
+                {
+                    ReadOperation *waiting;
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+
+                        waiting = std::exchange(reader, nullptr);
+                    }
+
+                    if (waiting != nullptr)
+                    {
+                        waiting->cancelled = true;
+                        waiting->handle.resume();
+                    }
+                }
+
+                // bytes received while the buffer was full
+                size_t dropped()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    return dropped_bytes;
+                }
+
+            private:
+                // returns false when operation completed at once
+                bool wait(ReadOperation *operation)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    if (reader != nullptr)
+                    {
+                        throw SerialPortException("a read is already waiting");
+                    }
+
+                    scanned = 0;
+
+                    if (complete(operation))
+                    {
+                        return false;
+                    }
+
+                    reader = operation;
+
+                    return true;
+                }
+
+                // called on the I/O thread
+                void onData(const std::string &data)
+                {
+                    ReadOperation *completed = nullptr;
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+
+                        size_t kept = std::min(data.size(), capacity - std::min(capacity, buffer.size() - head));
+
+                        if (head > 0 && head >= buffer.size() / 2)
+                        {
+                            buffer.erase(0, head);
+                            head = 0;
+                        }
+
+                        buffer.append(data, 0, kept);
+                        dropped_bytes += data.size() - kept;
+
+                        if (reader != nullptr && complete(reader))
+                        {
+                            completed = std::exchange(reader, nullptr);
+                        }
+                    }
+
+                    if (completed != nullptr)
+                    {
+                        completed->handle.resume();
+                    }
+                }
+
+                // fills the operation's result when the buffer holds what it waits for, under mutex
+                bool complete(ReadOperation *operation)
+                {
+                    size_t available = buffer.size() - head;
+                    size_t limit = std::min(available, operation->size);
+
+                    if (operation->size == 0)
+                    {
+                        operation->result.clear();
+                        return true;
+                    }
+
+                    if (available == 0)
+                    {
+                        return false;
+                    }
+
+                    size_t count = limit;
+
+                    if (!operation->delimiter.empty())
+                    {
+                        const std::string &delimiter = operation->delimiter;
+                        size_t found = std::string::npos;
+
+                        if (scanned < limit)
+                        {
+                            found = find(buffer.data() + head + scanned, limit - scanned, delimiter.data(), delimiter.size());
+                        }
+
+                        if (found != std::string::npos)
+                        {
+                            count = scanned + found + delimiter.size();
+                        }
+                        else if (limit < operation->size && available < capacity)
+                        {
+                            // a delimiter may still start in the last delimiter.size() - 1 bytes
+                            scanned = limit >= delimiter.size() ? limit - delimiter.size() + 1 : 0;
+                            return false;
+                        }
+                    }
+
+                    operation->result.assign(buffer, head, count);
+                    head += count;
+
+                    if (head == buffer.size())
+                    {
+                        buffer.clear();
+                        head = 0;
+                    }
+
+                    return true;
+                }
+
+                internal::SerialPort &serial;
+                common::ListenerHandle listener;
+
+                std::mutex mutex;
+
+                // content is buffer[head:], consumed bytes are compacted away lazily
+                std::string buffer;
+                size_t head = 0;
+                size_t capacity;
+                size_t dropped_bytes = 0;
+
+                ReadOperation *reader = nullptr;
+                // read_until() positions from head known not to begin the delimiter
+                size_t scanned = 0;
+            };
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -48,6 +48,20 @@ namespace async_pyserial
         private:
             std::string msg;
         };
+
+        class TimeoutException : public std::exception
+        {
+        public:
+            explicit TimeoutException(const std::string &message) : msg(message) {}
+
+            virtual const char *what() const noexcept override
+            {
+                return msg.c_str();
+            }
+
+        private:
+            std::string msg;
+        };
     }
 }
 
@@ -0,0 +1,151 @@
+#ifndef ASYNC_PYSERIAL_COMMON_INPLACE_FUNCTION_H
+#define ASYNC_PYSERIAL_COMMON_INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        template <typename Signature, size_t Capacity = 32>
+        class InplaceFunction;
+
+        // a move-only std::function that does not allocate for callables up to Capacity bytes: they are stored
+        // in place, larger ones (or over-aligned ones, or ones that may throw when moved) are moved to the heap
+        // (a std::function itself fits in 32)
+        template <typename R, typename... Args, size_t Capacity>
+        class InplaceFunction<R(Args...), Capacity>
+        {
+        public:
+            InplaceFunction() noexcept = default;
+            InplaceFunction(std::nullptr_t) noexcept {}
+
+            template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InplaceFunction>::value>>
+            InplaceFunction(F &&f)
+            {
+                using Functor = std::decay_t<F>;
+
+                // empty function pointers and std::functions stay empty
+                if constexpr (std::is_pointer<Functor>::value || std::is_same<Functor, std::function<R(Args...)>>::value)
+                {
+                    if (!f)
+                    {
+                        return;
+                    }
+                }
+
+                if constexpr (fits<Functor>)
+                {
+                    new (storage) Functor(std::forward<F>(f));
+                    ops = &table<Functor>;
+                }
+                else
+                {
+                    new (storage) Functor *(new Functor(std::forward<F>(f)));
+                    ops = &boxed<Functor>;
+                }
+            }
+
+            InplaceFunction(InplaceFunction &&other) noexcept
+            {
+                take(other);
+            }
+
+            InplaceFunction &operator=(InplaceFunction &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    take(other);
+                }
+
+                return *this;
+            }
+
+            InplaceFunction(const InplaceFunction &) = delete;
+            InplaceFunction &operator=(const InplaceFunction &) = delete;
+
+            ~InplaceFunction()
+            {
+                reset();
+            }
+
+            explicit operator bool() const noexcept
+            {
+                return ops != nullptr;
+            }
+
+            R operator()(Args... args) const
+            {
+                if (ops == nullptr)
+                {
+                    throw std::bad_function_call();
+                }
+
+                return ops->invoke(storage, std::forward<Args>(args)...);
+            }
+
+            void reset() noexcept
+            {
+                if (ops != nullptr)
+                {
+                    ops->destroy(storage);
+                    ops = nullptr;
+                }
+            }
+
+        private:
+            struct Ops
+            {
+                R (*invoke)(void *, Args &&...);
+                // move constructs into dst and destroys src
+                void (*relocate)(void *dst, void *src);
+                void (*destroy)(void *);
+            };
+
+            template <typename Functor>
+            static constexpr bool fits = sizeof(Functor) <= Capacity && alignof(Functor) <= alignof(std::max_align_t) &&
+                                         std::is_nothrow_move_constructible<Functor>::value;
+
+            template <typename Functor>
+            static constexpr Ops table = {
+                [](void *f, Args &&...args) -> R
+                { return (*static_cast<Functor *>(f))(std::forward<Args>(args)...); },
+                [](void *dst, void *src)
+                {
+                    new (dst) Functor(std::move(*static_cast<Functor *>(src)));
+                    static_cast<Functor *>(src)->~Functor();
+                },
+                [](void *f)
+                { static_cast<Functor *>(f)->~Functor(); }};
+
+            // storage holds a pointer to the callable
+            template <typename Functor>
+            static constexpr Ops boxed = {
+                [](void *f, Args &&...args) -> R
+                { return (**static_cast<Functor **>(f))(std::forward<Args>(args)...); },
+                [](void *dst, void *src)
+                { new (dst) Functor *(*static_cast<Functor **>(src)); },
+                [](void *f)
+                { delete *static_cast<Functor **>(f); }};
+
+            void take(InplaceFunction &other) noexcept
+            {
+                if (other.ops != nullptr)
+                {
+                    other.ops->relocate(storage, other.storage);
+                    ops = std::exchange(other.ops, nullptr);
+                }
+            }
+
+            alignas(std::max_align_t) mutable unsigned char storage[Capacity];
+            const Ops *ops = nullptr;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef ASYNC_PYSERIAL_COMMON_PATTERN_MATCHER_H
+#define ASYNC_PYSERIAL_COMMON_PATTERN_MATCHER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include <common/record.h>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        struct PatternMatch
+        {
+            // index into the patterns the matcher was made with
+            size_t pattern;
+            // position of the first matched byte in the received stream, counted from the matcher's creation
+            uint64_t offset;
+            // up to `context` bytes before the match, the match and up to `context` bytes after it,
+            // of those received in the same chunk
+            std::string context;
+            // position of the match in context
+            size_t context_offset;
+        };
+
+        // finds any number of byte patterns in the received stream, across chunk boundaries
+        //
+        // an Aho-Corasick automaton compiled into a dense transition table over byte classes (the distinct
+        // bytes of the patterns, all others share one class), so the I/O thread does one table lookup per
+        // byte and only calls back for chunks that complete matches, with all of them at once. Overlapping
+        // matches are all reported, each with the chunk completing it so a prompt followed by silence is not held back
+        class PatternMatcher : public StreamSink
+        {
+        public:
+            using Callback = std::function<void(const std::vector<PatternMatch> &)>;
+
+            // throws SerialPortException when there are no patterns or one is empty
+            PatternMatcher(const std::vector<std::string> &patterns, size_t context, const Callback &callback);
+
+            void onChunk(StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) override;
+
+            // received bytes scanned
+            uint64_t position();
+
+            uint64_t matches() const;
+
+        private:
+            // set on transitions into states that complete a pattern
+            static const uint32_t MATCH = 0x80000000u;
+
+            struct Pending
+            {
+                size_t pattern;
+                uint64_t offset;
+            };
+
+            std::vector<std::string> patterns;
+            size_t context;
+            Callback callback;
+
+            uint16_t classes[256];
+            size_t class_count;
+
+            // state row + class -> next state row | MATCH, a row being state * class_count
+            std::vector<uint32_t> table;
+            // patterns ending at each state, through its suffixes
+            std::vector<std::vector<uint32_t>> outputs;
+
+            size_t max_size;
+
+            std::mutex mutex;
+
+            // row of the current state
+            uint32_t state;
+            uint64_t scanned;
+
+            // the last received bytes, ending at stream offset scanned
+            std::string history;
+
+            // matches of the chunk being scanned, kept for its capacity
+            std::vector<Pending> pending;
+
+            std::atomic<uint64_t> matched{0};
+
+            // moves pending matches into out, with their context in history
+            void collect(std::vector<PatternMatch> &out);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef ASYNC_PYSERIAL_COMMON_POOLED_QUEUE_H
+#define ASYNC_PYSERIAL_COMMON_POOLED_QUEUE_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        // a FIFO of T whose nodes come from slabs of SlabSize and are recycled through a free list, so once
+        // the pool has grown to the deepest queue seen, pushing and popping never allocate
+        //
+        // elements never move, references stay valid until popped (e.g. buffers handed to the kernel).
+        // T needs a reset() that releases what a popped element holds, it is reused as is
+        template <typename T, size_t SlabSize = 64>
+        class PooledQueue
+        {
+            struct Node
+            {
+                T value;
+                Node *next = nullptr;
+            };
+
+        public:
+            PooledQueue() = default;
+
+            PooledQueue(const PooledQueue &) = delete;
+            PooledQueue &operator=(const PooledQueue &) = delete;
+
+            ~PooledQueue()
+            {
+                clear();
+            }
+
+            // a reset element appended to the queue
+            T &emplace_back()
+            {
+                if (free_nodes == nullptr)
+                {
+                    grow();
+                }
+
+                Node *node = free_nodes;
+                free_nodes = node->next;
+
+                node->next = nullptr;
+
+                if (tail != nullptr)
+                {
+                    tail->next = node;
+                }
+                else
+                {
+                    head = node;
+                }
+
+                tail = node;
+                count++;
+
+                return node->value;
+            }
+
+            T &front() { return head->value; }
+
+            void pop_front()
+            {
+                Node *node = head;
+
+                head = node->next;
+
+                if (head == nullptr)
+                {
+                    tail = nullptr;
+                }
+
+                node->value.reset();
+
+                node->next = free_nodes;
+                free_nodes = node;
+
+                count--;
+            }
+
+            void clear()
+            {
+                while (head != nullptr)
+                {
+                    pop_front();
+                }
+            }
+
+            bool empty() const { return count == 0; }
+            size_t size() const { return count; }
+
+            class iterator
+            {
+            public:
+                explicit iterator(Node *node) : node(node) {}
+
+                T &operator*() const { return node->value; }
+                T *operator->() const { return &node->value; }
+
+                iterator &operator++()
+                {
+                    node = node->next;
+                    return *this;
+                }
+
+                bool operator!=(const iterator &other) const { return node != other.node; }
+                bool operator==(const iterator &other) const { return node == other.node; }
+
+            private:
+                Node *node;
+            };
+
+            iterator begin() { return iterator(head); }
+            iterator end() { return iterator(nullptr); }
+
+            // slabs allocated so far
+            size_t slabs() const { return slab_list.size(); }
+
+            // elements the pool holds, queued or free
+            size_t capacity() const { return slab_list.size() * SlabSize; }
+
+        private:
+            void grow()
+            {
+                slab_list.emplace_back(new Node[SlabSize]);
+
+                Node *slab = slab_list.back().get();
+
+                for (size_t i = 0; i < SlabSize; i++)
+                {
+                    slab[i].next = free_nodes;
+                    free_nodes = &slab[i];
+                }
+            }
+
+            std::vector<std::unique_ptr<Node[]>> slab_list;
+
+            Node *free_nodes = nullptr;
+            Node *head = nullptr;
+            Node *tail = nullptr;
+
+            size_t count = 0;
+        };
+    }
+}
+
+#endif
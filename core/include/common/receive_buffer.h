@@ -0,0 +1,71 @@
+#ifndef ASYNC_PYSERIAL_COMMON_RECEIVE_BUFFER_H
+#define ASYNC_PYSERIAL_COMMON_RECEIVE_BUFFER_H
+
+#include <string>
+#include <mutex>
+#include <condition_variable>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        // received data waiting for blocking reads, filled on the I/O thread
+        //
+        // with a capacity, up to capacity bytes are kept whether or not anyone reads and the rest is dropped,
+        // with capacity 0 only data arriving while a read waits is kept, up to the size it asked for
+        class ReceiveBuffer
+        {
+        public:
+            explicit ReceiveBuffer(size_t capacity = 0);
+
+            // with keep_overflow nothing is dropped past the capacity, for owners that stop reading once
+            // size() reaches it (the data already read is kept)
+            void set_capacity(size_t capacity, bool keep_overflow = false);
+
+            // returns the number of bytes kept
+            size_t append(const char *data, size_t size);
+
+            // up to size bytes, waiting until at least one is available,
+            // timeout_ms < 0 waits forever, throws TimeoutException or SerialPortException when closed
+            std::string read(size_t size, long timeout_ms);
+
+            // through the first delimiter, waiting like read() until it arrives, or max_bytes without one
+            // (also once a full buffer holds no delimiter), bytes searched by an earlier call are not searched again
+            std::string read_until(const std::string &delimiter, size_t max_bytes, long timeout_ms);
+
+            // up to size bytes without waiting, may be empty
+            std::string read_nowait(size_t size);
+
+            size_t size();
+
+            // reads fail while closed, close wakes the waiting ones and drops the content
+            void open();
+            void close();
+
+        private:
+            size_t available() const;
+            std::string take(size_t size);
+
+            std::mutex mutex;
+            std::condition_variable cv;
+
+            // content is buffer[head:], consumed bytes are compacted away lazily
+            std::string buffer;
+            size_t head;
+
+            size_t capacity;
+            bool keep_overflow;
+
+            // bytes asked for by waiting reads, the limit when capacity is 0
+            size_t wanted;
+
+            // read_until() start positions from head known not to begin scan_delimiter
+            std::string scan_delimiter;
+            size_t scanned;
+
+            bool closed;
+        };
+    }
+}
+
+#endif
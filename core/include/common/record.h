@@ -0,0 +1,87 @@
+#ifndef ASYNC_PYSERIAL_COMMON_RECORD_H
+#define ASYNC_PYSERIAL_COMMON_RECORD_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <mutex>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        enum StreamDirection : uint8_t
+        {
+            RX = 0,
+            TX = 1
+        };
+
+        // receives a copy of every chunk going through a port, called on the I/O thread
+        class StreamSink
+        {
+        public:
+            virtual ~StreamSink() = default;
+
+            virtual void onChunk(StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) = 0;
+        };
+
+        // record file layout (little endian):
+        //   file header:   "APSR" u16 version, u16 reserved
+        //   each record:   u64 monotonic timestamp (ns), u32 size, u8 direction, 3 bytes reserved, data
+        const char RECORD_MAGIC[4] = {'A', 'P', 'S', 'R'};
+        const uint16_t RECORD_VERSION = 1;
+
+        struct RecordFileHeader
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t reserved;
+        };
+
+        struct RecordHeader
+        {
+            uint64_t ts_ns;
+            uint32_t size;
+            uint8_t direction;
+            uint8_t reserved[3];
+        };
+
+        static_assert(sizeof(RecordFileHeader) == 8, "unexpected record file header size");
+        static_assert(sizeof(RecordHeader) == 16, "unexpected record header size");
+
+        uint64_t monotonic_ns();
+
+        class RecordWriter : public StreamSink
+        {
+        public:
+            explicit RecordWriter(const std::string &path);
+            ~RecordWriter();
+
+            void onChunk(StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) override;
+
+            void flush();
+            void close();
+
+        private:
+            FILE *file;
+            std::mutex mutex;
+        };
+
+        class RecordReader
+        {
+        public:
+            explicit RecordReader(const std::string &path);
+            ~RecordReader();
+
+            // returns false at the end of the file
+            bool next(RecordHeader &header, std::string &data);
+
+            void rewind();
+
+        private:
+            FILE *file;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef ASYNC_PYSERIAL_COMMON_SEARCH_H
+#define ASYNC_PYSERIAL_COMMON_SEARCH_H
+
+#include <cstddef>
+#include <string>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        // offset of the first occurrence of needle in data, or std::string::npos
+        //
+        // single bytes use memchr, longer needles start with memchr on their first byte and, when that
+        // byte turns out to be frequent, compare the first and last needle byte over 32 (AVX2, picked
+        // at runtime) or 16 (SSE2) positions at once and memcmp the candidates
+        size_t find(const char *data, size_t size, const char *needle, size_t needle_size);
+    }
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef ASYNC_PYSERIAL_COMMON_SUBMIT_QUEUE_H
+#define ASYNC_PYSERIAL_COMMON_SUBMIT_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        // a bounded lock-free queue of T filled by any number of threads and drained by one at a time,
+        // Vyukov's array queue: each slot carries a sequence number telling whose turn it is
+        //
+        // it also counts the elements pushed and not drained, so only the push that finds the queue idle
+        // has to wake the consumer. T needs a reset() like for PooledQueue
+        template <typename T, size_t Capacity = 256>
+        class SubmitQueue
+        {
+            static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                T value;
+            };
+
+        public:
+            SubmitQueue() : slots(new Slot[Capacity])
+            {
+                for (size_t i = 0; i < Capacity; i++)
+                {
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            SubmitQueue(const SubmitQueue &) = delete;
+            SubmitQueue &operator=(const SubmitQueue &) = delete;
+
+            // calls fill with a reset element and publishes it, false when the queue is full (fill is not called),
+            // wake is set when the consumer has to be woken up
+            template <typename Fill>
+            bool push(Fill &&fill, bool &wake)
+            {
+                size_t position = tail.load(std::memory_order_relaxed);
+                Slot *slot;
+
+                while (true)
+                {
+                    slot = &slots[position & (Capacity - 1)];
+
+                    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                    intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                    if (diff == 0)
+                    {
+                        if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // the consumer has not drained the slot from the previous lap
+                        return false;
+                    }
+                    else
+                    {
+                        position = tail.load(std::memory_order_relaxed);
+                    }
+                }
+
+                fill(slot->value);
+
+                slot->sequence.store(position + 1, std::memory_order_release);
+
+                wake = pending.fetch_add(1, std::memory_order_acq_rel) == 0;
+
+                return true;
+            }
+
+            // calls take with every published element in order, callers serialize drains,
+            // returns true when elements are left behind a slot whose producer has not published it yet,
+            // the consumer has to look again later as no push will wake it for them
+            template <typename Take>
+            bool drain(Take &&take)
+            {
+                int64_t count = 0;
+
+                while (true)
+                {
+                    Slot &slot = slots[head & (Capacity - 1)];
+
+                    if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+                    {
+                        break;
+                    }
+
+                    take(slot.value);
+
+                    slot.value.reset();
+                    slot.sequence.store(head + Capacity, std::memory_order_release);
+
+                    head++;
+                    count++;
+                }
+
+                // may go below 0 when a drain took elements whose push has not counted them yet
+                return pending.fetch_sub(count, std::memory_order_acq_rel) - count > 0;
+            }
+
+            static constexpr size_t capacity() { return Capacity; }
+
+        private:
+            std::unique_ptr<Slot[]> slots;
+
+            alignas(64) std::atomic<size_t> tail{0};
+            alignas(64) std::atomic<int64_t> pending{0};
+
+            // only touched by the consumer
+            alignas(64) size_t head = 0;
+        };
+    }
+}
+
+#endif
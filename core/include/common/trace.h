@@ -0,0 +1,80 @@
+#ifndef ASYNC_PYSERIAL_COMMON_TRACE_H
+#define ASYNC_PYSERIAL_COMMON_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ASYNC_PYSERIAL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define ASYNC_PYSERIAL_UNLIKELY(x) (x)
+#endif
+
+// record a trace event, costs a single (predicted) branch when tracing is disabled
+#define ASYNC_PYSERIAL_TRACE(type, phase, port, arg)                                          \
+    do {                                                                                      \
+        if (ASYNC_PYSERIAL_UNLIKELY(async_pyserial::common::trace::enabled.load(std::memory_order_relaxed))) \
+            async_pyserial::common::trace::record((type), (phase), (port), (arg));            \
+    } while (0)
+
+namespace async_pyserial
+{
+    namespace common
+    {
+        namespace trace
+        {
+            enum TraceEventType : uint16_t
+            {
+                EPOLL_WAKEUP = 1,
+                READ = 2,
+                WRITE = 3,
+                WRITE_SUBMIT = 4,
+                WRITE_COMPLETE = 5,
+                EMIT = 6,
+                GIL_ACQUIRE = 7,
+                PY_CALLBACK = 8
+            };
+
+            enum TracePhase : char
+            {
+                BEGIN = 'B',
+                END = 'E',
+                INSTANT = 'i'
+            };
+
+            // fixed size binary record, 24 bytes
+            struct TraceRecord
+            {
+                uint64_t ts_ns;
+                uint64_t arg;
+                int32_t port;
+                uint16_t type;
+                char phase;
+                uint8_t reserved;
+            };
+
+            const size_t DEFAULT_CAPACITY = 65536;
+
+            extern std::atomic<bool> enabled;
+
+            void record(uint16_t type, char phase, int port, uint64_t arg);
+
+            // capacity is the number of records kept per thread
+            void enable(size_t capacity = DEFAULT_CAPACITY);
+            void disable();
+            void clear();
+
+            void set_thread_name(const std::string &name);
+            void set_port_name(int port, const std::string &name);
+            // the port's fd is closed, records made before keep the name
+            void clear_port_name(int port);
+
+            // Chrome / Perfetto trace event format
+            std::string dump_chrome_json();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_CAPTURE_LOG_H
+#define ASYNC_PYSERIAL_LINUX_CAPTURE_LOG_H
+
+#include <string>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+#include <common/record.h>
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        // segment layout (little endian):
+        //   CaptureSegmentHeader, then records aligned to 8 bytes:
+        //   u64 monotonic timestamp (ns), u32 size, u16 channel, u8 direction, u8 reserved, data
+        // `committed` is the crash-safe tail marker, only bytes before it are complete records
+        const char CAPTURE_MAGIC[4] = {'A', 'P', 'S', 'C'};
+        const uint16_t CAPTURE_VERSION = 1;
+        const uint16_t CAPTURE_SEALED = 1;
+
+        struct CaptureSegmentHeader
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t flags;
+            uint32_t header_size;
+            uint32_t reserved;
+            uint64_t segment_index;
+            uint64_t segment_size;
+            uint64_t created_realtime_ns;
+            uint64_t created_monotonic_ns;
+            uint64_t committed;
+            uint64_t records;
+        };
+
+        struct CaptureRecordHeader
+        {
+            uint64_t ts_ns;
+            uint32_t size;
+            uint16_t channel;
+            uint8_t direction;
+            uint8_t reserved;
+        };
+
+        static_assert(sizeof(CaptureSegmentHeader) == 64, "unexpected capture segment header size");
+        static_assert(sizeof(CaptureRecordHeader) == 16, "unexpected capture record header size");
+
+        struct CaptureLogOptions
+        {
+            std::string directory;
+            std::string prefix = "capture";
+            // preallocated size of each segment file
+            uint64_t segment_size = 64 * 1024 * 1024;
+            // oldest segments are removed beyond this count, 0 keeps everything
+            unsigned int max_segments = 0;
+            // dirty pages are scheduled for writeback (msync MS_ASYNC) at this interval, 0 leaves it to the kernel
+            unsigned long flush_interval_ms = 1000;
+        };
+
+        struct CaptureLogStats
+        {
+            uint64_t records = 0;
+            uint64_t bytes = 0;
+            uint64_t segments = 0;
+            uint64_t dropped = 0;
+        };
+
+        // memory-mapped, segment-rotated log of every chunk of the attached ports
+        class CaptureLog
+        {
+        public:
+            CaptureLog(const CaptureLogOptions &options);
+            ~CaptureLog();
+
+            void append(uint16_t channel, common::StreamDirection direction, uint64_t ts_ns, const char *data, size_t size);
+
+            void close();
+
+            bool is_open();
+
+            CaptureLogStats stats();
+
+            std::string current_segment();
+
+        private:
+            void openSegment();
+            void sealSegment();
+            void removeOldSegments();
+            std::string segmentPath(uint64_t index);
+
+            CaptureLogOptions options;
+
+            std::mutex mutex;
+
+            int fd;
+            char *base;
+            CaptureSegmentHeader *header;
+            uint64_t offset;
+            uint64_t segment_index;
+            uint64_t first_segment_index;
+            uint64_t last_flush_ns;
+
+            CaptureLogStats _stats;
+        };
+
+        // binds a CaptureLog to one port, tagging its records with a channel id
+        class CaptureChannel : public common::StreamSink
+        {
+        public:
+            CaptureChannel(const std::shared_ptr<CaptureLog> &log, uint16_t channel) : log(log), channel(channel) {}
+
+            void onChunk(common::StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) override
+            {
+                log->append(channel, direction, ts_ns, data, size);
+            }
+
+            const std::shared_ptr<CaptureLog> log;
+            const uint16_t channel;
+        };
+    }
+}
+
+#endif
+
+#endif
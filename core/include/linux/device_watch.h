@@ -0,0 +1,42 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_DEVICE_WATCH_H
+#define ASYNC_PYSERIAL_LINUX_DEVICE_WATCH_H
+
+#include <string>
+#include <vector>
+
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        // non-blocking inotify on device directories (e.g. /dev and /dev/serial/by-id),
+        // reporting entries that are created, renamed into place or have their permissions changed
+        class DeviceWatch
+        {
+        public:
+            // throws OSException when inotify is unavailable
+            DeviceWatch();
+            ~DeviceWatch();
+
+            // missing directories are skipped and can be added again later,
+            // e.g. /dev/serial/by-id disappears with the last usb serial device
+            void watch(const std::string &directory);
+
+            // pollable fd, readable when changes are pending
+            int fd();
+
+            // consumes the pending changes, returns the names of the entries changed
+            std::vector<std::string> drain();
+
+        private:
+            int inotify_fd;
+        };
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,48 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_LIST_PORTS_H
+#define ASYNC_PYSERIAL_LINUX_LIST_PORTS_H
+
+#include <string>
+#include <vector>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        struct PortInfo
+        {
+            // e.g. /dev/ttyUSB0 and ttyUSB0
+            std::string device;
+            std::string name;
+
+            // the bus of the device the port belongs to, e.g. usb, usb-serial, pci, pnp or platform
+            std::string subsystem;
+            std::string driver;
+            // the sysfs path of that device
+            std::string hwid;
+
+            // usb only, -1 when unknown
+            int vid = -1;
+            int pid = -1;
+            int interface_number = -1;
+            std::string serial_number;
+            std::string manufacturer;
+            std::string product;
+            std::string interface;
+            // usb port path and interface, e.g. 1-1.2:1.0
+            std::string location;
+
+            // /dev/serial/by-id and /dev/serial/by-path symlinks to the device
+            std::vector<std::string> links;
+        };
+
+        // serial ports with a backing device, read from /sys/class/tty and the usb descriptors in sysfs,
+        // the result is cached until an entry in /dev or /dev/serial changes (or refresh is set)
+        std::vector<PortInfo> list_ports(bool refresh = false);
+    }
+}
+
+#endif
+
+#endif
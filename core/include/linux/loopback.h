@@ -0,0 +1,116 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_LOOPBACK_H
+#define ASYNC_PYSERIAL_LINUX_LOOPBACK_H
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <cstdint>
+
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        #define LOOPBACK_MAX_EVENTS 64
+
+        struct LoopbackOptions
+        {
+            // emulated line rate, 0 means unlimited
+            unsigned long baudrate = 0;
+            // bits per character on the emulated line (start + data + parity + stop)
+            unsigned char bits_per_char = 10;
+            // max bytes delivered per write to the peer, 0 means unlimited
+            size_t chunk_size = 0;
+            // probability that a received chunk is dropped
+            double drop_rate = 0;
+            // probability that a byte gets a bit flipped
+            double corrupt_rate = 0;
+            unsigned int seed = 0;
+        };
+
+        struct LoopbackPair
+        {
+            std::string port_a;
+            std::string port_b;
+        };
+
+        struct LoopbackStats
+        {
+            uint64_t forwarded = 0;
+            uint64_t dropped = 0;
+            uint64_t corrupted = 0;
+        };
+
+        // in-process replacement for `socat PTY PTY`, all pairs are pumped by one thread
+        class Loopback
+        {
+        public:
+            Loopback(const LoopbackOptions &options);
+            ~Loopback();
+
+            std::vector<LoopbackPair> open(size_t count);
+
+            void close();
+
+            bool is_open();
+
+            LoopbackStats stats();
+
+        private:
+            struct Pty
+            {
+                int master_fd;
+                int slave_fd;
+                std::string path;
+                uint32_t events;
+            };
+
+            struct Direction
+            {
+                int src;
+                int dst;
+                std::string pending;
+                double tokens;
+                uint64_t last_refill;
+                bool blocked;
+            };
+
+            Pty openPty();
+
+            void pumpWorker();
+
+            void fill(Direction &dir);
+            void flush(Direction &dir, uint64_t now);
+            void updateEvents(size_t index);
+            int nextTimeout(uint64_t now);
+
+            LoopbackOptions options;
+
+            std::vector<Pty> ptys;
+            std::vector<Direction> directions;
+
+            std::mt19937 rng;
+            std::uniform_real_distribution<double> uniform;
+
+            std::thread pumpThread;
+
+            int epoll_fd;
+            int notify_fd;
+
+            bool _is_open;
+
+            std::atomic<uint64_t> forwarded;
+            std::atomic<uint64_t> dropped;
+            std::atomic<uint64_t> corrupted;
+        };
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_POLL_SCHEDULER_H
+#define ASYNC_PYSERIAL_LINUX_POLL_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include <common/record.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        class SerialPort;
+
+        // how the end of a response is found, by terminator when it is set, otherwise by length
+        struct PollMatcher
+        {
+            size_t length = 0;
+            std::string terminator;
+            // longer responses are cut here and reported as POLL_OVERFLOW
+            size_t max_bytes = 256;
+        };
+
+        enum PollStatus : unsigned char
+        {
+            POLL_OK = 0,
+            POLL_TIMEOUT = 1,
+            // the request could not be written, reported once the timeout expired
+            POLL_WRITE_ERROR = 2,
+            POLL_OVERFLOW = 3
+        };
+
+        struct PollResult
+        {
+            // index returned by PollScheduler::add
+            uint32_t entry;
+            PollStatus status;
+            // what was received, up to the end the matcher found
+            std::string response;
+            // from queueing the request to the end of the response or the timeout
+            uint64_t latency_ns;
+        };
+
+        struct PollStats
+        {
+            uint64_t requests;
+            uint64_t responses;
+            uint64_t timeouts;
+            // write errors and overflows
+            uint64_t errors;
+            // bytes received while no request was waiting for a response
+            uint64_t unsolicited;
+            // results equal to the previous one of their entry, with changes_only
+            uint64_t suppressed;
+        };
+
+        // request/response polling of many devices on many ports without Python in the loop
+        //
+        // every port is a lane with one request outstanding at a time, as on a half duplex bus. Responses are
+        // matched on the port's I/O thread, which queues the next due request of the lane at once, so a port is
+        // kept busy back-to-back. Entries of a lane that are due take turns. A timer thread only handles the
+        // timeouts and lanes waiting for their next period
+        class PollScheduler : public std::enable_shared_from_this<PollScheduler>
+        {
+        public:
+            // called with mutex held, on I/O threads and the timer thread, it must not call back into the scheduler
+            using Callback = std::function<void(PollResult &&)>;
+
+            // made by make_shared, changes_only drops results equal to the previous one of their entry
+            PollScheduler(const Callback &callback, bool changes_only);
+            ~PollScheduler();
+
+            // polls the port with request every period_ns (0 back-to-back) from now on, the entry's first
+            // request is due at once. Throws SerialPortException when the matcher finds no end, or when closed
+            uint32_t add(SerialPort *port, const std::string &request, const PollMatcher &matcher, uint64_t period_ns, uint64_t timeout_ns);
+
+            // stops polling, no result is reported after it returns
+            void close();
+
+            PollStats stats();
+
+        private:
+            // the sink of a port, forwards its received chunks while the scheduler lives
+            class Lane : public common::StreamSink
+            {
+            public:
+                Lane(const std::weak_ptr<PollScheduler> &scheduler, uint32_t index);
+
+                void onChunk(common::StreamDirection direction, uint64_t ts_ns, const char *data, size_t size) override;
+
+            private:
+                std::weak_ptr<PollScheduler> scheduler;
+                uint32_t index;
+            };
+
+            struct Entry
+            {
+                uint32_t lane;
+                std::string request;
+                PollMatcher matcher;
+                uint64_t period_ns;
+                uint64_t timeout_ns;
+                uint64_t due;
+
+                bool reported = false;
+                PollStatus last_status = POLL_OK;
+                std::string last_response;
+            };
+
+            struct LaneState
+            {
+                SerialPort *port;
+                std::shared_ptr<Lane> sink;
+                std::vector<uint32_t> entries;
+                // where the turns of due entries continue
+                size_t cursor = 0;
+
+                // the entry waiting for its response, -1 when idle
+                int64_t active = -1;
+                // tells completions of earlier requests apart
+                uint32_t generation = 0;
+                uint64_t sent_at = 0;
+                uint64_t deadline = 0;
+                bool write_failed = false;
+                std::string response;
+            };
+
+            struct Send
+            {
+                uint32_t lane;
+                uint32_t generation;
+                const std::string *request;
+            };
+
+            void onReceive(uint32_t lane, const char *data, size_t size);
+            void written(uint32_t lane, uint32_t generation, unsigned long err);
+
+            // with mutex held: queues the next due entry of an idle lane into sends, otherwise returns
+            // when the lane has to be looked at again
+            uint64_t startNext(uint32_t lane, uint64_t now, std::vector<Send> &sends);
+            // with mutex held: reports the active entry and starts the next one
+            void finish(uint32_t lane, PollStatus status, uint64_t now, std::vector<Send> &sends);
+            // with mutex held: wakes the timer thread when it sleeps past deadline
+            void wakeBy(uint64_t deadline);
+
+            // without mutex, write() may complete at once
+            void send(const std::vector<Send> &sends);
+
+            void run();
+
+            Callback callback;
+            bool changes_only;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            // references stay valid while entries are added
+            std::deque<Entry> entries;
+            std::vector<LaneState> lanes;
+            PollStats counters{};
+            bool closing = false;
+            // when the timer thread wakes up next, UINT64_MAX when it waits for a change
+            uint64_t wake_at = 0;
+
+            std::thread thread;
+        };
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_REPLAY_H
+#define ASYNC_PYSERIAL_LINUX_REPLAY_H
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <atomic>
+#include <cstdint>
+
+#include <common/event.h>
+#include <common/record.h>
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        #define REPLAY_MAX_EVENTS 64
+
+        struct ReplayOptions
+        {
+            // 1.0 keeps the recorded timing, N plays N times faster, 0 plays as fast as possible
+            double speed = 1.0;
+            bool loop = false;
+            // replay sent chunks as well as received ones
+            bool include_tx = false;
+        };
+
+        // replays record files on a single reactor thread, into ptys or straight into emitters
+        class Replayer
+        {
+        public:
+            Replayer();
+            ~Replayer();
+
+            // returns the pty path a SerialPort can open to receive the replayed stream
+            std::string addPty(const std::string &path, const ReplayOptions &options);
+
+            void addEmitter(const std::string &path, const ReplayOptions &options, common::EventEmitter *emitter, common::EventType eventType);
+
+            void start();
+            void stop();
+
+            bool is_running();
+
+            // number of replays not finished yet
+            size_t active();
+
+            // wait until all replays finish, returns false on timeout
+            bool wait(long timeout_ms);
+
+        private:
+            struct Session
+            {
+                std::unique_ptr<common::RecordReader> reader;
+                ReplayOptions options;
+
+                int master_fd = -1;
+                int slave_fd = -1;
+
+                common::EventEmitter *emitter = nullptr;
+                common::EventType eventType = 0;
+
+                common::RecordHeader header;
+                std::string data;
+                size_t offset = 0;
+
+                uint64_t base_ts = 0;
+                uint64_t start_ns = 0;
+
+                bool done = false;
+            };
+
+            void reactorWorker();
+
+            void addSession(std::unique_ptr<Session> session);
+            void activate(size_t index);
+            bool loadNext(Session &session);
+            uint64_t dueTime(const Session &session);
+            bool deliver(size_t index);
+            void finish(Session &session);
+            void armTimer(uint64_t due);
+
+            std::vector<std::unique_ptr<Session>> sessions;
+            std::vector<std::unique_ptr<Session>> incoming;
+
+            std::priority_queue<std::pair<uint64_t, size_t>, std::vector<std::pair<uint64_t, size_t>>,
+                                std::greater<std::pair<uint64_t, size_t>>> schedule;
+
+            std::thread reactorThread;
+
+            std::mutex mutex;
+            std::condition_variable done_cv;
+
+            size_t _active;
+
+            int epoll_fd;
+            int notify_fd;
+            int timer_fd;
+
+            // read by the worker and is_running() without a lock
+            std::atomic<bool> running;
+        };
+    }
+}
+
+#endif
+
+#endif
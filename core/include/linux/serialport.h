@@ -6,31 +6,143 @@
 #include <iostream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <base/serialport.h>
 #include <common/event.h>
 #include <common/exception.h>
-#include <deque>
+#include <common/record.h>
+#include <common/inplace_function.h>
+#include <common/pooled_queue.h>
+#include <common/submit_queue.h>
 #include <mutex>
+#include <memory>
+#include <atomic>
 #include <common/common.h>
+#include <linux/uring.h>
+#include <linux/thread.h>
+#include <linux/device_watch.h>
+#include <linux/write_schedule.h>
 
 #include <sys/epoll.h>
+#include <sys/uio.h>
+#include <linux/serial.h>
 
 namespace async_pyserial
 {
     namespace internal
     {
         #define EPOLL_MAX_EVENTS 8
+        #define ICOUNT_INTERVAL_NS 10000000ULL
+        #define WRITE_SLAB_SIZE 64
+        #define WRITE_SUBMIT_SIZE 256
+        #define RS485_ECHO_LIMIT 65536
 
         enum SerialPortEvent : common::EventType
         {
-            ON_DATA = 1
+            ON_DATA = 1,
+            // the device hung up or returned an I/O error, emitted without arguments
+            ON_DISCONNECT = 2,
+            // options.reconnect reopened the device, emitted without arguments
+            ON_RECONNECT = 3,
+            // received data was lost, emitted with the ReceiveStats increments
+            ON_OVERFLOW = 4
         };
 
+        enum OverflowPolicy : unsigned char
+        {
+            OVERFLOW_DROP = 0,
+            OVERFLOW_PAUSE = 1
+        };
+
+        // why reading is paused, reading resumes once no reason is left
+        enum ReadPause : unsigned char
+        {
+            PAUSE_USER = 1,
+            PAUSE_OVERFLOW = 2
+        };
+
+        // received data lost since open
+        struct ReceiveStats
+        {
+            // TIOCGICOUNT counters, always 0 for ptys and drivers without them
+            // characters lost in the uart fifo
+            uint64_t overrun = 0;
+            // characters lost because the tty buffer was full
+            uint64_t buf_overrun = 0;
+            uint64_t frame = 0;
+            uint64_t parity = 0;
+            uint64_t brk = 0;
+            // bytes dropped by user-space receive buffers, see reportDropped()
+            uint64_t dropped = 0;
+        };
+
+        enum ReconnectWritePolicy : unsigned char
+        {
+            RECONNECT_FAIL_WRITES = 0,
+            RECONNECT_BUFFER_WRITES = 1
+        };
+
+        enum IOEngine : unsigned char
+        {
+            EPOLL_ENGINE = 0,
+            IO_URING_ENGINE = 1
+        };
+
+        enum RS485Mode : unsigned char
+        {
+            RS485_OFF = 0,
+            RS485_KERNEL = 1,
+            RS485_USER = 2
+        };
+
+        enum ReconfigureMode : unsigned char
+        {
+            RECONFIGURE_NOW = 0,
+            RECONFIGURE_DRAIN = 1
+        };
+
+        // called once with the result of a write, does not allocate for callables up to 32 bytes, see common::InplaceFunction
+        using WriteCallback = common::InplaceFunction<void(unsigned long)>;
+
+        // a queued write, pooled by the port's write queue and reused
         struct IOEvent {
-            std::string data;
-            size_t bytes_written;
-            std::function<void(unsigned long)> callback;
+            // payloads up to this size are stored in place
+            static const size_t INLINE_PAYLOAD = 64;
+
+            // the segments gathered in place, size is their total and at most INLINE_PAYLOAD
+            void assign(const struct iovec *segments, size_t count, size_t size);
+            void assign(std::string &&data);
+
+            const char *data() const { return length <= INLINE_PAYLOAD ? small : large.data(); }
+            size_t size() const { return length; }
+
+            // back to an empty event, freeing a large payload
+            void reset();
+
+            size_t bytes_written = 0;
+            WriteCallback callback;
+            // a reconfigure() in progress, writing stops here and the callback is called
+            // (possibly more than once) when it reaches the front of the queue
+            bool barrier = false;
+
+        private:
+            size_t length = 0;
+            char small[INLINE_PAYLOAD];
+            std::string large;
+        };
+
+        // write allocations since the port was made
+        struct WriteStats
+        {
+            // writes queued
+            uint64_t requests = 0;
+            // writes with payloads over IOEvent::INLINE_PAYLOAD bytes, each allocated a copy
+            uint64_t heap_payloads = 0;
+            // slabs of WRITE_SLAB_SIZE events the write queue grew by
+            uint64_t slab_allocations = 0;
+            // events the write queue holds, queued or free
+            uint64_t pooled = 0;
         };
 
         class SerialPort : public common::EventEmitter
@@ -43,18 +155,138 @@ namespace async_pyserial
 
             void close();
             
-            void write(const std::string &data, const std::function<void(unsigned long)>& callback);
+            void write(const std::string &data, WriteCallback callback);
+            // the payload is copied before returning
+            void write(const char *data, size_t size, WriteCallback callback);
+            // the segments are gathered into one write with a single completion, nothing is written in between
+            void write(const struct iovec *segments, size_t count, WriteCallback callback);
+
+            WriteStats write_stats();
+
+            // data is queued by the I/O thread at at_ns on CLOCK_MONOTONIC, then every period_ns unless 0,
+            // see WriteSchedule, throws SerialPortException when the port is not open
+            std::shared_ptr<ScheduledWrite> schedule_write(const std::string &data, uint64_t at_ns, uint64_t period_ns);
 
             bool is_open();
 
+            // false while a supervised port waits for its device to come back
+            bool is_connected();
+
+            // applies baudrate, bytesize, stopbits and parity to the open port, keeping the worker and queues,
+            // RECONFIGURE_DRAIN first waits until the writes queued before this call are transmitted, so it
+            // throws SerialPortException on the I/O thread (e.g. in a callback), which would wait for itself
+            void reconfigure(const base::SerialPortOptions &options, ReconfigureMode mode);
+
+            // stops reading the device, so once the kernel buffer fills the driver applies flow control,
+            // a chunk already being read is still delivered
+            void pause_reading(ReadPause reason = PAUSE_USER);
+            void resume_reading(ReadPause reason = PAUSE_USER);
+            bool is_reading();
+
+            ReceiveStats receive_stats();
+
+            // counts bytes a receive buffer had no room for and emits ON_OVERFLOW,
+            // called by its owner on the I/O thread
+            void reportDropped(size_t bytes);
+
+            // the engine actually in use, io_uring falls back to epoll when unavailable
+            IOEngine io_engine();
+
+            // how options.rs485 was applied, RS485_KERNEL falls back to RS485_USER when the driver has no RS-485 mode
+            RS485Mode rs485_mode();
+
+            // how the worker thread's affinity, scheduling and name options were applied,
+            // with io_uring the worker is the engine thread shared by every port
+            ThreadStatus thread_status();
+
+            // sinks see every received and sent chunk on the worker thread
+            void addSink(const std::shared_ptr<common::StreamSink> &sink);
+            void removeSink(const std::shared_ptr<common::StreamSink> &sink);
+
         private:
-            void configure(unsigned long baudRate, unsigned char byteSize, unsigned char stopBits, unsigned char parity);
+            friend class UringEngine;
+
+            // action is the tcsetattr optional_actions
+            void configure(unsigned long baudRate, unsigned char byteSize, unsigned char stopBits, unsigned char parity, int action);
+
+            void resumeWrites();
+
+            // applies options.rs485 after configure(), idles the driver enable of RS485_USER
+            void configureRS485();
+            // RS485_USER, on the worker without w_mutex: raises the driver enable before a transmission, and drops
+            // it once TIOCOUTQ is empty and the shift register had a character time to send the last byte
+            void beginTransmit();
+            void endTransmit();
+            void setDriverEnable(bool sending);
+
+            // with options.rs485_suppress_echo, on the I/O thread: remembers transmitted bytes, and returns
+            // how many of the received ones are their echo
+            void recordEcho(const char *data, size_t size);
+            size_t skipEcho(const char *data, size_t size);
+
+            // EPOLLIN unless reading is paused, with EPOLLOUT when writing
+            uint32_t serialEvents(bool writing);
+            // applies read_paused to the engine in use
+            void updateReading();
 
             void startEpollWorker();
             void stopEpollWorker();
 
             void epollWorker();
 
+            void notifySinks(common::StreamDirection direction, const char *data, size_t size);
+
+            // FIONREAD sized reads until drained, within options.read_budget,
+            // returns false when the device hung up or failed
+            bool drainRead(std::string &chunk);
+
+            // returns whether the worker keeps running to reconnect
+            bool onDisconnect();
+            // on the engine thread when io_uring failed: fails the queued writes and emits ON_DISCONNECT,
+            // the port is not reconnected
+            void onEngineFailure();
+            // scheduled attempts advance the backoff, attempts on device changes don't
+            void tryReconnect(bool scheduled);
+            void watchDevice();
+            // epoll_wait timeout until the next scheduled attempt
+            int reconnectTimeout();
+            // epoll_wait timeout until the next reconnect attempt or write deadline
+            int workerTimeout();
+            // with w_mutex held, when a write of bytes waiting for the driver fails, 0 without options.write_timeout:
+            // write_timeout plus the line time of the bytes and of the output the driver still holds. Both engines
+            // fail the front write when the driver takes none of it by then, the writes behind it go on
+            uint64_t writeDeadline(size_t bytes);
+
+            // shared by the epoll and io_uring engines
+            void onReceive(const char *data, size_t size);
+
+            // appends to w_queue and counts it in write_counters, with w_mutex held
+            void queueWrite(IOEvent &&io_evt);
+            // moves the writes submitted without the lock to w_queue, with w_mutex held,
+            // returns true when the worker has to look again later, see common::SubmitQueue::drain
+            bool takeSubmissions();
+            // empties the queue and the submissions with w_mutex held, the callbacks of the
+            // dropped writes are called with FAILURE by the caller once w_mutex is released
+            std::vector<WriteCallback> takeQueued();
+            // the worker has to drain submissions
+            void wakeWriter();
+            // once running is cleared, before draining or closing what wakeWriter() uses:
+            // waits for the writes that passed their running check to be queued
+            void waitWriters();
+            // the caller is the port's epoll worker or the io_uring engine thread
+            bool onIOThread();
+
+            // queues the scheduled writes that are due, on the I/O thread
+            void fireSchedule();
+
+            // compares the TIOCGICOUNT error counters with the last ones, at most every ICOUNT_INTERVAL_NS,
+            // reset starts over from the current counters (e.g. after opening)
+            void checkCounters(bool reset);
+
+            bool openUring();
+
+            std::string threadName();
+
             std::wstring portName;
 
             base::SerialPortOptions options;
@@ -68,11 +300,58 @@ namespace async_pyserial
             int serial_fd;
             int epoll_fd;
 
-            bool _is_open;
-            bool running;
+            std::shared_ptr<UringEngine> engine;
+            int uring_slot;
 
-            std::deque<IOEvent> w_queue;
+            ThreadStatus worker_status;
+
+            // changed by the worker with w_mutex held, write() reads it without
+            std::atomic<bool> connected{true};
+            // the device the port name resolved to when last opened, e.g. /dev/ttyUSB0 for a by-id symlink
+            std::string device_path;
+            std::unique_ptr<DeviceWatch> device_watch;
+            // made by open(), its timerfd is polled by the worker
+            std::unique_ptr<WriteSchedule> schedule;
+            uint64_t reconnect_at = 0;
+            unsigned long reconnect_delay = 0;
+            // when the epoll worker fails the front write, 0 while it has not waited for the driver,
+            // written by the worker with w_mutex held
+            uint64_t write_deadline = 0;
+
+            RS485Mode rs485_active = RS485_OFF;
+            bool transmitting = false;
+            // line time of one character with the current settings, set by configure()
+            std::atomic<uint64_t> char_ns{0};
+            // transmitted bytes whose echo has not arrived from echo_offset on, only touched by the I/O thread
+            std::string echo;
+            size_t echo_offset = 0;
+
+            // read by is_connected() without w_mutex
+            std::atomic<bool> _is_open;
+            // the worker also wakes up for writes, this tells it to stop
+            std::atomic<bool> running;
+            // write() calls between their running check and their wakeup
+            std::atomic<int> writers{0};
+
+            // ReadPause bits
+            std::atomic<unsigned char> read_paused{0};
+
+            ReceiveStats stats;
+            std::mutex stats_mutex;
+            bool icount_supported = true;
+            struct serial_icounter_struct icount;
+            uint64_t icount_checked = 0;
+
+            common::PooledQueue<IOEvent, WRITE_SLAB_SIZE> w_queue;
             std::mutex w_mutex;
+            // write() pushes here without w_mutex, the worker moves them to w_queue, falls back to w_mutex when full
+            common::SubmitQueue<IOEvent, WRITE_SUBMIT_SIZE> submissions;
+            // guarded by w_mutex
+            WriteStats write_counters;
+
+            std::shared_ptr<const std::vector<std::shared_ptr<common::StreamSink>>> sinks;
+            std::atomic<bool> has_sinks{false};
+            std::mutex sinks_mutex;
         };
     }
 }
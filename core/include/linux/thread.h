@@ -0,0 +1,45 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_THREAD_H
+#define ASYNC_PYSERIAL_LINUX_THREAD_H
+
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include <base/serialport.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        // linux caps thread names at 15 characters
+        #define THREAD_NAME_MAX 15
+
+        // result of applying SerialPortOptions' thread options to an I/O worker,
+        // each error is 0 on success or when the option is unset, otherwise an errno value
+        struct ThreadStatus
+        {
+            bool applied = false;
+
+            std::vector<int> cpu_affinity;
+            int affinity_error = 0;
+
+            int sched_policy = 0;
+            int sched_priority = 0;
+            int sched_error = 0;
+
+            std::string name;
+            int name_error = 0;
+        };
+
+        // pins, prioritizes and names `thread`, never throws, insufficient privileges
+        // (e.g. EPERM for SCHED_FIFO without CAP_SYS_NICE) are only reported in the status
+        ThreadStatus applyThreadOptions(pthread_t thread, const base::SerialPortOptions &options, const std::string &default_name);
+    }
+}
+
+#endif
+
+#endif
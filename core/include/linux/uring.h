@@ -0,0 +1,219 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_URING_H
+#define ASYNC_PYSERIAL_LINUX_URING_H
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        class SerialPort;
+
+        #define URING_SQ_ENTRIES 256
+        #define URING_CQ_ENTRIES 4096
+        #define URING_BUFFER_COUNT 256
+        // bounds of the provided buffer size, taken from the read_buffer_size of the port starting the engine
+        #define URING_BUFFER_MIN 1024
+        #define URING_BUFFER_MAX 65536
+        // max queued writes linked into one submission
+        #define URING_WRITE_CHAIN 16
+
+        // one io_uring instance serving many ports on a single thread
+        //
+        // reads are multishot (single shot before linux 6.7) into a shared provided buffer ring, the reads of a
+        // port reaped together are delivered as one chunk of up to its read_budget, like the epoll worker.
+        // Queued writes are submitted as linked chains and write deadlines use one IORING_OP_TIMEOUT.
+        // When the ring fails the engine thread fails every port like a lost device and exits
+        class UringEngine : public std::enable_shared_from_this<UringEngine>
+        {
+        public:
+            explicit UringEngine(size_t buffer_size);
+            ~UringEngine();
+
+            // the engine shared by every port, throws OSException when io_uring is unavailable,
+            // buffer_size only sizes the provided buffers of a new engine, a failed engine is replaced
+            static std::shared_ptr<UringEngine> shared(size_t buffer_size);
+
+            // returns the slot used by the other calls, the fd must be in blocking mode,
+            // throws OSException once the engine failed
+            int attach(SerialPort *port, int fd);
+
+            // cancels the port's requests and waits until none is in flight,
+            // must not be called from the engine thread (e.g. in a callback) unless the engine failed
+            void detach(int slot);
+
+            // the port's write queue is not empty
+            void kick(int slot);
+
+            // the port paused or resumed reading
+            void rearm(int slot);
+
+            pthread_t native_handle();
+
+            bool hasFailed();
+
+        private:
+            enum Op : uint8_t
+            {
+                OP_READ = 1,
+                OP_WRITE,
+                OP_CANCEL,
+                OP_WAKE,
+                OP_TIMER,
+                OP_TIMER_UPDATE,
+                OP_SCHEDULE
+            };
+
+            enum Request : uint8_t
+            {
+                REQ_ATTACH = 1,
+                REQ_DETACH,
+                REQ_KICK,
+                REQ_REARM
+            };
+
+            struct Slot
+            {
+                SerialPort *port = nullptr;
+                int fd = -1;
+
+                bool detaching = false;
+                bool *detached = nullptr;
+
+                bool reading = false;
+                bool multishot = true;
+
+                // bytes read since the last delivery, delivered once read_budget is reached or no
+                // more completions are waiting
+                std::string received;
+                size_t read_budget = 0;
+
+                // requests whose final completion has not been reaped
+                size_t inflight = 0;
+
+                size_t writes_inflight = 0;
+                std::vector<int> write_results;
+                uint64_t write_deadline = 0;
+                bool write_timed_out = false;
+
+                // the port's WriteSchedule timerfd, polled once at a time
+                int schedule_fd = -1;
+                bool scheduling = false;
+            };
+
+            struct PendingRequest
+            {
+                Request type;
+                int slot;
+                Slot *state;
+                bool *done;
+            };
+
+            void engineWorker();
+            // the engine loop, throws OSException when the ring fails
+            void work();
+            // on the engine thread once the ring failed: completes the waiting detach() calls and
+            // fails the other ports, see SerialPort::onEngineFailure()
+            void fail(const std::string &reason);
+            // with mutex held
+            bool detachRequested(int slot);
+
+            void setupRing();
+            void setupBuffers();
+            void release();
+
+            struct io_uring_sqe *getSqe();
+            int enter(unsigned int to_submit, unsigned int min_complete, unsigned int flags);
+
+            void handleRequests();
+            void handleCompletion(uint64_t user_data, int res, uint32_t flags);
+
+            void armRead(int slot);
+            void armWake();
+            void armSchedule(int slot);
+            void submitWrites(int slot);
+            void completeWrites(int slot);
+            // op is OP_READ or OP_WRITE, or 0 for every request on the port's fd
+            void cancel(int slot, uint8_t op);
+            void checkDeadlines();
+            void armTimer(uint64_t deadline);
+            void recycleBuffer(uint16_t bid);
+            void receive(int slot, const char *data, size_t size);
+            // passes received to the port
+            void deliver(int slot);
+            // delivers every slot in receiving
+            void deliverReceived();
+            void maybeRelease(int slot);
+
+            int ring_fd;
+            int wake_fd;
+
+            void *sq_ptr;
+            size_t sq_size;
+            void *cq_ptr;
+            size_t cq_size;
+            struct io_uring_sqe *sqes;
+            size_t sqes_size;
+
+            uint32_t *sq_khead;
+            uint32_t *sq_ktail;
+            uint32_t *sq_array;
+            uint32_t sq_mask;
+            uint32_t sq_entries;
+            uint32_t sq_tail;
+            unsigned int to_submit;
+
+            uint32_t *cq_khead;
+            uint32_t *cq_ktail;
+            struct io_uring_cqe *cqes;
+            uint32_t cq_mask;
+
+            struct io_uring_buf_ring *buf_ring;
+            size_t buf_ring_size;
+            char *buffers;
+            size_t buffer_size;
+            uint16_t buf_tail;
+
+            uint64_t wake_val;
+
+            struct __kernel_timespec timer_ts;
+            uint64_t timer_deadline;
+
+            // only touched by the engine thread
+            std::vector<std::unique_ptr<Slot>> slots;
+            // slots with received bytes, possibly listed more than once
+            std::vector<int> receiving;
+
+            std::mutex mutex;
+            std::condition_variable detach_cv;
+            std::vector<PendingRequest> requests;
+            std::vector<int> free_slots;
+            int slot_count;
+            bool wake_signaled;
+
+            std::thread engineThread;
+            bool running;
+            // requests are no longer handled, failing is set while fail() calls the ports
+            bool failed;
+            bool failing;
+        };
+    }
+}
+
+#endif
+
+#endif
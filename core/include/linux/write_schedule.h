@@ -0,0 +1,112 @@
+#ifdef LINUX
+
+#ifndef ASYNC_PYSERIAL_LINUX_WRITE_SCHEDULE_H
+#define ASYNC_PYSERIAL_LINUX_WRITE_SCHEDULE_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include <common/exception.h>
+
+namespace async_pyserial
+{
+    namespace internal
+    {
+        // a write queued by the I/O thread at a CLOCK_MONOTONIC time, once or every period
+        class ScheduledWrite
+        {
+        public:
+            // schedule_mutex is the mutex of the WriteSchedule it is added to
+            ScheduledWrite(const std::string &data, uint64_t period_ns, const std::shared_ptr<std::mutex> &schedule_mutex);
+
+            // no write is queued after it returns, it waits for a write being queued,
+            // also safe once the schedule is gone
+            void cancel();
+
+            // false once cancelled or when a one-shot write was queued
+            bool active() const;
+
+            // writes queued so far
+            uint64_t fired() const;
+
+            // periods skipped because the I/O thread woke up after the next one was due,
+            // or the device was disconnected
+            uint64_t missed() const;
+
+        private:
+            friend class WriteSchedule;
+
+            const std::string data;
+            const uint64_t period_ns;
+            // shared with the schedule, which holds it while it queues writes
+            const std::shared_ptr<std::mutex> schedule_mutex;
+
+            std::atomic<bool> cancelled{false};
+            std::atomic<bool> done{false};
+            std::atomic<uint64_t> fired_count{0};
+            std::atomic<uint64_t> missed_count{0};
+        };
+
+        // the scheduled writes of a port, driven by one absolute CLOCK_MONOTONIC timerfd polled by its I/O thread
+        //
+        // periodic writes are rescheduled from their previous deadline, never from the time they fired,
+        // so they do not drift
+        class WriteSchedule
+        {
+        public:
+            // throws OSException when the timerfd cannot be made
+            WriteSchedule();
+            ~WriteSchedule();
+
+            // at_ns is on CLOCK_MONOTONIC (e.g. time.monotonic_ns()), a time in the past is due at once,
+            // period_ns 0 writes once
+            std::shared_ptr<ScheduledWrite> add(const std::string &data, uint64_t at_ns, uint64_t period_ns);
+
+            // pollable fd, readable when a write is due
+            int fd();
+
+            // clears the timerfd and calls write with the payload of every write that is due, in deadline order,
+            // returning false from write counts the period as missed
+            void fire(const std::function<bool(const std::string &)> &write);
+
+            // cancels every scheduled write
+            void clear();
+
+        private:
+            struct Entry
+            {
+                uint64_t deadline;
+                // ties are queued in the order they were added
+                uint64_t sequence;
+                std::shared_ptr<ScheduledWrite> write;
+
+                bool operator>(const Entry &other) const
+                {
+                    return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+                }
+            };
+
+            // sets the timerfd to the earliest deadline, with mutex held
+            void rearm();
+
+            int timer_fd;
+
+            // shared with the scheduled writes, see ScheduledWrite::cancel
+            std::shared_ptr<std::mutex> mutex = std::make_shared<std::mutex>();
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> entries;
+            uint64_t sequence = 0;
+            // deadline the timerfd is set to, 0 when disarmed
+            uint64_t armed = 0;
+        };
+    }
+}
+
+#endif
+
+#endif
@@ -7,6 +7,14 @@
 #ifdef LINUX
 
 #include <linux/serialport.h>
+#include <linux/loopback.h>
+#include <linux/replay.h>
+#include <linux/capture_log.h>
+#include <linux/list_ports.h>
+#include <linux/poll_scheduler.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #endif
 
@@ -25,7 +33,20 @@
 #include <iostream>
 #include <base/serialport.h>
 #include <common/exception.h>
+#include <common/trace.h>
+#include <common/record.h>
+#include <common/receive_buffer.h>
+#include <common/broadcast_ring.h>
+#include <common/pattern_matcher.h>
 #include <any>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
@@ -35,6 +56,13 @@ namespace async_pyserial
 {
     namespace pybind
     {
+        class PortGroup;
+
+#ifdef LINUX
+        class PatternWatch;
+        class PollScheduler;
+#endif
+
         class SerialPort
         {
         public:
@@ -43,11 +71,85 @@ namespace async_pyserial
             void open();
             void close();
 
-            void write(const std::string data, const std::function<void(unsigned long)>& callback);
+            // data is any buffer, copied before returning, callback may be None
+            void write(const pybind11::buffer &data, const pybind11::object &callback);
+            // the buffers are gathered into one write with a single completion
+            void write_many(const pybind11::sequence &buffers, const pybind11::object &callback);
             
             // 只設定一個 data callback 以減少 python-c++ 交互調用
             void set_data_callback(const std::function<void(const pybind11::bytes &)> &callback);
 
+            // blocking I/O with the GIL released, timeout_ms < 0 waits forever,
+            // timeouts raise TimeoutError and failures RuntimeError
+            pybind11::bytes read(size_t size, long timeout_ms);
+            pybind11::bytes read_nowait(size_t size);
+            // read through the first `delimiter`, or `max_bytes` when none is found within them
+            pybind11::bytes read_until(const std::string &delimiter, size_t max_bytes, long timeout_ms);
+            size_t in_waiting();
+            // data is a buffer or a sequence of them, written as one
+            void write_all(const pybind11::object &data, long timeout_ms);
+
+            // bytes kept for read() whether or not one is waiting, see common::ReceiveBuffer
+            void set_read_buffer(size_t capacity);
+
+            // bytes passed to write() and not written yet
+            size_t write_buffer_size();
+
+#ifdef LINUX
+            // record every received and sent chunk to a binary file
+            void start_recording(const std::string &path);
+            void stop_recording();
+
+            // append every chunk to a shared memory-mapped capture log, tagged with `channel`
+            void attach_capture_log(const std::shared_ptr<internal::CaptureLog> &log, uint16_t channel);
+            void detach_capture_log();
+
+            unsigned char io_engine();
+
+            // internal::RS485Mode
+            unsigned char rs485_mode();
+
+            internal::ThreadStatus thread_status();
+
+            // apply new line settings to the open port, mode is internal::ReconfigureMode
+            void reconfigure(const base::SerialPortOptions &options, unsigned char mode);
+
+            // called with internal::SerialPortEvent::ON_DISCONNECT or ON_RECONNECT
+            void set_event_callback(const std::function<void(unsigned int)> &callback);
+
+            bool is_connected();
+
+            internal::WriteStats write_stats();
+
+            // see internal::SerialPort::schedule_write
+            std::shared_ptr<internal::ScheduledWrite> schedule_write(const std::string &data, uint64_t at_ns, uint64_t period_ns);
+
+            // see internal::SerialPort::pause_reading
+            void pause_reading();
+            void resume_reading();
+
+            // an eventfd that becomes readable when data arrives or a write completes, for event loops
+            int notify_fd();
+            // clears notify_fd() and returns up to size buffered bytes without waiting
+            pybind11::bytes read_batch(size_t size);
+            // the first failure of a write completed since the last call, common::SUCCESS when none
+            unsigned long take_write_error();
+
+            internal::ReceiveStats receive_stats();
+
+            // called with the ReceiveStats increments of internal::SerialPortEvent::ON_OVERFLOW
+            void set_overflow_callback(const std::function<void(const internal::ReceiveStats &)> &callback);
+
+            // a reader of every byte received from now on, all subscribers share one common::BroadcastRing
+            std::shared_ptr<common::BroadcastSubscriber> subscribe(unsigned char lag_policy);
+
+            // matches `patterns` in the received stream on the I/O thread, callback gets the matches of a chunk at once
+            std::shared_ptr<PatternWatch> watch(const std::vector<std::string> &patterns, size_t context,
+                                                const std::function<void(const std::vector<common::PatternMatch> &)> &callback);
+#endif
+
+            internal::SerialPort *native();
+
         private:
             std::wstring portName;
 
@@ -57,7 +159,215 @@ namespace async_pyserial
 
             std::function<void(const pybind11::bytes &)> data_callback;
 
+            common::ReceiveBuffer receive_buffer;
+
+            std::function<void(unsigned int)> event_callback;
+
+            void callEvent(unsigned int event);
+
             void call(const std::vector<std::any> &args);
+
+            // after reads, resumes reading paused by options.overflow_policy
+            void consumed();
+
+            friend class PortGroup;
+
+            // set while the port is in a PortGroup, which then delivers its data and write completions
+            std::mutex group_mutex;
+            std::weak_ptr<PortGroup> group;
+
+            std::shared_ptr<PortGroup> currentGroup();
+
+            size_t read_capacity = 0;
+
+            std::atomic<size_t> write_pending{0};
+
+            // called on the I/O thread, takes the reference write() holds on callback
+            void written(size_t size, unsigned long err, PyObject *callback);
+
+            // queues the buffers as one write, with the GIL released
+            template <typename Callback>
+            void submit(const std::vector<pybind11::buffer_info> &views, size_t size, Callback &&callback);
+            // submit() with a python callback, which may be None
+            void submit(const std::vector<pybind11::buffer_info> &views, const pybind11::object &callback);
+
+#ifdef LINUX
+            // signals loop_fd once until read_batch()
+            void notify();
+
+            std::atomic<int> loop_fd{-1};
+            std::atomic<bool> loop_notified{false};
+            std::atomic<unsigned long> write_error{common::SUCCESS};
+
+            std::function<void(const internal::ReceiveStats &)> overflow_callback;
+
+            void callOverflow(const internal::ReceiveStats &increment);
+
+            // OVERFLOW_PAUSE stopped reading at a full receive buffer, until it is half empty
+            std::mutex overflow_mutex;
+            std::atomic<bool> overflow_paused{false};
+
+            std::shared_ptr<common::RecordWriter> recorder;
+            std::shared_ptr<internal::CaptureChannel> capture;
+
+            std::shared_ptr<common::BroadcastRing> broadcast;
+#endif
+        };
+
+#ifdef LINUX
+        // a common::PatternMatcher fed by a port until closed
+        class PatternWatch
+        {
+        public:
+            PatternWatch(internal::SerialPort *serial, const std::shared_ptr<common::PatternMatcher> &matcher);
+
+            // stops matching
+            void close();
+
+            uint64_t position();
+            uint64_t matches();
+
+        private:
+            internal::SerialPort *serial;
+            std::shared_ptr<common::PatternMatcher> matcher;
+
+            std::atomic<bool> closed{false};
+        };
+#endif
+
+        // collects the data and write completions of any number of ports and passes them to one callback
+        // as a list, from its own thread, once max_events are queued or the oldest waited max_delay_us,
+        // so the GIL is taken once per batch instead of once per event and port
+        class PortGroup : public std::enable_shared_from_this<PortGroup>
+        {
+        public:
+            enum EventKind : unsigned char
+            {
+                DATA = 0,
+                WRITE = 1
+            };
+
+            PortGroup(const pybind11::function &callback, size_t max_events, long max_delay_us);
+            ~PortGroup();
+
+            // the holder made for python, see destroy()
+            static std::shared_ptr<PortGroup> create(const pybind11::function &callback, size_t max_events, long max_delay_us);
+
+            // events of port are delivered as (key, kind, data or error), a port is in one group at a time
+            void add(SerialPort &port, const pybind11::object &key);
+            void remove(SerialPort &port);
+
+            // detaches every port and delivers the queued events, throws SerialPortException from the callback
+            void close();
+
+            // called on I/O threads
+            void pushData(SerialPort *port, const std::string &data);
+            // takes the reference on callback, which may be null
+            void pushWrite(SerialPort *port, unsigned long err, PyObject *callback);
+
+            size_t pending();
+
+        private:
+            struct Event
+            {
+                uint32_t member;
+                EventKind kind;
+                std::string data;
+                unsigned long err;
+                // the write() callback, called in the same GIL acquisition, an owned reference
+                PyObject *callback;
+            };
+
+            // false when the event was dropped
+            bool push(SerialPort *port, Event &&event);
+            void run();
+            void deliver(std::vector<Event> &batch);
+            // drops the keys of removed ports once no queued event refers to them, and lets add() reuse them
+            void reclaim(std::vector<uint32_t> &entries);
+            void stop();
+
+            // the deleter of create(): the last reference may go on an I/O thread or the group's thread, whose
+            // wait for the group's thread could deadlock with a callback closing the port, the group is then
+            // destroyed on a thread of its own
+            static void destroy(PortGroup *group);
+
+            pybind11::function callback;
+            size_t max_events;
+            std::chrono::microseconds max_delay;
+
+            // keys are only touched with the GIL held, ports by index under mutex
+            std::vector<pybind11::object> keys;
+            std::unordered_map<SerialPort *, uint32_t> members;
+            // indexes of removed ports, possibly still in queued events, and those reclaimed since
+            std::vector<uint32_t> released;
+            std::vector<uint32_t> free_keys;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::vector<Event> queue;
+            std::chrono::steady_clock::time_point first_queued;
+            bool stopping;
+
+            std::thread thread;
+        };
+
+#ifdef LINUX
+        // an internal::PollScheduler whose results are passed to one callback as a list, from its own thread,
+        // once max_results are queued or the oldest waited max_delay_us, like PortGroup
+        class PollScheduler
+        {
+        public:
+            PollScheduler(const pybind11::function &callback, bool changes_only, size_t max_results, long max_delay_us);
+            ~PollScheduler();
+
+            // results of the entry are delivered as (key, status, response, latency in seconds)
+            void add(SerialPort &port, const std::string &request, size_t length, const std::string &terminator,
+                     size_t max_bytes, long period_us, long timeout_us, const pybind11::object &key);
+
+            // stops polling and delivers the queued results, throws SerialPortException from the callback
+            void close();
+
+            internal::PollStats stats();
+
+        private:
+            // called by the scheduler
+            void push(internal::PollResult &&result);
+            void run();
+            void deliver(std::vector<internal::PollResult> &batch);
+            void stop();
+
+            pybind11::function callback;
+            size_t max_results;
+            std::chrono::microseconds max_delay;
+
+            // by entry, only touched with the GIL held
+            std::vector<pybind11::object> keys;
+
+            std::shared_ptr<internal::PollScheduler> scheduler;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::vector<internal::PollResult> queue;
+            std::chrono::steady_clock::time_point first_queued;
+            bool stopping;
+
+            std::thread thread;
+        };
+#endif
+
+        // read_until() per iteration, stops when the port is closed
+        class LineIterator
+        {
+        public:
+            LineIterator(SerialPort &port, const std::string &delimiter, size_t max_bytes, long timeout_ms);
+
+            pybind11::bytes next();
+
+        private:
+            SerialPort &port;
+            std::string delimiter;
+            size_t max_bytes;
+            long timeout_ms;
         };
     }
 
@@ -67,6 +377,7 @@ using namespace async_pyserial;
 using namespace async_pyserial::pybind;
 
 namespace py = pybind11;
+namespace trace = async_pyserial::common::trace;
 
 SerialPort::SerialPort(const std::wstring &portName, const base::SerialPortOptions &options) : portName(portName), options(options)
 {
@@ -75,10 +386,24 @@ SerialPort::SerialPort(const std::wstring &portName, const base::SerialPortOptio
     // 預設註冊一個 ON_DATA listener
     serial->on(internal::SerialPortEvent::ON_DATA, [this](const std::vector<std::any> &args)
                { this->call(args); });
+
+#ifdef LINUX
+    serial->on(internal::SerialPortEvent::ON_DISCONNECT, [this](const std::vector<std::any> &)
+               { this->callEvent(internal::SerialPortEvent::ON_DISCONNECT); });
+    serial->on(internal::SerialPortEvent::ON_RECONNECT, [this](const std::vector<std::any> &)
+               { this->callEvent(internal::SerialPortEvent::ON_RECONNECT); });
+    serial->on(internal::SerialPortEvent::ON_OVERFLOW, [this](const std::vector<std::any> &args)
+               { this->callOverflow(std::any_cast<const internal::ReceiveStats &>(args[0])); });
+#endif
 }
 
 SerialPort::~SerialPort()
 {
+    if (auto current = currentGroup())
+    {
+        current->remove(*this);
+    }
+
     if (serial != nullptr)
     {
         close();
@@ -87,6 +412,13 @@ SerialPort::~SerialPort()
 
         serial = nullptr;
     }
+
+#ifdef LINUX
+    if (loop_fd != -1)
+    {
+        ::close(loop_fd);
+    }
+#endif
 }
 
 void SerialPort::open()
@@ -94,70 +426,1404 @@ void SerialPort::open()
     py::gil_scoped_release release;
     
     serial->open();
+
+    receive_buffer.open();
+
+#ifdef LINUX
+    if (broadcast)
+    {
+        broadcast->open();
+    }
+#endif
 }
 
 void SerialPort::close()
 {
     py::gil_scoped_release release;
 
+    // wake blocked reads first
+    receive_buffer.close();
+
+#ifdef LINUX
+    if (broadcast)
+    {
+        broadcast->close();
+    }
+#endif
+
     serial->close();
 }
 
-void SerialPort::write(const std::string data, const std::function<void(unsigned long)>& callback) {
-    py::gil_scoped_release release;
+// views of data, a buffer or a sequence of them, returns their total size
+static size_t requestBuffers(const py::object &data, std::vector<py::buffer_info> &views)
+{
+    size_t size = 0;
 
-    serial->write(data, [callback](unsigned long err) {
-        if(callback) {
-            py::gil_scoped_acquire gil;
+    auto add = [&views, &size](const py::handle &item) {
+        py::buffer_info view = py::reinterpret_borrow<py::buffer>(item).request();
+
+        // the bytes are taken as one block from ptr
+        py::ssize_t stride = view.itemsize;
+
+        for (py::ssize_t i = view.ndim - 1; i >= 0; i--)
+        {
+            if (view.shape[i] > 1 && view.strides[i] != stride)
+            {
+                throw py::value_error("write buffers must be contiguous");
+            }
 
-            callback(err);
+            stride *= view.shape[i];
+        }
+
+        size += static_cast<size_t>(view.size * view.itemsize);
+        views.push_back(std::move(view));
+    };
+
+    if (py::isinstance<py::buffer>(data))
+    {
+        add(data);
+    }
+    else
+    {
+        for (auto item : py::reinterpret_borrow<py::iterable>(data))
+        {
+            add(item);
         }
+    }
+
+    return size;
+}
+
+template <typename Callback>
+void SerialPort::submit(const std::vector<py::buffer_info> &views, size_t size, Callback &&callback)
+{
+    write_pending += size;
+
+#ifdef LINUX
+    if (views.size() == 1)
+    {
+        serial->write(static_cast<const char *>(views[0].ptr), size, std::forward<Callback>(callback));
+        return;
+    }
+
+    std::vector<struct iovec> segments;
+    segments.reserve(views.size());
+
+    for (auto &view : views)
+    {
+        segments.push_back({view.ptr, static_cast<size_t>(view.size * view.itemsize)});
+    }
+
+    serial->write(segments.data(), segments.size(), std::forward<Callback>(callback));
+#else
+    std::string data;
+    data.reserve(size);
+
+    for (auto &view : views)
+    {
+        data.append(static_cast<const char *>(view.ptr), static_cast<size_t>(view.size * view.itemsize));
+    }
+
+    serial->write(data, std::forward<Callback>(callback));
+#endif
+}
+
+void SerialPort::submit(const std::vector<py::buffer_info> &views, const py::object &callback)
+{
+    size_t size = 0;
+
+    for (auto &view : views)
+    {
+        size += static_cast<size_t>(view.size * view.itemsize);
+    }
+
+    // a raw reference keeps the completion small enough for internal::WriteCallback
+    PyObject *cb = callback.is_none() ? nullptr : callback.inc_ref().ptr();
+
+    // the views are released once the GIL is back
+    py::gil_scoped_release release;
+
+    submit(views, size, [this, size, cb](unsigned long err) {
+        written(size, err, cb);
     });
 }
 
+void SerialPort::write(const py::buffer &data, const py::object &callback) {
+    std::vector<py::buffer_info> views;
+
+    requestBuffers(data, views);
+
+    submit(views, callback);
+}
+
+void SerialPort::write_many(const py::sequence &buffers, const py::object &callback) {
+    std::vector<py::buffer_info> views;
+
+    requestBuffers(buffers, views);
+
+    submit(views, callback);
+}
+
+void SerialPort::written(size_t size, unsigned long err, PyObject *callback) {
+    write_pending -= size;
+
+#ifdef LINUX
+    if(err != common::SUCCESS) {
+        unsigned long expected = common::SUCCESS;
+        write_error.compare_exchange_strong(expected, err);
+    }
+
+    notify();
+#endif
+
+    if(auto current = currentGroup()) {
+        current->pushWrite(this, err, callback);
+    } else if(callback) {
+        ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::BEGIN, -1, 0);
+
+        py::gil_scoped_acquire gil;
+
+        ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::END, -1, 0);
+        ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::BEGIN, -1, 0);
+
+        py::object owned = py::reinterpret_steal<py::object>(callback);
+
+        try {
+            owned(err);
+        } catch(const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+
+        ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::END, -1, 0);
+    }
+}
+
 void SerialPort::set_data_callback(const std::function<void(const pybind11::bytes &)> &callback)
 {
     data_callback = callback;
 }
 
-void SerialPort::call(const std::vector<std::any> &args)
+pybind11::bytes SerialPort::read(size_t size, long timeout_ms)
 {
-    if (args.empty()) {
-        return;
+    std::string data;
+
+    {
+        py::gil_scoped_release release;
+
+        data = receive_buffer.read(size, timeout_ms);
     }
-    
-    if (data_callback)
+
+    consumed();
+
+    return py::bytes(data.data(), data.size());
+}
+
+pybind11::bytes SerialPort::read_until(const std::string &delimiter, size_t max_bytes, long timeout_ms)
+{
+    std::string data;
+
     {
-        try {
-            auto &data = std::any_cast<const std::string &>(args[0]);
+        py::gil_scoped_release release;
 
-            py::gil_scoped_acquire gil; // acquire gil
+        data = receive_buffer.read_until(delimiter, max_bytes, timeout_ms);
+    }
 
-            data_callback(py::bytes(data.data(), data.size()));
-        } catch(const std::bad_any_cast& e) {
-            std::cerr << "Bad any_cast: " << e.what() << std::endl;
-        } catch(const std::exception& e) {
-            std::cerr << "Exception: " << e.what() << std::endl;
-        }
-        
+    consumed();
+
+    return py::bytes(data.data(), data.size());
+}
+
+LineIterator::LineIterator(SerialPort &port, const std::string &delimiter, size_t max_bytes, long timeout_ms)
+    : port(port), delimiter(delimiter), max_bytes(max_bytes), timeout_ms(timeout_ms) {}
+
+pybind11::bytes LineIterator::next()
+{
+    try
+    {
+        return port.read_until(delimiter, max_bytes, timeout_ms);
+    }
+    catch (const common::SerialPortException &)
+    {
+        throw py::stop_iteration();
     }
 }
 
-PYBIND11_MODULE(async_pyserial_core, m)
+pybind11::bytes SerialPort::read_nowait(size_t size)
 {
-    py::class_<base::SerialPortOptions>(m, "SerialPortOptions")
-        .def(py::init<>())
-        .def_readwrite("baudrate", &base::SerialPortOptions::baudrate)
-        .def_readwrite("bytesize", &base::SerialPortOptions::bytesize)
-        .def_readwrite("stopbits", &base::SerialPortOptions::stopbits)
-        .def_readwrite("parity", &base::SerialPortOptions::parity)
-        .def_readwrite("read_timeout", &base::SerialPortOptions::read_timeout)
-        .def_readwrite("write_timeout", &base::SerialPortOptions::write_timeout);
+    std::string data = receive_buffer.read_nowait(size);
 
-    py::class_<pybind::SerialPort>(m, "SerialPort")
-        .def(py::init<const std::wstring &, const base::SerialPortOptions &>())
-        .def("open", &pybind::SerialPort::open)
-        .def("close", &pybind::SerialPort::close)
-        .def("write", &pybind::SerialPort::write)
-        .def("set_data_callback", &pybind::SerialPort::set_data_callback);
-}
\ No newline at end of file
+    consumed();
+
+    return py::bytes(data.data(), data.size());
+}
+
+size_t SerialPort::in_waiting()
+{
+    return receive_buffer.size();
+}
+
+void SerialPort::write_all(const py::object &data, long timeout_ms)
+{
+    std::vector<py::buffer_info> views;
+
+    size_t size = requestBuffers(data, views);
+
+    py::gil_scoped_release release;
+
+    struct Completion
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+        unsigned long err = common::SUCCESS;
+    };
+
+    auto completion = std::make_shared<Completion>();
+
+    // the callback needs no GIL, so the I/O thread never waits for this one
+    submit(views, size, [this, size, completion](unsigned long err) {
+        write_pending -= size;
+
+        std::lock_guard<std::mutex> lock(completion->mutex);
+
+        completion->done = true;
+        completion->err = err;
+
+        completion->cv.notify_all();
+    });
+
+    std::unique_lock<std::mutex> lock(completion->mutex);
+
+    auto done = [&completion] { return completion->done; };
+
+    if (timeout_ms < 0)
+    {
+        completion->cv.wait(lock, done);
+    }
+    else if (!completion->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), done))
+    {
+        // still queued, it is written or failed later
+        throw common::TimeoutException("write timeout");
+    }
+
+    if (completion->err != common::SUCCESS)
+    {
+        throw common::SerialPortException("Write Error: " + std::to_string(completion->err));
+    }
+}
+
+void SerialPort::set_read_buffer(size_t capacity)
+{
+    read_capacity = capacity;
+
+#ifdef LINUX
+    // reading stops at the capacity, what was read meanwhile is kept
+    receive_buffer.set_capacity(capacity, options.overflow_policy == internal::OVERFLOW_PAUSE);
+#else
+    receive_buffer.set_capacity(capacity);
+#endif
+}
+
+size_t SerialPort::write_buffer_size()
+{
+    return write_pending;
+}
+
+#ifdef LINUX
+void SerialPort::start_recording(const std::string &path)
+{
+    stop_recording();
+
+    recorder = std::make_shared<common::RecordWriter>(path);
+
+    serial->addSink(recorder);
+}
+
+void SerialPort::stop_recording()
+{
+    if (!recorder)
+    {
+        return;
+    }
+
+    py::gil_scoped_release release;
+
+    serial->removeSink(recorder);
+
+    recorder->close();
+    recorder.reset();
+}
+
+void SerialPort::attach_capture_log(const std::shared_ptr<internal::CaptureLog> &log, uint16_t channel)
+{
+    detach_capture_log();
+
+    capture = std::make_shared<internal::CaptureChannel>(log, channel);
+
+    serial->addSink(capture);
+}
+
+void SerialPort::detach_capture_log()
+{
+    if (!capture)
+    {
+        return;
+    }
+
+    py::gil_scoped_release release;
+
+    serial->removeSink(capture);
+
+    capture.reset();
+}
+
+unsigned char SerialPort::io_engine()
+{
+    return serial->io_engine();
+}
+
+unsigned char SerialPort::rs485_mode()
+{
+    return serial->rs485_mode();
+}
+
+internal::ThreadStatus SerialPort::thread_status()
+{
+    return serial->thread_status();
+}
+
+void SerialPort::reconfigure(const base::SerialPortOptions &options, unsigned char mode)
+{
+    // draining waits for queued writes, whose callbacks need the GIL
+    py::gil_scoped_release release;
+
+    serial->reconfigure(options, static_cast<internal::ReconfigureMode>(mode));
+}
+
+void SerialPort::set_event_callback(const std::function<void(unsigned int)> &callback)
+{
+    event_callback = callback;
+}
+
+bool SerialPort::is_connected()
+{
+    return serial->is_connected();
+}
+
+void SerialPort::pause_reading()
+{
+    serial->pause_reading();
+}
+
+void SerialPort::resume_reading()
+{
+    serial->resume_reading();
+}
+
+int SerialPort::notify_fd()
+{
+    if (loop_fd == -1)
+    {
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (fd == -1)
+        {
+            throw common::OSException("create notify eventfd failure");
+        }
+
+        loop_fd = fd;
+
+        // data that arrived before
+        if (receive_buffer.size() > 0)
+        {
+            notify();
+        }
+    }
+
+    return loop_fd;
+}
+
+pybind11::bytes SerialPort::read_batch(size_t size)
+{
+    uint64_t value;
+
+    if (loop_fd != -1)
+    {
+        ::read(loop_fd, &value, sizeof(value));
+    }
+
+    // anything appended after this signals again
+    loop_notified = false;
+
+    return read_nowait(size);
+}
+
+unsigned long SerialPort::take_write_error()
+{
+    return write_error.exchange(common::SUCCESS);
+}
+
+internal::ReceiveStats SerialPort::receive_stats()
+{
+    return serial->receive_stats();
+}
+
+internal::WriteStats SerialPort::write_stats()
+{
+    return serial->write_stats();
+}
+
+std::shared_ptr<internal::ScheduledWrite> SerialPort::schedule_write(const std::string &data, uint64_t at_ns, uint64_t period_ns)
+{
+    return serial->schedule_write(data, at_ns, period_ns);
+}
+
+void SerialPort::set_overflow_callback(const std::function<void(const internal::ReceiveStats &)> &callback)
+{
+    overflow_callback = callback;
+}
+
+std::shared_ptr<common::BroadcastSubscriber> SerialPort::subscribe(unsigned char lag_policy)
+{
+    if (!broadcast)
+    {
+        broadcast = std::make_shared<common::BroadcastRing>(options.broadcast_bufsize);
+
+        serial->addSink(broadcast);
+    }
+
+    return std::make_shared<common::BroadcastSubscriber>(broadcast, static_cast<common::LagPolicy>(lag_policy));
+}
+
+std::shared_ptr<PatternWatch> SerialPort::watch(const std::vector<std::string> &patterns, size_t context,
+                                                const std::function<void(const std::vector<common::PatternMatch> &)> &callback)
+{
+    auto matcher = std::make_shared<common::PatternMatcher>(patterns, context, [callback](const std::vector<common::PatternMatch> &found)
+                                                            {
+        try {
+            ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::BEGIN, -1, found.size());
+
+            py::gil_scoped_acquire gil;
+
+            ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::END, -1, found.size());
+
+            callback(found);
+        } catch(const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        } });
+
+    serial->addSink(matcher);
+
+    return std::make_shared<PatternWatch>(serial, matcher);
+}
+
+PatternWatch::PatternWatch(internal::SerialPort *serial, const std::shared_ptr<common::PatternMatcher> &matcher)
+    : serial(serial), matcher(matcher) {}
+
+void PatternWatch::close()
+{
+    if (closed.exchange(true))
+    {
+        return;
+    }
+
+    serial->removeSink(matcher);
+}
+
+uint64_t PatternWatch::position()
+{
+    return matcher->position();
+}
+
+uint64_t PatternWatch::matches()
+{
+    return matcher->matches();
+}
+
+void SerialPort::callOverflow(const internal::ReceiveStats &increment)
+{
+    if (overflow_callback)
+    {
+        try {
+            py::gil_scoped_acquire gil;
+
+            overflow_callback(increment);
+        } catch(const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+    }
+}
+
+void SerialPort::notify()
+{
+    int fd = loop_fd;
+
+    if (fd != -1 && !loop_notified.exchange(true))
+    {
+        uint64_t value = 1;
+        ::write(fd, &value, sizeof(value));
+    }
+}
+#endif
+
+void SerialPort::consumed()
+{
+#ifdef LINUX
+    if (!overflow_paused)
+    {
+        return;
+    }
+
+    // resuming may wait for the I/O thread, which holds the write lock across device writes,
+    // other python threads keep running meanwhile
+    py::gil_scoped_release release;
+
+    std::lock_guard<std::mutex> lock(overflow_mutex);
+
+    if (overflow_paused && receive_buffer.size() <= read_capacity / 2)
+    {
+        overflow_paused = false;
+        serial->resume_reading(internal::PAUSE_OVERFLOW);
+    }
+#endif
+}
+
+internal::SerialPort *SerialPort::native()
+{
+    return serial;
+}
+
+void SerialPort::call(const std::vector<std::any> &args)
+{
+    if (args.empty()) {
+        return;
+    }
+
+    try {
+        auto &data = std::any_cast<const std::string &>(args[0]);
+
+        // before the python callback, which may read it
+        size_t kept = receive_buffer.append(data.data(), data.size());
+
+#ifdef LINUX
+        // capacity 0 keeps only what waiting reads asked for, that is not an overflow
+        if (kept < data.size() && read_capacity > 0)
+        {
+            serial->reportDropped(data.size() - kept);
+        }
+
+        if (options.overflow_policy == internal::OVERFLOW_PAUSE && read_capacity > 0 &&
+            receive_buffer.size() >= read_capacity)
+        {
+            std::lock_guard<std::mutex> lock(overflow_mutex);
+
+            if (!overflow_paused)
+            {
+                overflow_paused = true;
+                serial->pause_reading(internal::PAUSE_OVERFLOW);
+            }
+        }
+#endif
+    } catch(const std::bad_any_cast& e) {
+        std::cerr << "Bad any_cast: " << e.what() << std::endl;
+        return;
+    }
+
+#ifdef LINUX
+    notify();
+#endif
+
+    if (auto current = currentGroup())
+    {
+        try {
+            current->pushData(this, std::any_cast<const std::string &>(args[0]));
+        } catch(const std::bad_any_cast& e) {
+            std::cerr << "Bad any_cast: " << e.what() << std::endl;
+        }
+    }
+    else if (data_callback)
+    {
+        try {
+            auto &data = std::any_cast<const std::string &>(args[0]);
+
+            ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::BEGIN, -1, data.size());
+
+            py::gil_scoped_acquire gil; // acquire gil
+
+            ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::END, -1, data.size());
+            ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::BEGIN, -1, data.size());
+
+            data_callback(py::bytes(data.data(), data.size()));
+
+            ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::END, -1, data.size());
+        } catch(const std::bad_any_cast& e) {
+            std::cerr << "Bad any_cast: " << e.what() << std::endl;
+        } catch(const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+        
+    }
+}
+
+std::shared_ptr<PortGroup> SerialPort::currentGroup()
+{
+    std::lock_guard<std::mutex> lock(group_mutex);
+
+    return group.lock();
+}
+
+PortGroup::PortGroup(const py::function &callback, size_t max_events, long max_delay_us)
+    : callback(callback), max_events(std::max<size_t>(max_events, 1)), max_delay(std::max(max_delay_us, 0L)), stopping(false)
+{
+    thread = std::thread(&PortGroup::run, this);
+}
+
+std::shared_ptr<PortGroup> PortGroup::create(const py::function &callback, size_t max_events, long max_delay_us)
+{
+    return std::shared_ptr<PortGroup>(new PortGroup(callback, max_events, max_delay_us), &PortGroup::destroy);
+}
+
+void PortGroup::destroy(PortGroup *group)
+{
+    if (PyGILState_Check() && std::this_thread::get_id() != group->thread.get_id())
+    {
+        delete group;
+        return;
+    }
+
+    std::thread([group]()
+                { delete group; })
+        .detach();
+}
+
+PortGroup::~PortGroup()
+{
+    // the last reference may go on an I/O thread, without the GIL the delivering thread may wait for
+    if (PyGILState_Check())
+    {
+        {
+            py::gil_scoped_release release;
+
+            stop();
+        }
+
+        keys.clear();
+    }
+    else
+    {
+        stop();
+
+        py::gil_scoped_acquire gil;
+
+        keys.clear();
+        callback = py::function();
+    }
+}
+
+void PortGroup::add(SerialPort &port, const py::object &key)
+{
+    if (auto current = port.currentGroup())
+    {
+        if (current.get() == this)
+        {
+            return;
+        }
+
+        throw common::SerialPortException("serial port is already in a group");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (stopping)
+        {
+            throw common::SerialPortException("port group is closed");
+        }
+
+        if (!free_keys.empty())
+        {
+            members[&port] = free_keys.back();
+            keys[free_keys.back()] = key;
+
+            free_keys.pop_back();
+        }
+        else
+        {
+            members[&port] = static_cast<uint32_t>(keys.size());
+            keys.push_back(key);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(port.group_mutex);
+
+    port.group = shared_from_this();
+}
+
+void PortGroup::remove(SerialPort &port)
+{
+    {
+        std::lock_guard<std::mutex> lock(port.group_mutex);
+
+        if (port.group.lock().get() == this)
+        {
+            port.group.reset();
+        }
+    }
+
+    // queued events keep their key, it is reclaimed once they are delivered
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto member = members.find(&port);
+
+    if (member == members.end())
+    {
+        return;
+    }
+
+    released.push_back(member->second);
+    members.erase(member);
+
+    cv.notify_one();
+}
+
+void PortGroup::close()
+{
+    if (std::this_thread::get_id() == thread.get_id())
+    {
+        throw common::SerialPortException("a port group cannot be closed from its callback");
+    }
+
+    std::vector<SerialPort *> ports;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto &member : members)
+        {
+            ports.push_back(member.first);
+        }
+    }
+
+    for (auto *port : ports)
+    {
+        remove(*port);
+    }
+
+    stop();
+}
+
+void PortGroup::pushData(SerialPort *port, const std::string &data)
+{
+    push(port, {0, DATA, data, common::SUCCESS, nullptr});
+}
+
+void PortGroup::pushWrite(SerialPort *port, unsigned long err, PyObject *callback)
+{
+    if (!push(port, {0, WRITE, std::string(), err, callback}) && callback)
+    {
+        py::gil_scoped_acquire gil;
+
+        Py_DECREF(callback);
+    }
+}
+
+size_t PortGroup::pending()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return queue.size();
+}
+
+bool PortGroup::push(SerialPort *port, Event &&event)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto member = members.find(port);
+
+    // removed while the event was on its way
+    if (member == members.end() || stopping)
+    {
+        return false;
+    }
+
+    event.member = member->second;
+
+    if (queue.empty())
+    {
+        first_queued = std::chrono::steady_clock::now();
+    }
+
+    queue.push_back(std::move(event));
+
+    // the first event starts the delay, max_events ends it early
+    if (queue.size() == 1 || queue.size() == max_events)
+    {
+        cv.notify_one();
+    }
+
+    return true;
+}
+
+void PortGroup::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        cv.wait(lock, [this]
+                { return stopping || !queue.empty() || !released.empty(); });
+
+        std::vector<Event> batch;
+        std::vector<uint32_t> reclaimed;
+
+        if (queue.empty())
+        {
+            if (stopping)
+            {
+                return;
+            }
+
+            // no event refers to the removed ports
+            reclaimed.swap(released);
+
+            lock.unlock();
+
+            reclaim(reclaimed);
+
+            lock.lock();
+
+            free_keys.insert(free_keys.end(), reclaimed.begin(), reclaimed.end());
+
+            continue;
+        }
+
+        cv.wait_until(lock, first_queued + max_delay, [this]
+                      { return stopping || queue.size() >= max_events; });
+
+        // the events of ports removed until now are all in this batch or delivered before
+        batch.swap(queue);
+        reclaimed.swap(released);
+
+        lock.unlock();
+
+        deliver(batch);
+
+        if (!reclaimed.empty())
+        {
+            reclaim(reclaimed);
+        }
+
+        lock.lock();
+
+        free_keys.insert(free_keys.end(), reclaimed.begin(), reclaimed.end());
+    }
+}
+
+void PortGroup::reclaim(std::vector<uint32_t> &entries)
+{
+    py::gil_scoped_acquire gil;
+
+    for (uint32_t entry : entries)
+    {
+        keys[entry] = py::object();
+    }
+}
+
+void PortGroup::deliver(std::vector<Event> &batch)
+{
+    ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::BEGIN, -1, batch.size());
+
+    py::gil_scoped_acquire gil;
+
+    ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::END, -1, batch.size());
+    ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::BEGIN, -1, batch.size());
+
+    try {
+        py::list events(batch.size());
+
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            auto &event = batch[i];
+
+            if (event.kind == DATA)
+            {
+                events[i] = py::make_tuple(keys[event.member], static_cast<int>(DATA), py::bytes(event.data));
+                continue;
+            }
+
+            events[i] = py::make_tuple(keys[event.member], static_cast<int>(WRITE), event.err);
+
+            if (event.callback)
+            {
+                py::object write_callback = py::reinterpret_steal<py::object>(event.callback);
+
+                event.callback = nullptr;
+
+                try {
+                    write_callback(event.err);
+                } catch(const std::exception& e) {
+                    std::cerr << "Exception: " << e.what() << std::endl;
+                }
+            }
+        }
+
+        callback(events);
+    } catch(const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+
+    // write callbacks not reached after a failure
+    for (auto &event : batch)
+    {
+        Py_XDECREF(event.callback);
+    }
+
+    batch.clear();
+
+    ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::END, -1, 0);
+}
+
+void PortGroup::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        stopping = true;
+
+        cv.notify_one();
+    }
+
+    if (thread.joinable() && std::this_thread::get_id() != thread.get_id())
+    {
+        thread.join();
+    }
+}
+
+#ifdef LINUX
+PollScheduler::PollScheduler(const py::function &callback, bool changes_only, size_t max_results, long max_delay_us)
+    : callback(callback), max_results(std::max<size_t>(max_results, 1)), max_delay(std::max(max_delay_us, 0L)), stopping(false)
+{
+    scheduler = std::make_shared<internal::PollScheduler>([this](internal::PollResult &&result)
+                                                          { push(std::move(result)); }, changes_only);
+
+    thread = std::thread(&PollScheduler::run, this);
+}
+
+PollScheduler::~PollScheduler()
+{
+    {
+        py::gil_scoped_release release;
+
+        scheduler->close();
+        stop();
+    }
+
+    keys.clear();
+}
+
+void PollScheduler::add(SerialPort &port, const std::string &request, size_t length, const std::string &terminator,
+                        size_t max_bytes, long period_us, long timeout_us, const py::object &key)
+{
+    internal::PollMatcher matcher;
+    matcher.length = length;
+    matcher.terminator = terminator;
+    matcher.max_bytes = max_bytes;
+
+    // results wait for the GIL, which is held until the key is stored
+    uint32_t entry = scheduler->add(port.native(), request, matcher,
+                                    static_cast<uint64_t>(std::max(period_us, 0L)) * 1000ULL,
+                                    static_cast<uint64_t>(std::max(timeout_us, 0L)) * 1000ULL);
+
+    if (keys.size() <= entry)
+    {
+        keys.resize(entry + 1);
+    }
+
+    keys[entry] = key;
+}
+
+void PollScheduler::close()
+{
+    if (std::this_thread::get_id() == thread.get_id())
+    {
+        throw common::SerialPortException("a poll scheduler cannot be closed from its callback");
+    }
+
+    scheduler->close();
+
+    stop();
+}
+
+internal::PollStats PollScheduler::stats()
+{
+    return scheduler->stats();
+}
+
+void PollScheduler::push(internal::PollResult &&result)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (stopping)
+    {
+        return;
+    }
+
+    if (queue.empty())
+    {
+        first_queued = std::chrono::steady_clock::now();
+    }
+
+    queue.push_back(std::move(result));
+
+    if (queue.size() == 1 || queue.size() == max_results)
+    {
+        cv.notify_one();
+    }
+}
+
+void PollScheduler::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true)
+    {
+        cv.wait(lock, [this]
+                { return stopping || !queue.empty(); });
+
+        if (queue.empty())
+        {
+            return;
+        }
+
+        cv.wait_until(lock, first_queued + max_delay, [this]
+                      { return stopping || queue.size() >= max_results; });
+
+        std::vector<internal::PollResult> batch;
+        batch.swap(queue);
+
+        lock.unlock();
+
+        deliver(batch);
+
+        lock.lock();
+    }
+}
+
+void PollScheduler::deliver(std::vector<internal::PollResult> &batch)
+{
+    ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::BEGIN, -1, batch.size());
+
+    py::gil_scoped_acquire gil;
+
+    ASYNC_PYSERIAL_TRACE(trace::GIL_ACQUIRE, trace::END, -1, batch.size());
+    ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::BEGIN, -1, batch.size());
+
+    try {
+        py::list results(batch.size());
+
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            auto &result = batch[i];
+
+            results[i] = py::make_tuple(keys[result.entry], static_cast<int>(result.status), py::bytes(result.response),
+                                        static_cast<double>(result.latency_ns) / 1e9);
+        }
+
+        callback(results);
+    } catch(const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+    }
+
+    batch.clear();
+
+    ASYNC_PYSERIAL_TRACE(trace::PY_CALLBACK, trace::END, -1, 0);
+}
+
+void PollScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        stopping = true;
+
+        cv.notify_one();
+    }
+
+    if (thread.joinable() && std::this_thread::get_id() != thread.get_id())
+    {
+        thread.join();
+    }
+}
+#endif
+
+void SerialPort::callEvent(unsigned int event)
+{
+    if (event_callback)
+    {
+        try {
+            py::gil_scoped_acquire gil;
+
+            event_callback(event);
+        } catch(const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+        }
+    }
+}
+
+PYBIND11_MODULE(async_pyserial_core, m)
+{
+    py::class_<base::SerialPortOptions>(m, "SerialPortOptions")
+        .def(py::init<>())
+        .def_readwrite("baudrate", &base::SerialPortOptions::baudrate)
+        .def_readwrite("bytesize", &base::SerialPortOptions::bytesize)
+        .def_readwrite("stopbits", &base::SerialPortOptions::stopbits)
+        .def_readwrite("parity", &base::SerialPortOptions::parity)
+        .def_readwrite("read_timeout", &base::SerialPortOptions::read_timeout)
+        .def_readwrite("write_timeout", &base::SerialPortOptions::write_timeout)
+        .def_readwrite("io_engine", &base::SerialPortOptions::io_engine)
+        .def_readwrite("read_buffer_size", &base::SerialPortOptions::read_buffer_size)
+        .def_readwrite("read_budget", &base::SerialPortOptions::read_budget)
+        .def_readwrite("cpu_affinity", &base::SerialPortOptions::cpu_affinity)
+        .def_readwrite("sched_policy", &base::SerialPortOptions::sched_policy)
+        .def_readwrite("sched_priority", &base::SerialPortOptions::sched_priority)
+        .def_readwrite("thread_name", &base::SerialPortOptions::thread_name)
+        .def_readwrite("reconnect", &base::SerialPortOptions::reconnect)
+        .def_readwrite("reconnect_interval", &base::SerialPortOptions::reconnect_interval)
+        .def_readwrite("reconnect_max_interval", &base::SerialPortOptions::reconnect_max_interval)
+        .def_readwrite("reconnect_write_policy", &base::SerialPortOptions::reconnect_write_policy)
+        .def_readwrite("overflow_policy", &base::SerialPortOptions::overflow_policy)
+        .def_readwrite("broadcast_bufsize", &base::SerialPortOptions::broadcast_bufsize)
+        .def_readwrite("rs485", &base::SerialPortOptions::rs485)
+        .def_readwrite("rs485_rts_on_send", &base::SerialPortOptions::rs485_rts_on_send)
+        .def_readwrite("rs485_delay_before_send", &base::SerialPortOptions::rs485_delay_before_send)
+        .def_readwrite("rs485_delay_after_send", &base::SerialPortOptions::rs485_delay_after_send)
+        .def_readwrite("rs485_suppress_echo", &base::SerialPortOptions::rs485_suppress_echo);
+
+    py::class_<pybind::SerialPort>(m, "SerialPort")
+        .def(py::init<const std::wstring &, const base::SerialPortOptions &>())
+        .def("open", &pybind::SerialPort::open)
+        .def("close", &pybind::SerialPort::close)
+        .def("write", &pybind::SerialPort::write)
+        .def("write_many", &pybind::SerialPort::write_many)
+        .def("set_data_callback", &pybind::SerialPort::set_data_callback)
+        .def("read", &pybind::SerialPort::read)
+        .def("read_nowait", &pybind::SerialPort::read_nowait)
+        .def("read_until", &pybind::SerialPort::read_until)
+        .def("lines", [](pybind::SerialPort &port, const std::string &delimiter, size_t max_bytes, long timeout_ms)
+             { return pybind::LineIterator(port, delimiter, max_bytes, timeout_ms); }, py::keep_alive<0, 1>())
+        .def("in_waiting", &pybind::SerialPort::in_waiting)
+        .def("write_all", &pybind::SerialPort::write_all)
+        .def("set_read_buffer", &pybind::SerialPort::set_read_buffer)
+        .def("write_buffer_size", &pybind::SerialPort::write_buffer_size)
+#ifdef LINUX
+        .def("start_recording", &pybind::SerialPort::start_recording)
+        .def("stop_recording", &pybind::SerialPort::stop_recording)
+        .def("attach_capture_log", &pybind::SerialPort::attach_capture_log)
+        .def("detach_capture_log", &pybind::SerialPort::detach_capture_log)
+        .def("io_engine", &pybind::SerialPort::io_engine)
+        .def("rs485_mode", &pybind::SerialPort::rs485_mode)
+        .def("thread_status", &pybind::SerialPort::thread_status)
+        .def("reconfigure", &pybind::SerialPort::reconfigure)
+        .def("set_event_callback", &pybind::SerialPort::set_event_callback)
+        .def("is_connected", &pybind::SerialPort::is_connected)
+        .def("write_stats", &pybind::SerialPort::write_stats, py::call_guard<py::gil_scoped_release>())
+        .def("schedule_write", &pybind::SerialPort::schedule_write)
+        .def("pause_reading", &pybind::SerialPort::pause_reading, py::call_guard<py::gil_scoped_release>())
+        .def("resume_reading", &pybind::SerialPort::resume_reading, py::call_guard<py::gil_scoped_release>())
+        .def("notify_fd", &pybind::SerialPort::notify_fd)
+        .def("read_batch", &pybind::SerialPort::read_batch)
+        .def("take_write_error", &pybind::SerialPort::take_write_error)
+        .def("receive_stats", &pybind::SerialPort::receive_stats)
+        .def("set_overflow_callback", &pybind::SerialPort::set_overflow_callback)
+        .def("subscribe", &pybind::SerialPort::subscribe)
+        .def("watch", &pybind::SerialPort::watch, py::keep_alive<0, 1>())
+#endif
+        ;
+
+    py::class_<pybind::PortGroup, std::shared_ptr<pybind::PortGroup>>(m, "PortGroup")
+        .def(py::init(&pybind::PortGroup::create))
+        .def("add", &pybind::PortGroup::add, py::keep_alive<1, 2>())
+        .def("remove", &pybind::PortGroup::remove)
+        .def("close", &pybind::PortGroup::close, py::call_guard<py::gil_scoped_release>())
+        .def("pending", &pybind::PortGroup::pending);
+
+#ifdef LINUX
+    py::class_<pybind::PollScheduler>(m, "PollScheduler")
+        .def(py::init<const py::function &, bool, size_t, long>())
+        .def("add", &pybind::PollScheduler::add, py::keep_alive<1, 2>())
+        .def("close", &pybind::PollScheduler::close, py::call_guard<py::gil_scoped_release>())
+        .def("stats", &pybind::PollScheduler::stats);
+
+    py::class_<internal::PollStats>(m, "PollStats")
+        .def_readonly("requests", &internal::PollStats::requests)
+        .def_readonly("responses", &internal::PollStats::responses)
+        .def_readonly("timeouts", &internal::PollStats::timeouts)
+        .def_readonly("errors", &internal::PollStats::errors)
+        .def_readonly("unsolicited", &internal::PollStats::unsolicited)
+        .def_readonly("suppressed", &internal::PollStats::suppressed);
+#endif
+
+    py::class_<pybind::LineIterator>(m, "LineIterator")
+        .def("__iter__", [](pybind::LineIterator &it) -> pybind::LineIterator & { return it; }, py::return_value_policy::reference_internal)
+        .def("__next__", &pybind::LineIterator::next);
+
+    py::register_exception<common::TimeoutException>(m, "TimeoutException", PyExc_TimeoutError);
+
+    m.def("trace_enable", &trace::enable, py::arg("capacity") = trace::DEFAULT_CAPACITY);
+    m.def("trace_disable", &trace::disable);
+    m.def("trace_clear", &trace::clear);
+    m.def("trace_dump", &trace::dump_chrome_json);
+
+#ifdef LINUX
+    py::class_<common::BroadcastSubscriber, std::shared_ptr<common::BroadcastSubscriber>>(m, "BroadcastSubscriber")
+        .def("read", [](common::BroadcastSubscriber &subscriber, size_t size, long timeout_ms)
+             {
+                 // reused, so small reads don't allocate the requested size each time
+                 thread_local std::string chunk;
+                 size_t count;
+
+                 {
+                     py::gil_scoped_release release;
+
+                     chunk.resize(size);
+                     count = subscriber.read(&chunk[0], size, timeout_ms);
+                 }
+
+                 return py::bytes(chunk.data(), count); })
+        .def("read_into", [](common::BroadcastSubscriber &subscriber, py::buffer buffer, long timeout_ms)
+             {
+                 py::buffer_info info = buffer.request(true);
+
+                 py::gil_scoped_release release;
+
+                 return subscriber.read(static_cast<char *>(info.ptr), static_cast<size_t>(info.size * info.itemsize), timeout_ms); })
+        .def("available", &common::BroadcastSubscriber::available)
+        .def("lost", &common::BroadcastSubscriber::lost)
+        .def("dropped", &common::BroadcastSubscriber::dropped)
+        .def("close", &common::BroadcastSubscriber::close);
+
+    py::class_<common::PatternMatch>(m, "PatternMatch")
+        .def_readonly("pattern", &common::PatternMatch::pattern)
+        .def_readonly("offset", &common::PatternMatch::offset)
+        .def_property_readonly("context", [](const common::PatternMatch &match)
+                               { return py::bytes(match.context); })
+        .def_readonly("context_offset", &common::PatternMatch::context_offset);
+
+    py::class_<pybind::PatternWatch, std::shared_ptr<pybind::PatternWatch>>(m, "PatternWatch")
+        .def("close", &pybind::PatternWatch::close, py::call_guard<py::gil_scoped_release>())
+        .def("position", &pybind::PatternWatch::position)
+        .def("matches", &pybind::PatternWatch::matches);
+
+    py::class_<internal::ReceiveStats>(m, "ReceiveStats")
+        .def_readonly("overrun", &internal::ReceiveStats::overrun)
+        .def_readonly("buf_overrun", &internal::ReceiveStats::buf_overrun)
+        .def_readonly("frame", &internal::ReceiveStats::frame)
+        .def_readonly("parity", &internal::ReceiveStats::parity)
+        .def_readonly("brk", &internal::ReceiveStats::brk)
+        .def_readonly("dropped", &internal::ReceiveStats::dropped);
+
+    py::class_<internal::WriteStats>(m, "WriteStats")
+        .def_readonly("requests", &internal::WriteStats::requests)
+        .def_readonly("heap_payloads", &internal::WriteStats::heap_payloads)
+        .def_readonly("slab_allocations", &internal::WriteStats::slab_allocations)
+        .def_readonly("pooled", &internal::WriteStats::pooled);
+
+    py::class_<internal::ScheduledWrite, std::shared_ptr<internal::ScheduledWrite>>(m, "ScheduledWrite")
+        .def("cancel", &internal::ScheduledWrite::cancel, py::call_guard<py::gil_scoped_release>())
+        .def("active", &internal::ScheduledWrite::active)
+        .def("fired", &internal::ScheduledWrite::fired)
+        .def("missed", &internal::ScheduledWrite::missed);
+
+    py::class_<internal::ThreadStatus>(m, "ThreadStatus")
+        .def_readonly("applied", &internal::ThreadStatus::applied)
+        .def_readonly("cpu_affinity", &internal::ThreadStatus::cpu_affinity)
+        .def_readonly("affinity_error", &internal::ThreadStatus::affinity_error)
+        .def_readonly("sched_policy", &internal::ThreadStatus::sched_policy)
+        .def_readonly("sched_priority", &internal::ThreadStatus::sched_priority)
+        .def_readonly("sched_error", &internal::ThreadStatus::sched_error)
+        .def_readonly("name", &internal::ThreadStatus::name)
+        .def_readonly("name_error", &internal::ThreadStatus::name_error);
+
+    py::class_<internal::LoopbackOptions>(m, "LoopbackOptions")
+        .def(py::init<>())
+        .def_readwrite("baudrate", &internal::LoopbackOptions::baudrate)
+        .def_readwrite("bits_per_char", &internal::LoopbackOptions::bits_per_char)
+        .def_readwrite("chunk_size", &internal::LoopbackOptions::chunk_size)
+        .def_readwrite("drop_rate", &internal::LoopbackOptions::drop_rate)
+        .def_readwrite("corrupt_rate", &internal::LoopbackOptions::corrupt_rate)
+        .def_readwrite("seed", &internal::LoopbackOptions::seed);
+
+    py::class_<internal::LoopbackPair>(m, "LoopbackPair")
+        .def_readonly("port_a", &internal::LoopbackPair::port_a)
+        .def_readonly("port_b", &internal::LoopbackPair::port_b);
+
+    py::class_<internal::LoopbackStats>(m, "LoopbackStats")
+        .def_readonly("forwarded", &internal::LoopbackStats::forwarded)
+        .def_readonly("dropped", &internal::LoopbackStats::dropped)
+        .def_readonly("corrupted", &internal::LoopbackStats::corrupted);
+
+    py::class_<internal::Loopback>(m, "Loopback")
+        .def(py::init<const internal::LoopbackOptions &>())
+        .def("open", &internal::Loopback::open, py::call_guard<py::gil_scoped_release>())
+        .def("close", &internal::Loopback::close, py::call_guard<py::gil_scoped_release>())
+        .def("is_open", &internal::Loopback::is_open)
+        .def("stats", &internal::Loopback::stats);
+
+    py::class_<internal::ReplayOptions>(m, "ReplayOptions")
+        .def(py::init<>())
+        .def_readwrite("speed", &internal::ReplayOptions::speed)
+        .def_readwrite("loop", &internal::ReplayOptions::loop)
+        .def_readwrite("include_tx", &internal::ReplayOptions::include_tx);
+
+    py::class_<internal::Replayer>(m, "Replayer")
+        .def(py::init<>())
+        .def("add_pty", &internal::Replayer::addPty)
+        .def("add_port", [](internal::Replayer &replayer, const std::string &path, const internal::ReplayOptions &options, pybind::SerialPort &port) {
+            replayer.addEmitter(path, options, port.native(), internal::SerialPortEvent::ON_DATA);
+        }, py::keep_alive<1, 4>())
+        .def("start", &internal::Replayer::start)
+        .def("stop", &internal::Replayer::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &internal::Replayer::is_running)
+        .def("active", &internal::Replayer::active)
+        .def("wait", &internal::Replayer::wait, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<internal::CaptureLogOptions>(m, "CaptureLogOptions")
+        .def(py::init<>())
+        .def_readwrite("directory", &internal::CaptureLogOptions::directory)
+        .def_readwrite("prefix", &internal::CaptureLogOptions::prefix)
+        .def_readwrite("segment_size", &internal::CaptureLogOptions::segment_size)
+        .def_readwrite("max_segments", &internal::CaptureLogOptions::max_segments)
+        .def_readwrite("flush_interval_ms", &internal::CaptureLogOptions::flush_interval_ms);
+
+    py::class_<internal::CaptureLogStats>(m, "CaptureLogStats")
+        .def_readonly("records", &internal::CaptureLogStats::records)
+        .def_readonly("bytes", &internal::CaptureLogStats::bytes)
+        .def_readonly("segments", &internal::CaptureLogStats::segments)
+        .def_readonly("dropped", &internal::CaptureLogStats::dropped);
+
+    py::class_<internal::PortInfo>(m, "PortInfo")
+        .def_readonly("device", &internal::PortInfo::device)
+        .def_readonly("name", &internal::PortInfo::name)
+        .def_readonly("subsystem", &internal::PortInfo::subsystem)
+        .def_readonly("driver", &internal::PortInfo::driver)
+        .def_readonly("hwid", &internal::PortInfo::hwid)
+        .def_readonly("vid", &internal::PortInfo::vid)
+        .def_readonly("pid", &internal::PortInfo::pid)
+        .def_readonly("interface_number", &internal::PortInfo::interface_number)
+        .def_readonly("serial_number", &internal::PortInfo::serial_number)
+        .def_readonly("manufacturer", &internal::PortInfo::manufacturer)
+        .def_readonly("product", &internal::PortInfo::product)
+        .def_readonly("interface", &internal::PortInfo::interface)
+        .def_readonly("location", &internal::PortInfo::location)
+        .def_readonly("links", &internal::PortInfo::links);
+
+    m.def("list_ports", &internal::list_ports, py::arg("refresh") = false, py::call_guard<py::gil_scoped_release>());
+
+    py::class_<internal::CaptureLog, std::shared_ptr<internal::CaptureLog>>(m, "CaptureLog")
+        .def(py::init<const internal::CaptureLogOptions &>())
+        .def("close", &internal::CaptureLog::close, py::call_guard<py::gil_scoped_release>())
+        .def("is_open", &internal::CaptureLog::is_open)
+        .def("stats", &internal::CaptureLog::stats)
+        .def("current_segment", &internal::CaptureLog::current_segment);
+#endif
+}
\ No newline at end of file
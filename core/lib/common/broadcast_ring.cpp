@@ -0,0 +1,223 @@
+#include <common/broadcast_ring.h>
+#include <common/exception.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace async_pyserial::common;
+
+static size_t roundCapacity(size_t capacity)
+{
+    size_t rounded = 1024;
+
+    while (rounded < capacity)
+    {
+        rounded <<= 1;
+    }
+
+    return rounded;
+}
+
+BroadcastRing::BroadcastRing(size_t capacity)
+{
+    size_t rounded = roundCapacity(capacity);
+
+    buffer.reset(new char[rounded]);
+    mask = rounded - 1;
+}
+
+void BroadcastRing::onChunk(StreamDirection direction, uint64_t, const char *data, size_t size)
+{
+    if (direction != RX || size == 0)
+    {
+        return;
+    }
+
+    uint64_t start = head.load(std::memory_order_relaxed);
+    uint64_t end = start + size;
+
+    // only the tail of a chunk larger than the ring survives
+    if (size > mask + 1)
+    {
+        data += size - (mask + 1);
+        start = end - (mask + 1);
+        size = mask + 1;
+    }
+
+    // readers check it after copying, so it must be visible before the bytes change
+    reserved.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t offset = start & mask;
+    size_t first = std::min(size, mask + 1 - offset);
+
+    memcpy(buffer.get() + offset, data, first);
+    memcpy(buffer.get(), data + first, size - first);
+
+    // sequentially consistent with the waiters check below, see BroadcastSubscriber::read
+    head.store(end);
+
+    if (waiters.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        cv.notify_all();
+    }
+}
+
+void BroadcastRing::open()
+{
+    closed = false;
+}
+
+void BroadcastRing::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    closed = true;
+
+    cv.notify_all();
+}
+
+size_t BroadcastRing::capacity() const
+{
+    return mask + 1;
+}
+
+uint64_t BroadcastRing::position() const
+{
+    return head.load(std::memory_order_acquire);
+}
+
+BroadcastSubscriber::BroadcastSubscriber(const std::shared_ptr<BroadcastRing> &ring, LagPolicy policy)
+    : ring(ring), policy(policy), cursor(ring->position()) {}
+
+bool BroadcastSubscriber::catchUp()
+{
+    uint64_t reserved = ring->reserved.load(std::memory_order_acquire);
+    uint64_t oldest = reserved > ring->capacity() ? reserved - ring->capacity() : 0;
+    uint64_t position = cursor.load(std::memory_order_relaxed);
+
+    if (position >= oldest)
+    {
+        return true;
+    }
+
+    if (policy == LAG_DROP)
+    {
+        is_dropped = true;
+        return false;
+    }
+
+    skipped.fetch_add(oldest - position, std::memory_order_relaxed);
+    cursor.store(oldest, std::memory_order_relaxed);
+
+    return true;
+}
+
+size_t BroadcastSubscriber::read(char *out, size_t size, long timeout_ms)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0L));
+
+    while (true)
+    {
+        if (closed || ring->closed)
+        {
+            throw SerialPortException("subscription is closed");
+        }
+
+        if (is_dropped || !catchUp())
+        {
+            throw SerialPortException("subscriber fell behind and was dropped");
+        }
+
+        uint64_t position = cursor.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+
+        if (head > position)
+        {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(size, head - position));
+            size_t offset = position & ring->mask;
+            size_t first = std::min(count, ring->mask + 1 - offset);
+
+            memcpy(out, ring->buffer.get() + offset, first);
+            memcpy(out + first, ring->buffer.get(), count - first);
+
+            // the writer may have lapped us while copying, then the copy is torn
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (ring->reserved.load(std::memory_order_relaxed) > position + ring->capacity())
+            {
+                continue;
+            }
+
+            cursor.store(position + count, std::memory_order_relaxed);
+
+            return count;
+        }
+
+        std::unique_lock<std::mutex> lock(ring->mutex);
+
+        auto ready = [this, position]
+        { return closed || ring->closed || ring->head.load() > position; };
+
+        ring->waiters++;
+
+        bool woken;
+
+        if (timeout_ms < 0)
+        {
+            ring->cv.wait(lock, ready);
+            woken = true;
+        }
+        else
+        {
+            woken = ring->cv.wait_until(lock, deadline, ready);
+        }
+
+        ring->waiters--;
+
+        if (!woken)
+        {
+            throw TimeoutException("read timeout");
+        }
+    }
+}
+
+size_t BroadcastSubscriber::available() const
+{
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t position = cursor.load(std::memory_order_relaxed);
+
+    if (head <= position)
+    {
+        return 0;
+    }
+
+    return static_cast<size_t>(std::min<uint64_t>(head - position, ring->capacity()));
+}
+
+uint64_t BroadcastSubscriber::lost() const
+{
+    return skipped.load(std::memory_order_relaxed);
+}
+
+bool BroadcastSubscriber::dropped() const
+{
+    return is_dropped;
+}
+
+void BroadcastSubscriber::close()
+{
+    std::lock_guard<std::mutex> lock(ring->mutex);
+
+    closed = true;
+
+    ring->cv.notify_all();
+}
@@ -0,0 +1,207 @@
+#include <common/pattern_matcher.h>
+#include <common/exception.h>
+
+#include <algorithm>
+#include <deque>
+
+using namespace async_pyserial::common;
+
+PatternMatcher::PatternMatcher(const std::vector<std::string> &patterns, size_t context, const Callback &callback)
+    : patterns(patterns), context(context), callback(callback), max_size(0), state(0), scanned(0)
+{
+    if (patterns.empty())
+    {
+        throw SerialPortException("no patterns to match");
+    }
+
+    // class 0 is every byte no pattern uses
+    std::fill(std::begin(classes), std::end(classes), 0);
+    class_count = 1;
+
+    for (const auto &pattern : patterns)
+    {
+        if (pattern.empty())
+        {
+            throw SerialPortException("patterns must not be empty");
+        }
+
+        for (unsigned char byte : pattern)
+        {
+            if (classes[byte] == 0)
+            {
+                classes[byte] = static_cast<uint16_t>(class_count++);
+            }
+        }
+
+        max_size = std::max(max_size, pattern.size());
+    }
+
+    // the trie, 0 is "no edge" since the root is never a child
+    table.assign(class_count, 0);
+    outputs.emplace_back();
+
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+        uint32_t node = 0;
+
+        for (unsigned char byte : patterns[i])
+        {
+            uint32_t &next = table[node * class_count + classes[byte]];
+
+            if (next == 0)
+            {
+                next = static_cast<uint32_t>(outputs.size());
+
+                table.resize(table.size() + class_count, 0);
+                outputs.emplace_back();
+            }
+
+            node = table[node * class_count + classes[byte]];
+        }
+
+        outputs[node].push_back(static_cast<uint32_t>(i));
+    }
+
+    // breadth first, so a node's suffix link is complete before its children: missing edges become
+    // the suffix link's edges, turning the trie into a DFA
+    std::vector<uint32_t> fail(outputs.size(), 0);
+    std::deque<uint32_t> queue;
+
+    for (size_t c = 0; c < class_count; c++)
+    {
+        if (table[c] != 0)
+        {
+            queue.push_back(table[c]);
+        }
+    }
+
+    while (!queue.empty())
+    {
+        uint32_t node = queue.front();
+        queue.pop_front();
+
+        const auto &inherited = outputs[fail[node]];
+        outputs[node].insert(outputs[node].end(), inherited.begin(), inherited.end());
+
+        for (size_t c = 0; c < class_count; c++)
+        {
+            uint32_t &next = table[node * class_count + c];
+            uint32_t fallback = table[fail[node] * class_count + c];
+
+            if (next == 0)
+            {
+                next = fallback;
+            }
+            else
+            {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    if (table.size() >= MATCH)
+    {
+        throw SerialPortException("too many pattern bytes");
+    }
+
+    // entries become row offsets, saving the multiplication per byte
+    for (auto &next : table)
+    {
+        next = static_cast<uint32_t>(next * class_count) | (outputs[next].empty() ? 0 : MATCH);
+    }
+}
+
+void PatternMatcher::onChunk(StreamDirection direction, uint64_t, const char *data, size_t size)
+{
+    if (direction != RX || size == 0)
+    {
+        return;
+    }
+
+    std::vector<PatternMatch> found;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const uint32_t *transitions = table.data();
+        uint32_t current = state;
+        bool any = false;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            uint32_t next = transitions[current + classes[static_cast<unsigned char>(data[i])]];
+
+            current = next & ~MATCH;
+
+            if (next & MATCH)
+            {
+                uint64_t end = scanned + i + 1;
+
+                for (uint32_t pattern : outputs[current / class_count])
+                {
+                    pending.push_back({pattern, end - patterns[pattern].size()});
+                }
+
+                any = true;
+            }
+        }
+
+        state = current;
+        scanned += size;
+
+        // a match completed by the next chunk and the context before it may reach this far back
+        size_t keep = max_size + context;
+
+        if (!any && size >= keep)
+        {
+            // the common case on streams without matches, only the tail is kept
+            history.assign(data + size - keep, keep);
+        }
+        else
+        {
+            history.append(data, size);
+
+            collect(found);
+
+            if (history.size() > keep)
+            {
+                history.erase(0, history.size() - keep);
+            }
+        }
+    }
+
+    if (!found.empty())
+    {
+        matched += found.size();
+
+        callback(found);
+    }
+}
+
+uint64_t PatternMatcher::position()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return scanned;
+}
+
+uint64_t PatternMatcher::matches() const
+{
+    return matched;
+}
+
+void PatternMatcher::collect(std::vector<PatternMatch> &out)
+{
+    uint64_t start = scanned - history.size();
+
+    for (const auto &match : pending)
+    {
+        uint64_t from = std::max(match.offset > context ? match.offset - context : 0, start);
+        uint64_t to = std::min(match.offset + patterns[match.pattern].size() + context, scanned);
+
+        out.push_back({match.pattern, match.offset, history.substr(from - start, to - from), static_cast<size_t>(match.offset - from)});
+    }
+
+    pending.clear();
+}
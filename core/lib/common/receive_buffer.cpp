@@ -0,0 +1,237 @@
+#include <common/receive_buffer.h>
+#include <common/exception.h>
+#include <common/search.h>
+
+#include <algorithm>
+#include <chrono>
+
+using namespace async_pyserial::common;
+
+ReceiveBuffer::ReceiveBuffer(size_t capacity)
+    : head(0), capacity(capacity), keep_overflow(false), wanted(0), scanned(0), closed(true) {}
+
+void ReceiveBuffer::set_capacity(size_t capacity, bool keep_overflow)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    this->capacity = capacity;
+    this->keep_overflow = keep_overflow;
+}
+
+size_t ReceiveBuffer::append(const char *data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (closed)
+    {
+        return 0;
+    }
+
+    size_t limit = capacity > 0 ? capacity : wanted;
+    size_t kept = capacity > 0 && keep_overflow ? size : std::min(size, limit > available() ? limit - available() : 0);
+
+    if (kept == 0)
+    {
+        return 0;
+    }
+
+    if (head > 0 && head >= buffer.size() / 2)
+    {
+        buffer.erase(0, head);
+        head = 0;
+    }
+
+    buffer.append(data, kept);
+
+    cv.notify_all();
+
+    return kept;
+}
+
+std::string ReceiveBuffer::read(size_t size, long timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (closed)
+    {
+        throw SerialPortException("serial port is not open");
+    }
+
+    if (size == 0)
+    {
+        return "";
+    }
+
+    auto ready = [this]
+    { return closed || available() > 0; };
+
+    wanted += size;
+
+    bool timed_out = false;
+
+    if (timeout_ms < 0)
+    {
+        cv.wait(lock, ready);
+    }
+    else
+    {
+        timed_out = !cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+
+    wanted -= size;
+
+    if (closed)
+    {
+        throw SerialPortException("serial port is closed");
+    }
+
+    if (timed_out)
+    {
+        throw TimeoutException("read timeout");
+    }
+
+    return take(size);
+}
+
+std::string ReceiveBuffer::read_until(const std::string &delimiter, size_t max_bytes, long timeout_ms)
+{
+    if (delimiter.empty())
+    {
+        return read(max_bytes, timeout_ms);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (closed)
+    {
+        throw SerialPortException("serial port is not open");
+    }
+
+    if (max_bytes == 0)
+    {
+        return "";
+    }
+
+    if (delimiter != scan_delimiter)
+    {
+        scan_delimiter = delimiter;
+        scanned = 0;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0L));
+
+    wanted += max_bytes;
+
+    while (true)
+    {
+        size_t size = available();
+        size_t limit = std::min(size, max_bytes);
+
+        if (scanned < limit)
+        {
+            size_t found = find(buffer.data() + head + scanned, limit - scanned, delimiter.data(), delimiter.size());
+
+            if (found != std::string::npos)
+            {
+                wanted -= max_bytes;
+
+                return take(scanned + found + delimiter.size());
+            }
+
+            // a delimiter may still start in the last delimiter.size() - 1 bytes
+            scanned = limit >= delimiter.size() ? limit - delimiter.size() + 1 : 0;
+        }
+
+        if (limit == max_bytes || (capacity > 0 && size >= capacity))
+        {
+            wanted -= max_bytes;
+
+            return take(limit);
+        }
+
+        auto grown = [this, size]
+        { return closed || available() > size; };
+
+        bool timed_out = false;
+
+        if (timeout_ms < 0)
+        {
+            cv.wait(lock, grown);
+        }
+        else
+        {
+            timed_out = !cv.wait_until(lock, deadline, grown);
+        }
+
+        if (closed)
+        {
+            wanted -= max_bytes;
+
+            throw SerialPortException("serial port is closed");
+        }
+
+        if (timed_out)
+        {
+            wanted -= max_bytes;
+
+            throw TimeoutException("read timeout");
+        }
+    }
+}
+
+std::string ReceiveBuffer::read_nowait(size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return take(size);
+}
+
+size_t ReceiveBuffer::size()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return available();
+}
+
+void ReceiveBuffer::open()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    closed = false;
+}
+
+void ReceiveBuffer::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    closed = true;
+
+    buffer.clear();
+    head = 0;
+    scanned = 0;
+
+    cv.notify_all();
+}
+
+size_t ReceiveBuffer::available() const
+{
+    return buffer.size() - head;
+}
+
+std::string ReceiveBuffer::take(size_t size)
+{
+    size_t count = std::min(size, available());
+
+    std::string data = buffer.substr(head, count);
+
+    head += count;
+    scanned = scanned > count ? scanned - count : 0;
+
+    if (head == buffer.size())
+    {
+        buffer.clear();
+        head = 0;
+    }
+
+    return data;
+}
@@ -0,0 +1,128 @@
+#include <common/record.h>
+#include <common/exception.h>
+
+#include <chrono>
+#include <cstring>
+
+using namespace async_pyserial::common;
+
+#define RECORD_WRITE_BUFFER_SIZE 65536
+
+uint64_t async_pyserial::common::monotonic_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+RecordWriter::RecordWriter(const std::string &path)
+{
+    file = fopen(path.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        throw OSException("open record file failure: " + path);
+    }
+
+    setvbuf(file, nullptr, _IOFBF, RECORD_WRITE_BUFFER_SIZE);
+
+    RecordFileHeader header;
+    memcpy(header.magic, RECORD_MAGIC, sizeof(header.magic));
+    header.version = RECORD_VERSION;
+    header.reserved = 0;
+
+    fwrite(&header, sizeof(header), 1, file);
+}
+
+RecordWriter::~RecordWriter()
+{
+    close();
+}
+
+void RecordWriter::onChunk(StreamDirection direction, uint64_t ts_ns, const char *data, size_t size)
+{
+    RecordHeader header;
+    header.ts_ns = ts_ns;
+    header.size = static_cast<uint32_t>(size);
+    header.direction = direction;
+    memset(header.reserved, 0, sizeof(header.reserved));
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(data, 1, size, file);
+}
+
+void RecordWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file != nullptr)
+    {
+        fflush(file);
+    }
+}
+
+void RecordWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (file != nullptr)
+    {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+RecordReader::RecordReader(const std::string &path)
+{
+    file = fopen(path.c_str(), "rb");
+
+    if (file == nullptr)
+    {
+        throw OSException("open record file failure: " + path);
+    }
+
+    RecordFileHeader header;
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, RECORD_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RECORD_VERSION)
+    {
+        fclose(file);
+        file = nullptr;
+
+        throw ConvertException("invalid record file: " + path);
+    }
+}
+
+RecordReader::~RecordReader()
+{
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+}
+
+bool RecordReader::next(RecordHeader &header, std::string &data)
+{
+    if (fread(&header, sizeof(header), 1, file) != 1)
+    {
+        return false;
+    }
+
+    data.resize(header.size);
+
+    // a truncated tail (e.g. the recorder crashed) ends the stream
+    return header.size == 0 || fread(&data[0], 1, header.size, file) == header.size;
+}
+
+void RecordReader::rewind()
+{
+    fseek(file, sizeof(RecordFileHeader), SEEK_SET);
+}
@@ -0,0 +1,203 @@
+#include <common/search.h>
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+// memchr candidates rejected before switching to the vector filter
+#define SEARCH_FALSE_CANDIDATES 8
+
+using namespace async_pyserial;
+
+namespace
+{
+    size_t find_scalar(const char *data, size_t size, const char *needle, size_t needle_size, size_t start)
+    {
+        const char *end = data + size - needle_size + 1;
+
+        for (const char *ptr = data + start; ptr < end;)
+        {
+            ptr = static_cast<const char *>(memchr(ptr, needle[0], end - ptr));
+
+            if (ptr == nullptr)
+            {
+                break;
+            }
+
+            if (memcmp(ptr + 1, needle + 1, needle_size - 1) == 0)
+            {
+                return ptr - data;
+            }
+
+            ptr++;
+        }
+
+        return std::string::npos;
+    }
+
+#ifdef SEARCH_X86
+#ifdef __SSE2__
+    size_t find_sse2(const char *data, size_t size, const char *needle, size_t needle_size)
+    {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[needle_size - 1]);
+
+        size_t i = 0;
+
+        for (; i + needle_size - 1 + 16 <= size; i += 16)
+        {
+            const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + needle_size - 1));
+
+            uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+
+            while (mask != 0)
+            {
+                size_t bit = __builtin_ctz(mask);
+
+                if (memcmp(data + i + bit + 1, needle + 1, needle_size - 2) == 0)
+                {
+                    return i + bit;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        return find_scalar(data, size, needle, needle_size, i);
+    }
+#endif
+
+    __attribute__((target("avx2"))) size_t find_avx2(const char *data, size_t size, const char *needle, size_t needle_size)
+    {
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[needle_size - 1]);
+
+        size_t i = 0;
+
+        // two blocks per iteration, candidates are rare
+        for (; i + needle_size - 1 + 64 <= size; i += 64)
+        {
+            const __m256i eq_first0 = _mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+            const __m256i eq_last0 = _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + needle_size - 1)));
+            const __m256i eq_first1 = _mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32)));
+            const __m256i eq_last1 = _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 32 + needle_size - 1)));
+
+            const __m256i eq0 = _mm256_and_si256(eq_first0, eq_last0);
+            const __m256i eq1 = _mm256_and_si256(eq_first1, eq_last1);
+
+            if (_mm256_testz_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq0, eq1)))
+            {
+                continue;
+            }
+
+            uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq0)) |
+                            static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(eq1))) << 32;
+
+            while (mask != 0)
+            {
+                size_t bit = __builtin_ctzll(mask);
+
+                if (memcmp(data + i + bit + 1, needle + 1, needle_size - 2) == 0)
+                {
+                    return i + bit;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        for (; i + needle_size - 1 + 32 <= size; i += 32)
+        {
+            const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + needle_size - 1));
+
+            uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+
+            while (mask != 0)
+            {
+                size_t bit = __builtin_ctz(mask);
+
+                if (memcmp(data + i + bit + 1, needle + 1, needle_size - 2) == 0)
+                {
+                    return i + bit;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        return find_scalar(data, size, needle, needle_size, i);
+    }
+
+    const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+size_t common::find(const char *data, size_t size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+    {
+        return 0;
+    }
+
+    if (needle_size > size)
+    {
+        return std::string::npos;
+    }
+
+    if (needle_size == 1)
+    {
+        const void *ptr = memchr(data, needle[0], size);
+
+        return ptr == nullptr ? std::string::npos : static_cast<const char *>(ptr) - data;
+    }
+
+#ifdef SEARCH_X86
+    // libc's memchr on the first byte wins while that byte is rare (e.g. '\r' of "\r\n"),
+    // the first and last byte filter once it keeps stopping on false candidates
+    const char *end = data + size - needle_size + 1;
+    const char *ptr = data;
+
+    for (int false_candidates = 0; false_candidates < SEARCH_FALSE_CANDIDATES; false_candidates++)
+    {
+        ptr = static_cast<const char *>(memchr(ptr, needle[0], end - ptr));
+
+        if (ptr == nullptr)
+        {
+            return std::string::npos;
+        }
+
+        if (memcmp(ptr + 1, needle + 1, needle_size - 1) == 0)
+        {
+            return ptr - data;
+        }
+
+        ptr++;
+    }
+
+    size_t offset = ptr - data;
+    size_t found;
+
+    if (has_avx2)
+    {
+        found = find_avx2(ptr, size - offset, needle, needle_size);
+    }
+    else
+    {
+#ifdef __SSE2__
+        found = find_sse2(ptr, size - offset, needle, needle_size);
+#else
+        found = find_scalar(ptr, size - offset, needle, needle_size, 0);
+#endif
+    }
+
+    return found == std::string::npos ? found : found + offset;
+#else
+    return find_scalar(data, size, needle, needle_size, 0);
+#endif
+}
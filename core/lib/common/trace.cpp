@@ -0,0 +1,341 @@
+#include <common/trace.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+
+#ifdef Win32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef LINUX
+#include <sys/syscall.h>
+#endif
+
+using namespace async_pyserial::common;
+
+namespace
+{
+    struct ThreadBuffer
+    {
+        std::unique_ptr<trace::TraceRecord[]> records;
+        size_t capacity;
+        std::atomic<uint64_t> head{0};
+        uint64_t generation;
+        uint32_t tid;
+        std::string name;
+    };
+
+    std::mutex registry_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    // the names an fd had since the last clear(), from their timestamp on, an empty name once it was closed,
+    // so records of a closed or reused fd keep the name of the port they were made for
+    std::map<int, std::vector<std::pair<uint64_t, std::string>>> port_names;
+
+    std::atomic<size_t> capacity{trace::DEFAULT_CAPACITY};
+    std::atomic<uint64_t> generation{1};
+    std::atomic<uint32_t> next_tid{1};
+
+    thread_local std::shared_ptr<ThreadBuffer> local_buffer;
+    thread_local std::string local_thread_name;
+
+    uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    uint32_t current_tid()
+    {
+#ifdef LINUX
+        return static_cast<uint32_t>(syscall(SYS_gettid));
+#else
+        return next_tid++;
+#endif
+    }
+
+    unsigned long current_pid()
+    {
+#ifdef Win32
+        return GetCurrentProcessId();
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+
+    ThreadBuffer *attach()
+    {
+        auto buf = std::make_shared<ThreadBuffer>();
+
+        buf->capacity = capacity.load(std::memory_order_relaxed);
+        buf->records.reset(new trace::TraceRecord[buf->capacity]);
+        buf->generation = generation.load(std::memory_order_acquire);
+        buf->tid = local_buffer ? local_buffer->tid : current_tid();
+        buf->name = local_thread_name;
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+
+        buffers.push_back(buf);
+        local_buffer = buf;
+
+        return buf.get();
+    }
+
+    size_t round_up_pow2(size_t v)
+    {
+        size_t n = 1;
+        while (n < v)
+        {
+            n <<= 1;
+        }
+        return n;
+    }
+
+    const char *event_name(uint16_t type)
+    {
+        switch (type)
+        {
+        case trace::EPOLL_WAKEUP: return "epoll_wakeup";
+        case trace::READ: return "read";
+        case trace::WRITE: return "write";
+        case trace::WRITE_SUBMIT: return "write_submit";
+        case trace::WRITE_COMPLETE: return "write_complete";
+        case trace::EMIT: return "emit";
+        case trace::GIL_ACQUIRE: return "gil_acquire";
+        case trace::PY_CALLBACK: return "py_callback";
+        default: return "unknown";
+        }
+    }
+
+    const char *arg_name(uint16_t type)
+    {
+        switch (type)
+        {
+        case trace::EPOLL_WAKEUP: return "events";
+        case trace::WRITE_COMPLETE: return "status";
+        default: return "bytes";
+        }
+    }
+
+    void write_json_string(std::ostringstream &out, const std::string &s)
+    {
+        out << '"';
+        for (unsigned char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (c < 0x20)
+            {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out << esc;
+            }
+            else
+            {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+}
+
+std::atomic<bool> trace::enabled{false};
+
+void trace::record(uint16_t type, char phase, int port, uint64_t arg)
+{
+    ThreadBuffer *buf = local_buffer.get();
+
+    if (buf == nullptr || buf->generation != generation.load(std::memory_order_relaxed))
+    {
+        buf = attach();
+    }
+
+    uint64_t h = buf->head.load(std::memory_order_relaxed);
+
+    TraceRecord &r = buf->records[h & (buf->capacity - 1)];
+    r.ts_ns = now_ns();
+    r.arg = arg;
+    r.port = port;
+    r.type = type;
+    r.phase = phase;
+    r.reserved = 0;
+
+    buf->head.store(h + 1, std::memory_order_release);
+}
+
+void trace::enable(size_t cap)
+{
+    cap = round_up_pow2(cap == 0 ? DEFAULT_CAPACITY : cap);
+
+    if (cap != capacity.load())
+    {
+        capacity = cap;
+        clear();
+    }
+
+    enabled = true;
+}
+
+void trace::disable()
+{
+    enabled = false;
+}
+
+void trace::clear()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    // threads pick up a fresh buffer on their next record
+    generation++;
+    buffers.clear();
+
+    // only the current names are left to refer to
+    for (auto it = port_names.begin(); it != port_names.end();)
+    {
+        if (it->second.back().second.empty())
+        {
+            it = port_names.erase(it);
+            continue;
+        }
+
+        it->second.erase(it->second.begin(), it->second.end() - 1);
+        ++it;
+    }
+}
+
+void trace::set_thread_name(const std::string &name)
+{
+    local_thread_name = name;
+
+    if (local_buffer)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        local_buffer->name = name;
+    }
+}
+
+void trace::set_port_name(int port, const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    port_names[port].emplace_back(now_ns(), name);
+}
+
+void trace::clear_port_name(int port)
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    auto it = port_names.find(port);
+
+    if (it != port_names.end())
+    {
+        it->second.emplace_back(now_ns(), std::string());
+    }
+}
+
+std::string trace::dump_chrome_json()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    unsigned long pid = current_pid();
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"async_pyserial\"}}";
+
+    std::vector<TraceRecord> snapshot;
+
+    for (auto &buf : buffers)
+    {
+        if (!buf->name.empty())
+        {
+            out << ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buf->tid << ",\"args\":{\"name\":";
+            write_json_string(out, buf->name);
+            out << "}}";
+        }
+
+        uint64_t head = buf->head.load(std::memory_order_acquire);
+        uint64_t start = head > buf->capacity ? head - buf->capacity : 0;
+
+        snapshot.clear();
+        for (uint64_t i = start; i < head; i++)
+        {
+            snapshot.push_back(buf->records[i & (buf->capacity - 1)]);
+        }
+
+        // skip records the owner thread may have overwritten while copying
+        uint64_t head_after = buf->head.load(std::memory_order_acquire);
+        uint64_t valid = head_after >= buf->capacity ? head_after - buf->capacity + 1 : 0;
+
+        for (uint64_t i = start; i < head; i++)
+        {
+            if (i < valid)
+            {
+                continue;
+            }
+
+            const TraceRecord &r = snapshot[i - start];
+
+            char ts[32];
+            snprintf(ts, sizeof(ts), "%llu.%03llu",
+                     static_cast<unsigned long long>(r.ts_ns / 1000),
+                     static_cast<unsigned long long>(r.ts_ns % 1000));
+
+            out << ",{\"name\":\"" << event_name(r.type) << "\",\"cat\":\"serial\",\"ph\":\"" << r.phase
+                << "\",\"ts\":" << ts << ",\"pid\":" << pid << ",\"tid\":" << buf->tid;
+
+            if (r.phase == INSTANT)
+            {
+                out << ",\"s\":\"t\"";
+            }
+
+            out << ",\"args\":{\"" << arg_name(r.type) << "\":" << r.arg;
+
+            // events recorded outside the core (e.g. the binding) have no port
+            if (r.port >= 0)
+            {
+                out << ",\"port\":";
+
+                const std::string *name = nullptr;
+
+                auto it = port_names.find(r.port);
+                if (it != port_names.end())
+                {
+                    // the last name given before the record
+                    for (auto &entry : it->second)
+                    {
+                        if (entry.first > r.ts_ns)
+                        {
+                            break;
+                        }
+
+                        name = &entry.second;
+                    }
+                }
+
+                if (name != nullptr && !name->empty())
+                {
+                    write_json_string(out, *name);
+                }
+                else
+                {
+                    out << r.port;
+                }
+            }
+
+            out << "}}";
+        }
+    }
+
+    out << "]}";
+
+    return out.str();
+}
@@ -0,0 +1,296 @@
+#ifdef LINUX
+
+#include <linux/capture_log.h>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#define CAPTURE_RECORD_ALIGN 8
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+static inline uint64_t align_record(uint64_t size)
+{
+    return (size + CAPTURE_RECORD_ALIGN - 1) & ~static_cast<uint64_t>(CAPTURE_RECORD_ALIGN - 1);
+}
+
+static uint64_t realtime_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+CaptureLog::CaptureLog(const CaptureLogOptions &options) : options(options), fd(-1), base(nullptr), header(nullptr),
+                                                           offset(0), segment_index(0), first_segment_index(0), last_flush_ns(0)
+{
+    if (this->options.segment_size < sizeof(CaptureSegmentHeader) + sizeof(CaptureRecordHeader) + CAPTURE_RECORD_ALIGN)
+    {
+        throw common::ConvertException("capture segment size too small");
+    }
+
+    this->options.segment_size = align_record(this->options.segment_size);
+
+    if (mkdir(this->options.directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        throw common::OSException("create capture directory failure: " + this->options.directory);
+    }
+
+    // continue after the segments of a previous run instead of overwriting them
+    std::string match = this->options.prefix + "-";
+    bool found = false;
+
+    DIR *dir = opendir(this->options.directory.c_str());
+
+    if (dir != nullptr)
+    {
+        struct dirent *entry;
+
+        while ((entry = readdir(dir)) != nullptr)
+        {
+            unsigned long long index;
+            char tail[8];
+            std::string name = entry->d_name;
+
+            if (name.compare(0, match.size(), match) != 0 ||
+                sscanf(name.c_str() + match.size(), "%llu.%7s", &index, tail) != 2 ||
+                strcmp(tail, "seg") != 0)
+            {
+                continue;
+            }
+
+            if (!found || index < first_segment_index)
+            {
+                first_segment_index = index;
+            }
+
+            if (!found || index >= segment_index)
+            {
+                segment_index = index + 1;
+            }
+
+            found = true;
+        }
+
+        closedir(dir);
+    }
+
+    openSegment();
+}
+
+CaptureLog::~CaptureLog()
+{
+    close();
+}
+
+std::string CaptureLog::segmentPath(uint64_t index)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "-%08llu.seg", static_cast<unsigned long long>(index));
+
+    return options.directory + "/" + options.prefix + name;
+}
+
+void CaptureLog::openSegment()
+{
+    std::string path = segmentPath(segment_index);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    if (fd == -1)
+    {
+        throw common::OSException("open capture segment failure: " + path);
+    }
+
+    // reserve the blocks up front so appends never hit ENOSPC through a page fault
+    int err = posix_fallocate(fd, 0, options.segment_size);
+
+    if (err == EOPNOTSUPP || err == EINVAL)
+    {
+        err = ftruncate(fd, options.segment_size) == 0 ? 0 : errno;
+    }
+
+    if (err != 0)
+    {
+        ::close(fd);
+        fd = -1;
+
+        throw common::OSException("allocate capture segment failure: " + path);
+    }
+
+    void *mapped = mmap(nullptr, options.segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (mapped == MAP_FAILED)
+    {
+        ::close(fd);
+        fd = -1;
+
+        throw common::OSException("map capture segment failure: " + path);
+    }
+
+    base = static_cast<char *>(mapped);
+    header = reinterpret_cast<CaptureSegmentHeader *>(base);
+
+    memcpy(header->magic, CAPTURE_MAGIC, sizeof(header->magic));
+    header->version = CAPTURE_VERSION;
+    header->flags = 0;
+    header->header_size = sizeof(CaptureSegmentHeader);
+    header->reserved = 0;
+    header->segment_index = segment_index;
+    header->segment_size = options.segment_size;
+    header->created_realtime_ns = realtime_ns();
+    header->created_monotonic_ns = common::monotonic_ns();
+    header->records = 0;
+    __atomic_store_n(&header->committed, sizeof(CaptureSegmentHeader), __ATOMIC_RELEASE);
+
+    offset = sizeof(CaptureSegmentHeader);
+    last_flush_ns = header->created_monotonic_ns;
+
+    _stats.segments++;
+
+    removeOldSegments();
+}
+
+void CaptureLog::sealSegment()
+{
+    if (base == nullptr)
+    {
+        return;
+    }
+
+    header->flags |= CAPTURE_SEALED;
+
+    msync(base, offset, MS_ASYNC);
+    munmap(base, options.segment_size);
+
+    // give back the unused preallocation
+    if (ftruncate(fd, offset) != 0)
+    {
+        perror("truncate capture segment");
+    }
+
+    ::close(fd);
+
+    fd = -1;
+    base = nullptr;
+    header = nullptr;
+
+    segment_index++;
+}
+
+void CaptureLog::removeOldSegments()
+{
+    if (options.max_segments == 0)
+    {
+        return;
+    }
+
+    while (segment_index - first_segment_index + 1 > options.max_segments)
+    {
+        unlink(segmentPath(first_segment_index).c_str());
+        first_segment_index++;
+    }
+}
+
+void CaptureLog::append(uint16_t channel, common::StreamDirection direction, uint64_t ts_ns, const char *data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (base == nullptr)
+    {
+        _stats.dropped++;
+        return;
+    }
+
+    const uint64_t capacity = options.segment_size - sizeof(CaptureSegmentHeader) - sizeof(CaptureRecordHeader);
+
+    do
+    {
+        // chunks larger than a whole segment are split over several records
+        size_t part = static_cast<size_t>(std::min<uint64_t>(size, capacity));
+        uint64_t length = align_record(sizeof(CaptureRecordHeader) + part);
+
+        if (offset + length > options.segment_size)
+        {
+            sealSegment();
+
+            try
+            {
+                openSegment();
+            }
+            catch (const common::OSException &e)
+            {
+                fprintf(stderr, "%s\n", e.what());
+                _stats.dropped++;
+                return;
+            }
+        }
+
+        CaptureRecordHeader *record = reinterpret_cast<CaptureRecordHeader *>(base + offset);
+        record->ts_ns = ts_ns;
+        record->size = static_cast<uint32_t>(part);
+        record->channel = channel;
+        record->direction = direction;
+        record->reserved = 0;
+
+        memcpy(base + offset + sizeof(CaptureRecordHeader), data, part);
+
+        offset += length;
+        header->records++;
+
+        // publish the tail only once the record is complete
+        __atomic_store_n(&header->committed, offset, __ATOMIC_RELEASE);
+
+        _stats.records++;
+        _stats.bytes += part;
+
+        data += part;
+        size -= part;
+    } while (size > 0);
+
+    if (options.flush_interval_ms > 0 && ts_ns > last_flush_ns && ts_ns - last_flush_ns >= options.flush_interval_ms * 1000000ULL)
+    {
+        msync(base, offset, MS_ASYNC);
+        last_flush_ns = ts_ns;
+    }
+}
+
+void CaptureLog::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    sealSegment();
+}
+
+bool CaptureLog::is_open()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return base != nullptr;
+}
+
+CaptureLogStats CaptureLog::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return _stats;
+}
+
+std::string CaptureLog::current_segment()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return base != nullptr ? segmentPath(segment_index) : "";
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifdef LINUX
+
+#include <linux/device_watch.h>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+#define DEVICE_WATCH_EVENTS (IN_CREATE | IN_MOVED_TO | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM)
+
+DeviceWatch::DeviceWatch()
+{
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotify_fd == -1)
+    {
+        throw common::OSException("inotify init failure");
+    }
+}
+
+DeviceWatch::~DeviceWatch()
+{
+    ::close(inotify_fd);
+}
+
+void DeviceWatch::watch(const std::string &directory)
+{
+    // watching a directory twice returns the same watch
+    inotify_add_watch(inotify_fd, directory.c_str(), DEVICE_WATCH_EVENTS | IN_ONLYDIR);
+}
+
+int DeviceWatch::fd()
+{
+    return inotify_fd;
+}
+
+std::vector<std::string> DeviceWatch::drain()
+{
+    std::vector<std::string> names;
+
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true)
+    {
+        ssize_t size = ::read(inotify_fd, buffer, sizeof(buffer));
+
+        if (size < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (size <= 0)
+        {
+            break;
+        }
+
+        for (char *ptr = buffer; ptr < buffer + size;)
+        {
+            auto *event = reinterpret_cast<struct inotify_event *>(ptr);
+
+            if (event->len > 0)
+            {
+                names.emplace_back(event->name);
+            }
+
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return names;
+}
+
+#endif
@@ -0,0 +1,265 @@
+#ifdef LINUX
+
+#include <linux/list_ports.h>
+#include <linux/device_watch.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#define SYS_CLASS_TTY "/sys/class/tty"
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+namespace
+{
+    std::mutex cache_mutex;
+    std::vector<PortInfo> cache;
+    bool cache_valid = false;
+    std::unique_ptr<DeviceWatch> cache_watch;
+    bool watch_unavailable = false;
+
+    // sysfs attributes are small, one read is enough
+    std::string readAttribute(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd == -1)
+        {
+            return "";
+        }
+
+        char buffer[256];
+        ssize_t size = ::read(fd, buffer, sizeof(buffer));
+
+        ::close(fd);
+
+        if (size <= 0)
+        {
+            return "";
+        }
+
+        std::string value(buffer, size);
+
+        while (!value.empty() && (value.back() == '\n' || value.back() == ' '))
+        {
+            value.pop_back();
+        }
+
+        return value;
+    }
+
+    int readHexAttribute(const std::string &path)
+    {
+        std::string value = readAttribute(path);
+
+        if (value.empty())
+        {
+            return -1;
+        }
+
+        char *end;
+        long number = strtol(value.c_str(), &end, 16);
+
+        return *end == '\0' ? static_cast<int>(number) : -1;
+    }
+
+    std::string resolve(const std::string &path)
+    {
+        char resolved[PATH_MAX];
+
+        return realpath(path.c_str(), resolved) != nullptr ? std::string(resolved) : std::string();
+    }
+
+    std::string basename(const std::string &path)
+    {
+        size_t pos = path.find_last_of('/');
+
+        return pos == std::string::npos ? path : path.substr(pos + 1);
+    }
+
+    std::string dirname(const std::string &path)
+    {
+        size_t pos = path.find_last_of('/');
+
+        return pos == std::string::npos ? std::string(".") : path.substr(0, pos);
+    }
+
+    std::vector<std::string> listDirectory(const std::string &path)
+    {
+        std::vector<std::string> entries;
+
+        DIR *dir = opendir(path.c_str());
+
+        if (dir == nullptr)
+        {
+            return entries;
+        }
+
+        while (struct dirent *entry = readdir(dir))
+        {
+            if (entry->d_name[0] != '.')
+            {
+                entries.emplace_back(entry->d_name);
+            }
+        }
+
+        closedir(dir);
+
+        return entries;
+    }
+
+    // device node -> symlinks pointing to it
+    std::map<std::string, std::vector<std::string>> scanLinks()
+    {
+        std::map<std::string, std::vector<std::string>> links;
+
+        for (const char *directory : {"/dev/serial/by-id", "/dev/serial/by-path"})
+        {
+            for (const auto &entry : listDirectory(directory))
+            {
+                std::string link = std::string(directory) + "/" + entry;
+                std::string target = resolve(link);
+
+                if (!target.empty())
+                {
+                    links[target].push_back(link);
+                }
+            }
+        }
+
+        return links;
+    }
+
+    void readUsb(PortInfo &info, const std::string &interface_path)
+    {
+        std::string usb_device_path = dirname(interface_path);
+
+        info.vid = readHexAttribute(usb_device_path + "/idVendor");
+        info.pid = readHexAttribute(usb_device_path + "/idProduct");
+        info.serial_number = readAttribute(usb_device_path + "/serial");
+        info.manufacturer = readAttribute(usb_device_path + "/manufacturer");
+        info.product = readAttribute(usb_device_path + "/product");
+
+        info.interface_number = readHexAttribute(interface_path + "/bInterfaceNumber");
+        info.interface = readAttribute(interface_path + "/interface");
+        info.location = basename(interface_path);
+    }
+
+    std::vector<PortInfo> scan()
+    {
+        std::vector<PortInfo> ports;
+
+        auto links = scanLinks();
+
+        for (const auto &name : listDirectory(SYS_CLASS_TTY))
+        {
+            std::string tty_path = std::string(SYS_CLASS_TTY) + "/" + name;
+
+            // virtual terminals, ptys and the like have no device
+            std::string device_path = resolve(tty_path + "/device");
+
+            if (device_path.empty())
+            {
+                continue;
+            }
+
+            // serial core reports PORT_UNKNOWN (0) for legacy ttyS ports without hardware
+            if (readAttribute(tty_path + "/type") == "0")
+            {
+                continue;
+            }
+
+            // since linux 6.5 serial core ports hang off serial-base port and controller devices,
+            // report the hardware they belong to
+            while (basename(resolve(device_path + "/subsystem")) == "serial-base")
+            {
+                device_path = dirname(device_path);
+            }
+
+            PortInfo info;
+
+            info.name = name;
+            info.device = "/dev/" + name;
+            info.subsystem = basename(resolve(device_path + "/subsystem"));
+            info.driver = basename(resolve(device_path + "/driver"));
+            info.hwid = device_path;
+
+            if (info.subsystem == "usb-serial")
+            {
+                // ttyUSB: the usb-serial port sits below the usb interface
+                readUsb(info, dirname(device_path));
+            }
+            else if (info.subsystem == "usb")
+            {
+                // ttyACM: the device is the usb interface
+                readUsb(info, device_path);
+            }
+
+            auto it = links.find(info.device);
+
+            if (it != links.end())
+            {
+                info.links = it->second;
+            }
+
+            ports.push_back(std::move(info));
+        }
+
+        std::sort(ports.begin(), ports.end(), [](const PortInfo &a, const PortInfo &b)
+                  { return a.device < b.device; });
+
+        return ports;
+    }
+}
+
+std::vector<PortInfo> async_pyserial::internal::list_ports(bool refresh)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (!cache_watch && !watch_unavailable)
+    {
+        try
+        {
+            cache_watch = std::make_unique<DeviceWatch>();
+        }
+        catch (const common::OSException &)
+        {
+            // no inotify, every call scans
+            watch_unavailable = true;
+        }
+    }
+
+    if (!cache_watch || !cache_watch->drain().empty())
+    {
+        cache_valid = false;
+    }
+
+    if (refresh || !cache_valid)
+    {
+        if (cache_watch)
+        {
+            // before scanning so that no change is missed, directories created
+            // later are seen by their watched parent and added on the next scan
+            for (const char *directory : {"/dev", "/dev/serial", "/dev/serial/by-id", "/dev/serial/by-path"})
+            {
+                cache_watch->watch(directory);
+            }
+        }
+
+        cache = scan();
+        cache_valid = true;
+    }
+
+    return cache;
+}
+
+#endif
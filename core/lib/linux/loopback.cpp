@@ -0,0 +1,401 @@
+#ifdef LINUX
+
+#include <linux/loopback.h>
+
+#include <pty.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <string.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <chrono>
+#include <cmath>
+
+// stop reading from a side while this much data is waiting for the peer
+#define LOOPBACK_PENDING_LIMIT 65536
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+namespace
+{
+    uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+Loopback::Loopback(const LoopbackOptions &options)
+    : options(options), rng(options.seed), uniform(0.0, 1.0), epoll_fd(-1), notify_fd(-1), _is_open(false),
+      forwarded(0), dropped(0), corrupted(0) {}
+
+Loopback::~Loopback()
+{
+    close();
+}
+
+Loopback::Pty Loopback::openPty()
+{
+    Pty pty;
+    char name[128];
+
+    if (openpty(&pty.master_fd, &pty.slave_fd, name, nullptr, nullptr) != 0)
+    {
+        perror("openpty");
+        throw common::OSException("open loopback pty failure");
+    }
+
+    // raw until a SerialPort opens the slave and configures it
+    struct termios tty;
+    if (tcgetattr(pty.slave_fd, &tty) == 0)
+    {
+        cfmakeraw(&tty);
+        tcsetattr(pty.slave_fd, TCSANOW, &tty);
+    }
+
+    fcntl(pty.master_fd, F_SETFL, fcntl(pty.master_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(pty.master_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(pty.slave_fd, F_SETFD, FD_CLOEXEC);
+
+    pty.path = name;
+    pty.events = EPOLLIN;
+
+    return pty;
+}
+
+std::vector<LoopbackPair> Loopback::open(size_t count)
+{
+    if (_is_open)
+    {
+        throw common::SerialPortException("loopback is already open");
+    }
+
+    std::vector<LoopbackPair> pairs;
+
+    try
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            ptys.push_back(openPty());
+            ptys.push_back(openPty());
+
+            pairs.push_back({ptys[ptys.size() - 2].path, ptys.back().path});
+        }
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (epoll_fd == -1 || notify_fd == -1)
+        {
+            throw common::OSException("open loopback failure");
+        }
+
+        struct epoll_event evt;
+        evt.events = EPOLLIN;
+        evt.data.u64 = UINT64_MAX;
+
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, notify_fd, &evt) == -1)
+        {
+            throw common::OSException("open loopback failure");
+        }
+
+        uint64_t now = now_ns();
+
+        // direction k forwards from ptys[k] to its peer ptys[k ^ 1]
+        for (size_t k = 0; k < ptys.size(); k++)
+        {
+            directions.push_back({ptys[k].master_fd, ptys[k ^ 1].master_fd, std::string(), 0, now, false});
+
+            evt.events = EPOLLIN;
+            evt.data.u64 = k;
+
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ptys[k].master_fd, &evt) == -1)
+            {
+                throw common::OSException("open loopback failure");
+            }
+        }
+    }
+    catch (...)
+    {
+        _is_open = true;
+        close();
+        throw;
+    }
+
+    _is_open = true;
+
+    pumpThread = std::thread(&Loopback::pumpWorker, this);
+
+    return pairs;
+}
+
+void Loopback::close()
+{
+    if (!_is_open)
+    {
+        return;
+    }
+
+    if (pumpThread.joinable())
+    {
+        uint64_t notify_val = 1;
+        ::write(notify_fd, &notify_val, sizeof(notify_val));
+
+        pumpThread.join();
+    }
+
+    for (auto &pty : ptys)
+    {
+        ::close(pty.master_fd);
+        ::close(pty.slave_fd);
+    }
+
+    ptys.clear();
+    directions.clear();
+
+    if (notify_fd != -1)
+    {
+        ::close(notify_fd);
+        notify_fd = -1;
+    }
+
+    if (epoll_fd != -1)
+    {
+        ::close(epoll_fd);
+        epoll_fd = -1;
+    }
+
+    _is_open = false;
+}
+
+bool Loopback::is_open()
+{
+    return _is_open;
+}
+
+LoopbackStats Loopback::stats()
+{
+    LoopbackStats s;
+    s.forwarded = forwarded;
+    s.dropped = dropped;
+    s.corrupted = corrupted;
+    return s;
+}
+
+void Loopback::fill(Direction &dir)
+{
+    char buffer[4096];
+
+    while (dir.pending.size() < LOOPBACK_PENDING_LIMIT)
+    {
+        ssize_t n = ::read(dir.src, buffer, sizeof(buffer));
+
+        if (n <= 0)
+        {
+            // EAGAIN, or EIO while no one holds the slave open
+            break;
+        }
+
+        if (options.drop_rate > 0 && uniform(rng) < options.drop_rate)
+        {
+            dropped += n;
+            continue;
+        }
+
+        if (options.corrupt_rate > 0)
+        {
+            for (ssize_t i = 0; i < n; i++)
+            {
+                if (uniform(rng) < options.corrupt_rate)
+                {
+                    buffer[i] ^= static_cast<char>(1 << (rng() % 8));
+                    corrupted++;
+                }
+            }
+        }
+
+        dir.pending.append(buffer, n);
+    }
+}
+
+void Loopback::flush(Direction &dir, uint64_t now)
+{
+    double rate = options.baudrate / static_cast<double>(options.bits_per_char ? options.bits_per_char : 10);
+
+    if (rate > 0)
+    {
+        // token bucket, allowing a burst of about 5ms of line time
+        double burst = std::max(1.0, rate * 0.005);
+
+        dir.tokens = std::min(burst, dir.tokens + rate * (now - dir.last_refill) / 1e9);
+    }
+
+    dir.last_refill = now;
+    dir.blocked = false;
+
+    size_t offset = 0;
+
+    while (offset < dir.pending.size())
+    {
+        size_t n = dir.pending.size() - offset;
+
+        if (rate > 0)
+        {
+            n = std::min(n, static_cast<size_t>(dir.tokens));
+        }
+
+        if (options.chunk_size > 0)
+        {
+            n = std::min(n, options.chunk_size);
+        }
+
+        if (n == 0)
+        {
+            break;
+        }
+
+        ssize_t written = ::write(dir.dst, dir.pending.data() + offset, n);
+
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                dir.blocked = true;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        offset += written;
+        forwarded += written;
+
+        if (rate > 0)
+        {
+            dir.tokens -= written;
+        }
+    }
+
+    dir.pending.erase(0, offset);
+}
+
+void Loopback::updateEvents(size_t k)
+{
+    struct epoll_event evt;
+    evt.events = 0;
+    evt.data.u64 = k;
+
+    if (directions[k].pending.size() < LOOPBACK_PENDING_LIMIT)
+    {
+        evt.events |= EPOLLIN;
+    }
+
+    if (directions[k ^ 1].blocked)
+    {
+        evt.events |= EPOLLOUT;
+    }
+
+    if (evt.events == ptys[k].events)
+    {
+        return;
+    }
+
+    ptys[k].events = evt.events;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, ptys[k].master_fd, &evt);
+}
+
+int Loopback::nextTimeout(uint64_t now)
+{
+    double rate = options.baudrate / static_cast<double>(options.bits_per_char ? options.bits_per_char : 10);
+
+    if (rate <= 0)
+    {
+        return -1;
+    }
+
+    double wait = -1;
+
+    for (auto &dir : directions)
+    {
+        if (dir.pending.empty() || dir.blocked)
+        {
+            continue;
+        }
+
+        double tokens = dir.tokens + rate * (now - dir.last_refill) / 1e9;
+        double needed = std::max(0.0, 1.0 - tokens) / rate;
+
+        if (wait < 0 || needed < wait)
+        {
+            wait = needed;
+        }
+    }
+
+    if (wait < 0)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(std::ceil(wait * 1000));
+}
+
+void Loopback::pumpWorker()
+{
+    struct epoll_event evts[LOOPBACK_MAX_EVENTS];
+
+    while (true)
+    {
+        int n = epoll_wait(epoll_fd, evts, LOOPBACK_MAX_EVENTS, nextTimeout(now_ns()));
+
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("loopback epoll_wait");
+            return;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            if (evts[i].data.u64 == UINT64_MAX)
+            {
+                return;
+            }
+
+            size_t k = evts[i].data.u64;
+
+            if (evts[i].events & EPOLLIN)
+            {
+                fill(directions[k]);
+            }
+        }
+
+        uint64_t now = now_ns();
+
+        for (size_t k = 0; k < directions.size(); k++)
+        {
+            if (!directions[k].pending.empty())
+            {
+                flush(directions[k], now);
+            }
+        }
+
+        for (size_t k = 0; k < ptys.size(); k++)
+        {
+            updateEvents(k);
+        }
+    }
+}
+
+#endif
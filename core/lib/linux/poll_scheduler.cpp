@@ -0,0 +1,407 @@
+#ifdef LINUX
+
+#include <linux/poll_scheduler.h>
+#include <linux/serialport.h>
+#include <common/common.h>
+#include <common/exception.h>
+#include <common/trace.h>
+
+#include <limits>
+#include <chrono>
+#include <algorithm>
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+namespace trace = async_pyserial::common::trace;
+
+PollScheduler::Lane::Lane(const std::weak_ptr<PollScheduler> &scheduler, uint32_t index)
+    : scheduler(scheduler), index(index) {}
+
+void PollScheduler::Lane::onChunk(common::StreamDirection direction, uint64_t, const char *data, size_t size)
+{
+    if (direction != common::RX)
+    {
+        return;
+    }
+
+    if (auto current = scheduler.lock())
+    {
+        current->onReceive(index, data, size);
+    }
+}
+
+PollScheduler::PollScheduler(const Callback &callback, bool changes_only)
+    : callback(callback), changes_only(changes_only)
+{
+    thread = std::thread(&PollScheduler::run, this);
+}
+
+PollScheduler::~PollScheduler()
+{
+    close();
+}
+
+uint32_t PollScheduler::add(SerialPort *port, const std::string &request, const PollMatcher &matcher, uint64_t period_ns, uint64_t timeout_ns)
+{
+    if (matcher.terminator.empty() && matcher.length == 0)
+    {
+        throw common::SerialPortException("a poll needs a response length or terminator");
+    }
+
+    std::shared_ptr<Lane> added;
+    std::vector<Send> sends;
+    uint32_t index;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (closing)
+        {
+            throw common::SerialPortException("poll scheduler is closed");
+        }
+
+        auto lane = std::find_if(lanes.begin(), lanes.end(), [port](const LaneState &state)
+                                 { return state.port == port; });
+
+        if (lane == lanes.end())
+        {
+            LaneState state;
+            state.port = port;
+            state.sink = std::make_shared<Lane>(weak_from_this(), static_cast<uint32_t>(lanes.size()));
+
+            added = state.sink;
+            lanes.push_back(std::move(state));
+            lane = lanes.end() - 1;
+        }
+
+        uint64_t now = common::monotonic_ns();
+
+        Entry entry;
+        entry.lane = static_cast<uint32_t>(lane - lanes.begin());
+        entry.request = request;
+        entry.matcher = matcher;
+        entry.matcher.max_bytes = std::max<size_t>({matcher.max_bytes, matcher.length, matcher.terminator.size()});
+        entry.period_ns = period_ns;
+        entry.timeout_ns = timeout_ns;
+        entry.due = now;
+
+        index = static_cast<uint32_t>(entries.size());
+
+        entries.push_back(std::move(entry));
+        lane->entries.push_back(index);
+
+        wakeBy(startNext(entries[index].lane, now, sends));
+    }
+
+    // before the first request, so its response is seen
+    if (added)
+    {
+        port->addSink(added);
+    }
+
+    send(sends);
+
+    return index;
+}
+
+void PollScheduler::close()
+{
+    std::vector<LaneState> closed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (closing)
+        {
+            return;
+        }
+
+        closing = true;
+
+        cv.notify_one();
+
+        closed.swap(lanes);
+    }
+
+    for (auto &lane : closed)
+    {
+        lane.port->removeSink(lane.sink);
+    }
+
+    if (thread.joinable() && std::this_thread::get_id() != thread.get_id())
+    {
+        thread.join();
+    }
+}
+
+PollStats PollScheduler::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return counters;
+}
+
+void PollScheduler::onReceive(uint32_t index, const char *data, size_t size)
+{
+    std::vector<Send> sends;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (closing)
+        {
+            return;
+        }
+
+        LaneState &lane = lanes[index];
+
+        if (lane.active < 0 || lane.write_failed)
+        {
+            counters.unsolicited += size;
+            return;
+        }
+
+        const PollMatcher &matcher = entries[lane.active].matcher;
+
+        size_t scanned = lane.response.size();
+
+        lane.response.append(data, size);
+
+        PollStatus status = POLL_OK;
+        size_t end;
+
+        if (!matcher.terminator.empty())
+        {
+            // the terminator may have started in an earlier chunk
+            size_t from = scanned >= matcher.terminator.size() ? scanned - matcher.terminator.size() + 1 : 0;
+            size_t found = lane.response.find(matcher.terminator, from);
+
+            if (found != std::string::npos)
+            {
+                end = found + matcher.terminator.size();
+            }
+            else if (lane.response.size() >= matcher.max_bytes)
+            {
+                end = matcher.max_bytes;
+                status = POLL_OVERFLOW;
+            }
+            else
+            {
+                return;
+            }
+        }
+        else if (lane.response.size() >= matcher.length)
+        {
+            end = matcher.length;
+        }
+        else
+        {
+            return;
+        }
+
+        // what follows the end belongs to no request
+        if (lane.response.size() > end)
+        {
+            counters.unsolicited += lane.response.size() - end;
+            lane.response.resize(end);
+        }
+
+        finish(index, status, common::monotonic_ns(), sends);
+    }
+
+    send(sends);
+}
+
+void PollScheduler::written(uint32_t index, uint32_t generation, unsigned long err)
+{
+    if (err == common::SUCCESS)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (closing)
+    {
+        return;
+    }
+
+    LaneState &lane = lanes[index];
+
+    // the lane is held until the timeout, so a closed or lost port is not spun on
+    if (lane.active >= 0 && lane.generation == generation)
+    {
+        lane.write_failed = true;
+    }
+}
+
+uint64_t PollScheduler::startNext(uint32_t index, uint64_t now, std::vector<Send> &sends)
+{
+    LaneState &lane = lanes[index];
+
+    if (lane.active >= 0)
+    {
+        return lane.deadline;
+    }
+
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+    size_t count = lane.entries.size();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t position = (lane.cursor + i) % count;
+        Entry &entry = entries[lane.entries[position]];
+
+        if (entry.due > now)
+        {
+            next = std::min(next, entry.due);
+            continue;
+        }
+
+        lane.cursor = (position + 1) % count;
+        lane.active = lane.entries[position];
+        lane.generation++;
+        lane.sent_at = now;
+        lane.deadline = now + entry.timeout_ns;
+        lane.write_failed = false;
+        lane.response.clear();
+
+        counters.requests++;
+
+        sends.push_back({index, lane.generation, &entry.request});
+
+        return lane.deadline;
+    }
+
+    return next;
+}
+
+void PollScheduler::finish(uint32_t index, PollStatus status, uint64_t now, std::vector<Send> &sends)
+{
+    LaneState &lane = lanes[index];
+    Entry &entry = entries[lane.active];
+
+    if (status == POLL_OK)
+    {
+        counters.responses++;
+    }
+    else if (status == POLL_TIMEOUT)
+    {
+        counters.timeouts++;
+    }
+    else
+    {
+        counters.errors++;
+    }
+
+    // a late entry is polled once, not once per period it missed
+    entry.due = std::max(entry.due + entry.period_ns, now);
+
+    if (changes_only && entry.reported && entry.last_status == status && entry.last_response == lane.response)
+    {
+        counters.suppressed++;
+    }
+    else
+    {
+        entry.reported = true;
+        entry.last_status = status;
+        entry.last_response = lane.response;
+
+        callback({static_cast<uint32_t>(lane.active), status, std::move(lane.response), now - lane.sent_at});
+    }
+
+    lane.active = -1;
+    lane.response.clear();
+
+    wakeBy(startNext(index, now, sends));
+}
+
+void PollScheduler::wakeBy(uint64_t deadline)
+{
+    if (deadline < wake_at)
+    {
+        wake_at = deadline;
+        cv.notify_one();
+    }
+}
+
+void PollScheduler::send(const std::vector<Send> &sends)
+{
+    std::weak_ptr<PollScheduler> self = weak_from_this();
+
+    for (auto &request : sends)
+    {
+        SerialPort *port;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (closing)
+            {
+                return;
+            }
+
+            port = lanes[request.lane].port;
+        }
+
+        uint32_t lane = request.lane;
+        uint32_t generation = request.generation;
+
+        port->write(request.request->data(), request.request->size(), [self, lane, generation](unsigned long err)
+                    {
+            if (auto current = self.lock()) {
+                current->written(lane, generation, err);
+            } });
+    }
+}
+
+void PollScheduler::run()
+{
+    trace::set_thread_name("poll scheduler");
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!closing)
+    {
+        uint64_t now = common::monotonic_ns();
+        uint64_t next = std::numeric_limits<uint64_t>::max();
+
+        std::vector<Send> sends;
+
+        for (uint32_t index = 0; index < lanes.size(); index++)
+        {
+            LaneState &lane = lanes[index];
+
+            if (lane.active >= 0 && lane.deadline <= now)
+            {
+                finish(index, lane.write_failed ? POLL_WRITE_ERROR : POLL_TIMEOUT, now, sends);
+            }
+
+            next = std::min(next, startNext(index, now, sends));
+        }
+
+        if (!sends.empty())
+        {
+            lock.unlock();
+
+            send(sends);
+
+            lock.lock();
+            continue;
+        }
+
+        wake_at = next;
+
+        if (next == std::numeric_limits<uint64_t>::max())
+        {
+            cv.wait(lock);
+        }
+        else
+        {
+            cv.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(next)));
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,417 @@
+#ifdef LINUX
+
+#include <linux/replay.h>
+
+#include <pty.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#include <any>
+
+// max records delivered before polling the reactor again
+#define REPLAY_DELIVERY_BUDGET 256
+
+#define REPLAY_NOTIFY_TAG UINT64_MAX
+#define REPLAY_TIMER_TAG (UINT64_MAX - 1)
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+Replayer::Replayer() : _active(0), epoll_fd(-1), notify_fd(-1), timer_fd(-1), running(false)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (epoll_fd == -1 || notify_fd == -1 || timer_fd == -1)
+    {
+        if (epoll_fd != -1) ::close(epoll_fd);
+        if (notify_fd != -1) ::close(notify_fd);
+        if (timer_fd != -1) ::close(timer_fd);
+
+        throw common::OSException("create replayer failure");
+    }
+
+    struct epoll_event evt;
+    evt.events = EPOLLIN;
+
+    evt.data.u64 = REPLAY_NOTIFY_TAG;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, notify_fd, &evt);
+
+    evt.data.u64 = REPLAY_TIMER_TAG;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &evt);
+}
+
+Replayer::~Replayer()
+{
+    stop();
+
+    for (auto *list : {&sessions, &incoming})
+    {
+        for (auto &session : *list)
+        {
+            if (session->master_fd != -1) ::close(session->master_fd);
+            if (session->slave_fd != -1) ::close(session->slave_fd);
+        }
+    }
+
+    ::close(timer_fd);
+    ::close(notify_fd);
+    ::close(epoll_fd);
+}
+
+std::string Replayer::addPty(const std::string &path, const ReplayOptions &options)
+{
+    auto session = std::make_unique<Session>();
+    session->reader = std::make_unique<common::RecordReader>(path);
+    session->options = options;
+
+    char name[128];
+
+    if (openpty(&session->master_fd, &session->slave_fd, name, nullptr, nullptr) != 0)
+    {
+        throw common::OSException("open replay pty failure");
+    }
+
+    struct termios tty;
+    if (tcgetattr(session->slave_fd, &tty) == 0)
+    {
+        cfmakeraw(&tty);
+        tcsetattr(session->slave_fd, TCSANOW, &tty);
+    }
+
+    fcntl(session->master_fd, F_SETFL, fcntl(session->master_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(session->master_fd, F_SETFD, FD_CLOEXEC);
+    fcntl(session->slave_fd, F_SETFD, FD_CLOEXEC);
+
+    addSession(std::move(session));
+
+    return name;
+}
+
+void Replayer::addEmitter(const std::string &path, const ReplayOptions &options, common::EventEmitter *emitter, common::EventType eventType)
+{
+    auto session = std::make_unique<Session>();
+    session->reader = std::make_unique<common::RecordReader>(path);
+    session->options = options;
+    session->emitter = emitter;
+    session->eventType = eventType;
+
+    addSession(std::move(session));
+}
+
+void Replayer::addSession(std::unique_ptr<Session> session)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    incoming.push_back(std::move(session));
+    _active++;
+
+    uint64_t notify_val = 1;
+    ::write(notify_fd, &notify_val, sizeof(notify_val));
+}
+
+void Replayer::start()
+{
+    if (running)
+    {
+        return;
+    }
+
+    running = true;
+
+    reactorThread = std::thread(&Replayer::reactorWorker, this);
+}
+
+void Replayer::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+
+    running = false;
+
+    uint64_t notify_val = 1;
+    ::write(notify_fd, &notify_val, sizeof(notify_val));
+
+    if (reactorThread.joinable())
+    {
+        reactorThread.join();
+    }
+}
+
+bool Replayer::is_running()
+{
+    return running;
+}
+
+size_t Replayer::active()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return _active;
+}
+
+bool Replayer::wait(long timeout_ms)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (timeout_ms < 0)
+    {
+        done_cv.wait(lock, [this]() { return _active == 0; });
+        return true;
+    }
+
+    return done_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return _active == 0; });
+}
+
+bool Replayer::loadNext(Session &session)
+{
+    bool rewound = false;
+
+    while (true)
+    {
+        if (!session.reader->next(session.header, session.data))
+        {
+            // nothing playable since the last rewind
+            if (!session.options.loop || rewound)
+            {
+                return false;
+            }
+
+            session.reader->rewind();
+            session.base_ts = 0;
+            rewound = true;
+            continue;
+        }
+
+        if (session.header.direction == common::TX && !session.options.include_tx)
+        {
+            continue;
+        }
+
+        if (session.base_ts == 0)
+        {
+            session.base_ts = session.header.ts_ns;
+            session.start_ns = common::monotonic_ns();
+        }
+
+        session.offset = 0;
+
+        return true;
+    }
+}
+
+uint64_t Replayer::dueTime(const Session &session)
+{
+    if (session.options.speed <= 0)
+    {
+        // as fast as possible, round robin with the other sessions
+        return common::monotonic_ns();
+    }
+
+    uint64_t elapsed = session.header.ts_ns >= session.base_ts ? session.header.ts_ns - session.base_ts : 0;
+
+    return session.start_ns + static_cast<uint64_t>(elapsed / session.options.speed);
+}
+
+void Replayer::activate(size_t index)
+{
+    Session &session = *sessions[index];
+
+    if (!loadNext(session))
+    {
+        finish(session);
+        return;
+    }
+
+    schedule.push({dueTime(session), index});
+}
+
+bool Replayer::deliver(size_t index)
+{
+    Session &session = *sessions[index];
+
+    if (session.emitter != nullptr)
+    {
+        std::vector<std::any> emitArgs = {session.data};
+
+        session.emitter->emit(session.eventType, emitArgs);
+
+        return true;
+    }
+
+    while (session.offset < session.data.size())
+    {
+        ssize_t written = ::write(session.master_fd, session.data.data() + session.offset, session.data.size() - session.offset);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // resume on EPOLLOUT, the session stays out of the schedule meanwhile
+                struct epoll_event evt;
+                evt.events = EPOLLOUT;
+                evt.data.u64 = index;
+                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, session.master_fd, &evt);
+            }
+            else
+            {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session.master_fd, nullptr);
+                finish(session);
+            }
+
+            return false;
+        }
+
+        session.offset += written;
+    }
+
+    return true;
+}
+
+void Replayer::finish(Session &session)
+{
+    if (session.done)
+    {
+        return;
+    }
+
+    session.done = true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    _active--;
+
+    done_cv.notify_all();
+}
+
+void Replayer::armTimer(uint64_t due)
+{
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = due / 1000000000ULL;
+    spec.it_value.tv_nsec = due % 1000000000ULL;
+
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void Replayer::reactorWorker()
+{
+    struct epoll_event evts[REPLAY_MAX_EVENTS];
+
+    while (running)
+    {
+        uint64_t now = common::monotonic_ns();
+        int budget = REPLAY_DELIVERY_BUDGET;
+
+        while (!schedule.empty() && schedule.top().first <= now && budget-- > 0)
+        {
+            size_t index = schedule.top().second;
+            schedule.pop();
+
+            Session &session = *sessions[index];
+
+            if (!deliver(index))
+            {
+                continue;
+            }
+
+            if (loadNext(session))
+            {
+                schedule.push({dueTime(session), index});
+            }
+            else
+            {
+                finish(session);
+            }
+        }
+
+        int timeout = -1;
+
+        if (!schedule.empty())
+        {
+            if (schedule.top().first <= common::monotonic_ns())
+            {
+                timeout = 0;
+            }
+            else
+            {
+                armTimer(schedule.top().first);
+            }
+        }
+
+        int n = epoll_wait(epoll_fd, evts, REPLAY_MAX_EVENTS, timeout);
+
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("replay epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            uint64_t tag = evts[i].data.u64;
+
+            if (tag == REPLAY_NOTIFY_TAG)
+            {
+                uint64_t val;
+                ::read(notify_fd, &val, sizeof(val));
+
+                std::vector<std::unique_ptr<Session>> added;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    added.swap(incoming);
+                }
+
+                for (auto &session : added)
+                {
+                    sessions.push_back(std::move(session));
+                    activate(sessions.size() - 1);
+                }
+            }
+            else if (tag == REPLAY_TIMER_TAG)
+            {
+                uint64_t expirations;
+                ::read(timer_fd, &expirations, sizeof(expirations));
+            }
+            else
+            {
+                Session &session = *sessions[tag];
+
+                if (session.done || !deliver(tag))
+                {
+                    continue;
+                }
+
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session.master_fd, nullptr);
+
+                if (loadNext(session))
+                {
+                    schedule.push({dueTime(session), tag});
+                }
+                else
+                {
+                    finish(session);
+                }
+            }
+        }
+    }
+}
+
+#endif
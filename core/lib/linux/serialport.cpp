@@ -12,17 +12,24 @@
 
 #include <common/util.h>
 #include <common/exception.h>
+#include <common/trace.h>
 #include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <pthread.h>
 
 #include <iostream>
-
-#define BUFFER_SIZE 1024
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <climits>
 
 using namespace async_pyserial;
 using namespace async_pyserial::internal;
+namespace trace = async_pyserial::common::trace;
 
 SerialPort::SerialPort(const std::wstring& portName, const base::SerialPortOptions& options)
-    : common::EventEmitter(), portName(portName), options(options), _is_open(false),serial_fd(-1), notify_fd(-1), running(false) {}
+    : common::EventEmitter(), portName(portName), options(options), notify_fd(-1), serial_fd(-1), epoll_fd(-1), uring_slot(-1), _is_open(false), running(false) {}
 
 SerialPort::~SerialPort() {
     close();
@@ -83,7 +90,9 @@ tcflag_t convert_byte_size(unsigned char byteSize) {
 }
 
 void SerialPort::open() {
-    serial_fd = ::open(common::wstring_to_string(portName).c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    std::string path = common::wstring_to_string(portName);
+
+    serial_fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
 
     if(serial_fd < 0) {
         perror("open filure");
@@ -93,13 +102,45 @@ void SerialPort::open() {
     }
 
     try {
-        configure(options.baudrate, options.bytesize, options.stopbits, options.parity);
+        configure(options.baudrate, options.bytesize, options.stopbits, options.parity, TCSANOW);
     } catch(std::exception& err) {
         ::close(serial_fd);
         serial_fd = -1;
         throw err;
     }
 
+    configureRS485();
+
+    try {
+        schedule = std::make_unique<WriteSchedule>();
+    } catch(const common::OSException &) {
+        ::close(serial_fd);
+        serial_fd = -1;
+        throw common::SerialPortException("open serial port failure");
+    }
+
+    connected = true;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+
+        stats = ReceiveStats();
+    }
+
+    icount_supported = true;
+    checkCounters(true);
+
+    char resolved[PATH_MAX];
+    device_path = realpath(path.c_str(), resolved) != nullptr ? resolved : path;
+
+    // supervision and the user-space RS-485 toggle live in the epoll worker
+    if(options.io_engine == IO_URING_ENGINE && !options.reconnect && rs485_active != RS485_USER && openUring()) {
+        trace::set_port_name(serial_fd, common::wstring_to_string(portName));
+
+        _is_open = true;
+        return;
+    }
+
     notify_fd = eventfd(0, EFD_NONBLOCK);
     if (notify_fd == -1) {
         throw std::runtime_error("Failed to create eventfd");
@@ -137,7 +178,7 @@ void SerialPort::open() {
         throw common::SerialPortException("open serial port failure");
     }
 
-    serial_evt.events = EPOLLIN;
+    serial_evt.events = serialEvents(false);
     serial_evt.data.fd = serial_fd;
 
     if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, serial_fd, &serial_evt) == -1) {
@@ -158,12 +199,88 @@ void SerialPort::open() {
         throw common::SerialPortException("open serial port failure");
     }
 
+    struct epoll_event schedule_evt;
+    schedule_evt.events = EPOLLIN;
+    schedule_evt.data.fd = schedule->fd();
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, schedule->fd(), &schedule_evt) == -1) {
+        perror("epoll_ctl");
+
+        ::close(notify_fd);
+
+        notify_fd = -1;
+
+        ::close(serial_fd);
+
+        serial_fd = -1;
+
+        ::close(epoll_fd);
+
+        epoll_fd = -1;
+
+        schedule.reset();
+
+        throw common::SerialPortException("open serial port failure");
+    }
+
+    trace::set_port_name(serial_fd, common::wstring_to_string(portName));
+
     startEpollWorker();
 
     _is_open = true;
 }
 
-void SerialPort::configure(unsigned long baudRate, unsigned char byteSize, unsigned char stopBits, unsigned char parity) {
+bool SerialPort::openUring() {
+    try {
+        engine = UringEngine::shared(options.read_buffer_size);
+    } catch(const common::OSException& err) {
+        // io_uring is disabled or too old, keep using epoll
+        return false;
+    }
+
+    // io_uring would return EAGAIN instead of waiting for readiness on a non-blocking fd
+    fcntl(serial_fd, F_SETFL, fcntl(serial_fd, F_GETFL) & ~O_NONBLOCK);
+
+    running = true;
+
+    try {
+        uring_slot = engine->attach(this, serial_fd);
+    } catch(const common::OSException& err) {
+        // failed since shared() returned it, the epoll worker takes over
+        fcntl(serial_fd, F_SETFL, fcntl(serial_fd, F_GETFL) | O_NONBLOCK);
+
+        running = false;
+        engine.reset();
+
+        return false;
+    }
+
+    // the last port opened with thread options decides them for the shared engine thread
+    worker_status = applyThreadOptions(engine->native_handle(), options, "serial:uring");
+
+    return true;
+}
+
+IOEngine SerialPort::io_engine() {
+    return engine ? IO_URING_ENGINE : EPOLL_ENGINE;
+}
+
+ThreadStatus SerialPort::thread_status() {
+    return worker_status;
+}
+
+std::string SerialPort::threadName() {
+    std::string device = common::wstring_to_string(portName);
+
+    size_t pos = device.find_last_of('/');
+    if(pos != std::string::npos) {
+        device = device.substr(pos + 1);
+    }
+
+    return "serial:" + device;
+}
+
+void SerialPort::configure(unsigned long baudRate, unsigned char byteSize, unsigned char stopBits, unsigned char parity, int action) {
     struct termios tty;
     if (tcgetattr(serial_fd, &tty) != 0) {
         perror("tcgetattr");
@@ -205,18 +322,265 @@ void SerialPort::configure(unsigned long baudRate, unsigned char byteSize, unsig
 
     tty.c_cflag &= ~CRTSCTS; // 禁用硬件流控制
 
-    if (tcsetattr(serial_fd, TCSANOW, &tty) != 0) {
+    if (tcsetattr(serial_fd, action, &tty) != 0) {
         throw common::SerialPortException("configure serial port failure");
     }
+
+    // start bit, data bits, parity bit and stop bits
+    uint64_t bits = 1 + byteSize + (parity == 0 ? 0 : 1) + stopBits;
+
+    char_ns = bits * 1000000000ULL / std::max<unsigned long>(baudRate, 1);
+}
+
+void SerialPort::configureRS485() {
+    rs485_active = RS485_OFF;
+    transmitting = false;
+    echo.clear();
+    echo_offset = 0;
+
+    if(options.rs485 == RS485_OFF) {
+        return;
+    }
+
+    if(options.rs485 == RS485_KERNEL) {
+        struct serial_rs485 rs485 = {};
+
+        rs485.flags = SER_RS485_ENABLED | (options.rs485_rts_on_send ? SER_RS485_RTS_ON_SEND : SER_RS485_RTS_AFTER_SEND);
+        rs485.delay_rts_before_send = options.rs485_delay_before_send;
+        rs485.delay_rts_after_send = options.rs485_delay_after_send;
+
+        if(ioctl(serial_fd, TIOCSRS485, &rs485) == 0) {
+            rs485_active = RS485_KERNEL;
+            return;
+        }
+    }
+
+    // the driver has no RS-485 mode (ENOTTY, EINVAL), the worker toggles RTS around each transmission
+    rs485_active = RS485_USER;
+
+    setDriverEnable(false);
+}
+
+RS485Mode SerialPort::rs485_mode() {
+    return rs485_active;
+}
+
+static void sleepUntil(uint64_t deadline) {
+    struct timespec ts;
+
+    ts.tv_sec = deadline / 1000000000ULL;
+    ts.tv_nsec = deadline % 1000000000ULL;
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+}
+
+void SerialPort::setDriverEnable(bool sending) {
+    int bits = TIOCM_RTS;
+
+    // ptys and adapters without modem lines fail, nothing to toggle then
+    ioctl(serial_fd, sending == options.rs485_rts_on_send ? TIOCMBIS : TIOCMBIC, &bits);
+}
+
+void SerialPort::beginTransmit() {
+    setDriverEnable(true);
+
+    if(options.rs485_delay_before_send > 0) {
+        sleepUntil(common::monotonic_ns() + options.rs485_delay_before_send * 1000000ULL);
+    }
+
+    transmitting = true;
+}
+
+void SerialPort::endTransmit() {
+    uint64_t character = char_ns;
+    uint64_t now = common::monotonic_ns();
+    // a stalled line (e.g. flow control) releases the bus after write_timeout
+    uint64_t limit = 0;
+
+    int pending = 0;
+
+    while(ioctl(serial_fd, TIOCOUTQ, &pending) == 0 && pending > 0) {
+        if(limit == 0) {
+            limit = now + pending * character + options.write_timeout * 1000000ULL;
+        }
+
+        if(now >= limit) {
+            break;
+        }
+
+        // the driver sends about one byte per character time
+        now = std::min(now + pending * character, limit);
+
+        sleepUntil(now);
+    }
+
+    // the last byte left the buffer, not yet the shift register
+    sleepUntil(common::monotonic_ns() + character + options.rs485_delay_after_send * 1000000ULL);
+
+    setDriverEnable(false);
+
+    transmitting = false;
+}
+
+void SerialPort::recordEcho(const char *data, size_t size) {
+    // echoes which never came, e.g. a transceiver with its receiver disabled while sending
+    if(echo.size() - echo_offset + size > RS485_ECHO_LIMIT) {
+        echo.clear();
+        echo_offset = 0;
+    }
+
+    echo.append(data, size);
+}
+
+size_t SerialPort::skipEcho(const char *data, size_t size) {
+    size_t matched = 0;
+
+    while(matched < size && echo_offset < echo.size() && data[matched] == echo[echo_offset]) {
+        matched++;
+        echo_offset++;
+    }
+
+    // a mismatch means the echo was lost or garbled (e.g. a collision), the rest is received data
+    if(echo_offset == echo.size() || matched < size) {
+        echo.clear();
+        echo_offset = 0;
+    }
+
+    return matched;
+}
+
+void SerialPort::reconfigure(const base::SerialPortOptions &newOptions, ReconfigureMode mode) {
+    if(!is_open() || !running) {
+        throw common::SerialPortException("serial port is not open");
+    }
+
+    if(!is_connected()) {
+        throw common::SerialPortException("serial port is disconnected");
+    }
+
+    if(mode == RECONFIGURE_NOW) {
+        // not in the middle of a batch of epoll writes
+        std::lock_guard<std::mutex> lock(w_mutex);
+
+        configure(newOptions.baudrate, newOptions.bytesize, newOptions.stopbits, newOptions.parity, TCSANOW);
+    } else {
+        struct Barrier {
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool reached = false;
+            unsigned long result = common::SUCCESS;
+        };
+
+        // the barrier is reached by the thread that would be waiting for it
+        if(onIOThread()) {
+            throw common::SerialPortException("reconfigure with DRAIN cannot be called from the I/O thread");
+        }
+
+        auto barrier = std::make_shared<Barrier>();
+
+        {
+            std::lock_guard<std::mutex> lock(w_mutex);
+
+            // the writes submitted before the call are drained first
+            takeSubmissions();
+
+            IOEvent &io_evt = w_queue.emplace_back();
+
+            io_evt.barrier = true;
+            io_evt.callback = [barrier](unsigned long result) {
+                std::lock_guard<std::mutex> lock(barrier->mutex);
+
+                if(!barrier->reached) {
+                    barrier->reached = true;
+                    barrier->result = result;
+
+                    barrier->cv.notify_all();
+                }
+            };
+
+            if(w_queue.size() == 1) {
+                // nothing is queued before us
+                w_queue.front().callback(common::SUCCESS);
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(barrier->mutex);
+
+            barrier->cv.wait(lock, [&barrier] { return barrier->reached; });
+        }
+
+        if(barrier->result != common::SUCCESS) {
+            // the queue was failed by a write error or close(), the barrier is gone with it
+            throw common::SerialPortException("reconfigure serial port failure");
+        }
+
+        // writing is parked at the barrier, TCSADRAIN waits for the driver to transmit what was written before it
+        std::exception_ptr error;
+
+        try {
+            configure(newOptions.baudrate, newOptions.bytesize, newOptions.stopbits, newOptions.parity, TCSADRAIN);
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(w_mutex);
+
+            if(!w_queue.empty() && w_queue.front().barrier) {
+                w_queue.pop_front();
+            }
+
+            if(!w_queue.empty()) {
+                resumeWrites();
+            }
+        }
+
+        if(error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // read by a reconnect on the worker, and written by a reconfigure() from a callback
+    std::lock_guard<std::mutex> lock(w_mutex);
+
+    options.baudrate = newOptions.baudrate;
+    options.bytesize = newOptions.bytesize;
+    options.stopbits = newOptions.stopbits;
+    options.parity = newOptions.parity;
+}
+
+void SerialPort::resumeWrites() {
+    if(w_queue.front().barrier) {
+        // parked at the next reconfigure()
+        w_queue.front().callback(common::SUCCESS);
+        return;
+    }
+
+    if(engine) {
+        engine->kick(uring_slot);
+        return;
+    }
+
+    serial_evt.events = serialEvents(true);
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
 }
 
 void SerialPort::epollWorker() {
     struct epoll_event epoll_evts[EPOLL_MAX_EVENTS];
 
-    char buffer[BUFFER_SIZE];
+    std::string chunk;
+
+    // write callbacks of one wakeup, called without w_mutex
+    std::vector<std::pair<WriteCallback, unsigned long>> completed;
+
+    trace::set_thread_name("epoll worker " + common::wstring_to_string(portName));
 
     while(running) {
-        int n = epoll_wait(epoll_fd, epoll_evts, EPOLL_MAX_EVENTS, -1);
+        int n = epoll_wait(epoll_fd, epoll_evts, EPOLL_MAX_EVENTS, workerTimeout());
+
+        ASYNC_PYSERIAL_TRACE(trace::EPOLL_WAKEUP, trace::INSTANT, serial_fd, n);
 
         if(n == -1) {
             if (errno == EINTR) {
@@ -230,47 +594,116 @@ void SerialPort::epollWorker() {
 
         bool write_failure = false;
         bool is_write_call = false;
+        bool device_lost = false;
 
         for(int i = 0; i < n; i++) {
             auto evt = epoll_evts[i];
 
             if(evt.data.fd == notify_fd) {
-                ::read(notify_fd, buffer, BUFFER_SIZE);
-                goto exit;
-            }
+                uint64_t notify_val;
+                ::read(notify_fd, &notify_val, sizeof(notify_val));
 
-            if(evt.events & EPOLLIN) {
+                if(!running) {
+                    goto exit;
+                }
+
+                // woken by write() for new submissions
+                std::lock_guard<std::mutex> lock(w_mutex);
+
+                if(takeSubmissions()) {
+                    // a writer is still filling its slot, come back once it is published
+                    wakeWriter();
+                }
+
+                if(!connected) {
+                    if(options.reconnect_write_policy != RECONNECT_BUFFER_WRITES) {
+                        // submitted while the device was lost
+                        while(w_queue.size() > 0) {
+                            completed.emplace_back(std::move(w_queue.front().callback), common::FAILURE);
+
+                            w_queue.pop_front();
+                        }
+                    }
+                } else if(!w_queue.empty() && !w_queue.front().barrier) {
+                    serial_evt.events = serialEvents(true);
+
+                    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+                }
 
-                int bytes_read = ::read(evt.data.fd, buffer, BUFFER_SIZE);
+                continue;
+            }
 
-                if(bytes_read > 0) {
-                    std::string buffer2send(buffer, buffer + bytes_read);
+            if(evt.data.fd == schedule->fd()) {
+                fireSchedule();
+                continue;
+            }
 
-                    std::vector<std::any> emitArgs = { buffer2send };
+            if(device_watch && evt.data.fd == device_watch->fd()) {
+                device_watch->drain();
 
-                    emit(SerialPortEvent::ON_DATA, emitArgs);
+                if(!connected) {
+                    tryReconnect(false);
                 }
 
-                
+                continue;
+            }
+
+            if(!connected) {
+                continue;
+            }
+
+            if(evt.events & EPOLLIN) {
+                device_lost = !drainRead(chunk);
+
+                if(!chunk.empty()) {
+                    onReceive(chunk.data(), chunk.size());
+                }
             } else if(!write_failure && evt.events & EPOLLOUT) {
+                // EPOLLOUT is removed below, and the bus released, when there is nothing to write
+                is_write_call = true;
+
                 std::unique_lock<std::mutex> lock(w_mutex);
 
-                while(w_queue.size() > 0) {
-                    is_write_call = true;
+                // only for a write about to be sent, without w_mutex so write() and the other callers do not
+                // wait out rs485_delay_before_send, nothing but this worker takes the front write
+                if(rs485_active == RS485_USER && !transmitting && !w_queue.empty() && !w_queue.front().barrier) {
+                    lock.unlock();
+
+                    beginTransmit();
+
+                    lock.lock();
+                }
 
+                while(w_queue.size() > 0) {
                     auto& io_evt = w_queue.front();
 
-                    auto& data = io_evt.data;
+                    if(io_evt.barrier) {
+                        // reconfigure() takes over until the new settings are applied
+                        io_evt.callback(common::SUCCESS);
+                        break;
+                    }
+
+                    const char *data = io_evt.data();
 
-                    size_t bytes_to_write = data.size();
+                    size_t bytes_to_write = io_evt.size();
+                    size_t started = io_evt.bytes_written;
 
                     while (io_evt.bytes_written < bytes_to_write) {
-                        ssize_t bytes_written = ::write(serial_fd, data.c_str() + io_evt.bytes_written, bytes_to_write - io_evt.bytes_written);
+                        ASYNC_PYSERIAL_TRACE(trace::WRITE, trace::BEGIN, serial_fd, 0);
+
+                        ssize_t bytes_written = ::write(serial_fd, data + io_evt.bytes_written, bytes_to_write - io_evt.bytes_written);
+
+                        ASYNC_PYSERIAL_TRACE(trace::WRITE, trace::END, serial_fd, bytes_written > 0 ? bytes_written : 0);
 
                         if (bytes_written < 0) {
                             if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
                                 // Retry write if it was interrupted by a signal
                                 // or when Resource temporarily unavailable occure
+                                break;
+                            } else if (options.reconnect) {
+                                // the device is gone, the rest is written after reconnecting or failed by policy
+                                device_lost = true;
+
                                 break;
                             } else {
                                 // write failure
@@ -280,95 +713,558 @@ void SerialPort::epollWorker() {
                             }
                         }
                         
+                        if(has_sinks) {
+                            notifySinks(common::TX, data + io_evt.bytes_written, bytes_written);
+                        }
+
+                        if(options.rs485_suppress_echo) {
+                            recordEcho(data + io_evt.bytes_written, bytes_written);
+                        }
+
                         io_evt.bytes_written += bytes_written;
                     }
 
-                    auto& callback = io_evt.callback;
+                    if(io_evt.bytes_written < bytes_to_write) {
+                        // the allowance restarts whenever the driver takes some of it
+                        if(!write_failure && !device_lost && (write_deadline == 0 || io_evt.bytes_written > started)) {
+                            write_deadline = writeDeadline(bytes_to_write - io_evt.bytes_written);
+                        }
+
+                        // continue on the next EPOLLOUT, or fail below
+                        break;
+                    }
+
+                    write_deadline = 0;
 
-                    // maybe use other thread to process this callback in future
-                    callback(common::SUCCESS);
+                    ASYNC_PYSERIAL_TRACE(trace::WRITE_COMPLETE, trace::INSTANT, serial_fd, common::SUCCESS);
+
+                    // called once w_mutex is released, so callbacks may write again
+                    completed.emplace_back(std::move(io_evt.callback), common::SUCCESS);
 
                     // pop evt when write complete
                     w_queue.pop_front();
                 }
             } else if(evt.events & (EPOLLERR | EPOLLHUP)) {
                 fprintf(stderr, "Epoll error on fd %d\n", evt.data.fd);
-                
-                goto exit;
+
+                device_lost = true;
+            }
+
+            if(device_lost) {
+                break;
             }
         }
 
-        if(is_write_call) {
+        bool write_idle = false;
+        bool write_timed_out = write_deadline != 0 && connected && common::monotonic_ns() >= write_deadline;
+
+        if(is_write_call || write_timed_out) {
             std::unique_lock<std::mutex> lock(w_mutex);
 
             if(write_failure) {
                 // all writes are failure
                 while(w_queue.size() > 0) {
-                    auto& io_evt = w_queue.front();
-
-                    auto& callback = io_evt.callback;
-
-                    callback(common::FAILURE);
+                    completed.emplace_back(std::move(w_queue.front().callback), common::FAILURE);
 
                     w_queue.pop_front();
                 }
+            } else if(write_timed_out && !w_queue.empty() && !w_queue.front().barrier) {
+                // the driver took none of the front write in time, as on io_uring the writes behind it go on
+                ASYNC_PYSERIAL_TRACE(trace::WRITE_COMPLETE, trace::INSTANT, serial_fd, common::FAILURE);
+
+                completed.emplace_back(std::move(w_queue.front().callback), common::FAILURE);
+
+                w_queue.pop_front();
+
+                write_deadline = w_queue.empty() || w_queue.front().barrier ? 0 :
+                                 writeDeadline(w_queue.front().size() - w_queue.front().bytes_written);
             }
 
-            if(w_queue.size() == 0) {
-                // w_queue is empty
+            if(w_queue.size() == 0 || w_queue.front().barrier) {
+                // w_queue is empty or parked at a reconfigure barrier
                 // rm EPOLLOUT
-                serial_evt.events = EPOLLIN;
+                serial_evt.events = serialEvents(false);
 
                 epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+
+                write_idle = true;
+                write_deadline = 0;
+            }
+        }
+
+        // before the completions, so a write is complete once its last bit is sent and the bus released
+        if(transmitting && (write_idle || device_lost)) {
+            endTransmit();
+        }
+
+        for(auto& completion : completed) {
+            if(completion.first) {
+                completion.first(completion.second);
             }
         }
 
-        
+        completed.clear();
+
+        if(device_lost && !onDisconnect()) {
+            goto exit;
+        }
+
+        if(!connected && common::monotonic_ns() >= reconnect_at) {
+            tryReconnect(true);
+        }
     }
 
     exit:
 
+    // completed before the worker was stopped
+    for(auto& completion : completed) {
+        if(completion.first) {
+            completion.first(completion.second);
+        }
+    }
+
     running = false;
 
+    waitWriters();
+
     // clear w_queue
 
-    std::unique_lock<std::mutex> lock(w_mutex);
+    std::vector<WriteCallback> failed;
 
-    while(w_queue.size() > 0) {
-        auto& io_evt = w_queue.front();
+    {
+        std::lock_guard<std::mutex> lock(w_mutex);
 
-        auto& callback = io_evt.callback;
+        failed = takeQueued();
 
-        callback(common::FAILURE);
+        if(serial_fd != -1) {
+            serial_evt.events = serialEvents(false);
 
-        w_queue.pop_front();
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+        }
     }
 
-    serial_evt.events = EPOLLIN;
-
-    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+    for(auto& callback : failed) {
+        callback(common::FAILURE);
+    }
 }
 
-void SerialPort::startEpollWorker() {
-    if(running) {
-        return;
-    }
+void SerialPort::onEngineFailure() {
+    std::vector<WriteCallback> failed;
 
-    running = true;
+    // writes fail from now on, close() still detaches
+    running = false;
 
-    readThread = std::thread(&SerialPort::epollWorker, this);
-}
+    waitWriters();
 
-void SerialPort::stopEpollWorker() {
+    {
+        std::lock_guard<std::mutex> lock(w_mutex);
+
+        connected = false;
+
+        failed = takeQueued();
+    }
+
+    for(auto& callback : failed) {
+        callback(common::FAILURE);
+    }
+
+    emit(SerialPortEvent::ON_DISCONNECT, {});
+}
+
+bool SerialPort::onDisconnect() {
+    if(options.reconnect) {
+        std::vector<WriteCallback> failed;
+
+        {
+            std::lock_guard<std::mutex> lock(w_mutex);
+
+            connected = false;
+
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, serial_fd, nullptr);
+
+            trace::clear_port_name(serial_fd);
+
+            ::close(serial_fd);
+            serial_fd = -1;
+
+            takeSubmissions();
+
+            // buffered writes start over once reconnected
+            write_deadline = 0;
+
+            if(options.reconnect_write_policy != RECONNECT_BUFFER_WRITES) {
+                failed = takeQueued();
+            }
+        }
+
+        for(auto& callback : failed) {
+            callback(common::FAILURE);
+        }
+    }
+
+    emit(SerialPortEvent::ON_DISCONNECT, {});
+
+    if(!options.reconnect) {
+        return false;
+    }
+
+    if(!device_watch) {
+        try {
+            device_watch = std::make_unique<DeviceWatch>();
+
+            struct epoll_event watch_evt;
+            watch_evt.events = EPOLLIN;
+            watch_evt.data.fd = device_watch->fd();
+
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, device_watch->fd(), &watch_evt);
+        } catch(const common::OSException &) {
+            // no inotify, the scheduled retries still find the device
+        }
+    }
+
+    watchDevice();
+
+    reconnect_delay = std::max<unsigned long>(options.reconnect_interval, 1);
+    reconnect_at = common::monotonic_ns() + reconnect_delay * 1000000ULL;
+
+    return true;
+}
+
+void SerialPort::watchDevice() {
+    if(!device_watch) {
+        return;
+    }
+
+    std::string path = common::wstring_to_string(portName);
+
+    auto directory = [](const std::string &file) {
+        size_t pos = file.find_last_of('/');
+
+        return pos == std::string::npos ? std::string(".") : file.substr(0, std::max<size_t>(pos, 1));
+    };
+
+    // e.g. /dev/serial/by-id for the symlink and /dev for the node it pointed to
+    device_watch->watch(directory(path));
+    device_watch->watch("/dev");
+
+    if(!device_path.empty()) {
+        device_watch->watch(directory(device_path));
+    }
+}
+
+void SerialPort::tryReconnect(bool scheduled) {
+    std::string path = common::wstring_to_string(portName);
+
+    int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if(fd >= 0) {
+        std::lock_guard<std::mutex> lock(w_mutex);
+
+        serial_fd = fd;
+
+        try {
+            configure(options.baudrate, options.bytesize, options.stopbits, options.parity, TCSANOW);
+            configureRS485();
+
+            serial_evt.events = serialEvents(!w_queue.empty());
+            serial_evt.data.fd = serial_fd;
+
+            if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, serial_fd, &serial_evt) == -1) {
+                throw common::SerialPortException("open serial port failure");
+            }
+
+            connected = true;
+        } catch(const std::exception &) {
+            ::close(serial_fd);
+            serial_fd = -1;
+        }
+    }
+
+    if(connected) {
+        char resolved[PATH_MAX];
+
+        if(realpath(path.c_str(), resolved) != nullptr) {
+            device_path = resolved;
+        }
+
+        trace::set_port_name(serial_fd, path);
+
+        // stats keep counting, the counters of the new fd start from here
+        icount_supported = true;
+        checkCounters(true);
+
+        emit(SerialPortEvent::ON_RECONNECT, {});
+        return;
+    }
+
+    // directories which disappeared with the device may be back
+    watchDevice();
+
+    if(scheduled) {
+        reconnect_at = common::monotonic_ns() + reconnect_delay * 1000000ULL;
+        reconnect_delay = std::min<unsigned long>(reconnect_delay * 2, std::max(options.reconnect_max_interval, reconnect_delay));
+    }
+}
+
+int SerialPort::reconnectTimeout() {
+    if(connected) {
+        return -1;
+    }
+
+    uint64_t now = common::monotonic_ns();
+
+    if(now >= reconnect_at) {
+        return 0;
+    }
+
+    return static_cast<int>((reconnect_at - now + 999999) / 1000000);
+}
+
+int SerialPort::workerTimeout() {
+    int timeout = reconnectTimeout();
+
+    if(write_deadline == 0) {
+        return timeout;
+    }
+
+    uint64_t now = common::monotonic_ns();
+    int write_timeout = now >= write_deadline ? 0 : static_cast<int>((write_deadline - now + 999999) / 1000000);
+
+    return timeout == -1 ? write_timeout : std::min(timeout, write_timeout);
+}
+
+uint64_t SerialPort::writeDeadline(size_t bytes) {
+    if(options.write_timeout == 0) {
+        return 0;
+    }
+
+    int pending = 0;
+
+    if(ioctl(serial_fd, TIOCOUTQ, &pending) == -1) {
+        pending = 0;
+    }
+
+    // as endTransmit(), the driver sends what it holds first, one character time per byte
+    return common::monotonic_ns() + options.write_timeout * 1000000ULL + (static_cast<uint64_t>(pending) + bytes) * char_ns;
+}
+
+bool SerialPort::is_connected() {
+    return _is_open && connected;
+}
+
+void SerialPort::pause_reading(ReadPause reason) {
+    read_paused |= reason;
+
+    updateReading();
+}
+
+void SerialPort::resume_reading(ReadPause reason) {
+    read_paused &= static_cast<unsigned char>(~reason);
+
+    updateReading();
+}
+
+void SerialPort::updateReading() {
+    std::unique_lock<std::mutex> lock(w_mutex);
+
+    if(engine) {
+        lock.unlock();
+
+        engine->rearm(uring_slot);
+        return;
+    }
+
+    if(running && connected && serial_fd != -1) {
+        serial_evt.events = serialEvents(!w_queue.empty() && !w_queue.front().barrier);
+
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+    }
+}
+
+bool SerialPort::is_reading() {
+    return read_paused == 0;
+}
+
+ReceiveStats SerialPort::receive_stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+
+    return stats;
+}
+
+void SerialPort::reportDropped(size_t bytes) {
+    ReceiveStats increment;
+    increment.dropped = bytes;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+
+        stats.dropped += bytes;
+    }
+
+    emit(SerialPortEvent::ON_OVERFLOW, {increment});
+}
+
+void SerialPort::checkCounters(bool reset) {
+    if(!icount_supported) {
+        return;
+    }
+
+    uint64_t now = common::monotonic_ns();
+
+    if(!reset && now - icount_checked < ICOUNT_INTERVAL_NS) {
+        return;
+    }
+
+    icount_checked = now;
+
+    struct serial_icounter_struct current;
+
+    if(ioctl(serial_fd, TIOCGICOUNT, &current) == -1) {
+        // ptys and usb adapters without counters, checked again after reopening
+        icount_supported = false;
+        return;
+    }
+
+    if(reset) {
+        icount = current;
+        return;
+    }
+
+    // the driver counters are ints and may wrap
+    ReceiveStats increment;
+    increment.overrun = static_cast<unsigned int>(current.overrun - icount.overrun);
+    increment.buf_overrun = static_cast<unsigned int>(current.buf_overrun - icount.buf_overrun);
+    increment.frame = static_cast<unsigned int>(current.frame - icount.frame);
+    increment.parity = static_cast<unsigned int>(current.parity - icount.parity);
+    increment.brk = static_cast<unsigned int>(current.brk - icount.brk);
+
+    icount = current;
+
+    if(increment.overrun == 0 && increment.buf_overrun == 0 && increment.frame == 0 &&
+        increment.parity == 0 && increment.brk == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+
+        stats.overrun += increment.overrun;
+        stats.buf_overrun += increment.buf_overrun;
+        stats.frame += increment.frame;
+        stats.parity += increment.parity;
+        stats.brk += increment.brk;
+    }
+
+    emit(SerialPortEvent::ON_OVERFLOW, {increment});
+}
+
+uint32_t SerialPort::serialEvents(bool writing) {
+    uint32_t events = read_paused ? 0 : static_cast<uint32_t>(EPOLLIN);
+
+    return writing ? (events | EPOLLOUT) : events;
+}
+
+bool SerialPort::drainRead(std::string &chunk) {
+    size_t buffer_size = std::max<size_t>(options.read_buffer_size, 1);
+    size_t budget = std::max<size_t>(options.read_budget, buffer_size);
+
+    chunk.clear();
+
+    // read until the driver is drained or the budget is spent, so the other fds get their turn
+    while(chunk.size() < budget) {
+        int available = 0;
+
+        if(ioctl(serial_fd, FIONREAD, &available) == -1) {
+            available = 0;
+        }
+
+        size_t offset = chunk.size();
+        size_t request = std::min(std::max<size_t>(available, buffer_size), budget - offset);
+
+        chunk.resize(offset + request);
+
+        ASYNC_PYSERIAL_TRACE(trace::READ, trace::BEGIN, serial_fd, 0);
+
+        ssize_t bytes_read = ::read(serial_fd, &chunk[offset], request);
+        int read_errno = errno;
+
+        ASYNC_PYSERIAL_TRACE(trace::READ, trace::END, serial_fd, bytes_read > 0 ? bytes_read : 0);
+
+        if(bytes_read < 0 && read_errno == EINTR) {
+            chunk.resize(offset);
+            continue;
+        }
+
+        chunk.resize(offset + (bytes_read > 0 ? bytes_read : 0));
+
+        if(bytes_read == 0 || (bytes_read < 0 && read_errno != EAGAIN && read_errno != EWOULDBLOCK)) {
+            // hangup (EOF) or e.g. EIO from an unplugged usb adapter
+            return false;
+        }
+
+        // EAGAIN, or a short read which already emptied the driver
+        if(bytes_read < 0 || static_cast<size_t>(bytes_read) < request) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void SerialPort::onReceive(const char *data, size_t size) {
+    if(echo_offset < echo.size()) {
+        size_t skipped = skipEcho(data, size);
+
+        data += skipped;
+        size -= skipped;
+
+        if(size == 0) {
+            return;
+        }
+    }
+
+    checkCounters(false);
+
+    if(has_sinks) {
+        notifySinks(common::RX, data, size);
+    }
+
+    std::string buffer2send(data, data + size);
+
+    std::vector<std::any> emitArgs = { buffer2send };
+
+    ASYNC_PYSERIAL_TRACE(trace::EMIT, trace::BEGIN, serial_fd, size);
+
+    emit(SerialPortEvent::ON_DATA, emitArgs);
+
+    ASYNC_PYSERIAL_TRACE(trace::EMIT, trace::END, serial_fd, size);
+}
+
+void SerialPort::startEpollWorker() {
+    if(running) {
+        return;
+    }
+
+    running = true;
+
+    readThread = std::thread(&SerialPort::epollWorker, this);
+
+    worker_status = applyThreadOptions(readThread.native_handle(), options, threadName());
+}
+
+void SerialPort::stopEpollWorker() {
     if(!running) {
         return;
     }
 
+    // before waking the worker, which also wakes up for writes
+    running = false;
+
+    waitWriters();
+
     uint64_t notify_val = 1;
     ::write(notify_fd, &notify_val, sizeof(notify_val));
 
-    running = false;
-
     if(readThread.joinable()) {
         readThread.join();
     }
@@ -379,8 +1275,40 @@ bool SerialPort::is_open() {
 }
 
 void SerialPort::close() {
+    if(engine) {
+        running = false;
+
+        // until then a writer may kick the engine
+        waitWriters();
+
+        engine->detach(uring_slot);
+
+        engine.reset();
+        uring_slot = -1;
+
+        std::vector<WriteCallback> failed;
+
+        {
+            std::lock_guard<std::mutex> lock(w_mutex);
+
+            failed = takeQueued();
+        }
+
+        for(auto& callback : failed) {
+            callback(common::FAILURE);
+        }
+    }
+
     stopEpollWorker();
 
+    device_watch.reset();
+
+    if(schedule) {
+        // handles of the scheduled writes outlive it
+        schedule->clear();
+        schedule.reset();
+    }
+
     if(!_is_open) return;
 
     if(notify_fd != -1) {
@@ -391,6 +1319,9 @@ void SerialPort::close() {
 
     _is_open = false;
     if(serial_fd != -1) {
+        // the fd may be reused by another port
+        trace::clear_port_name(serial_fd);
+
         ::close(serial_fd);
 
         serial_fd = -1;
@@ -408,35 +1339,306 @@ void SerialPort::close() {
 }
 
 
-void SerialPort::write(const std::string &data, const std::function<void(unsigned long)>& callback) {
+void SerialPort::write(const std::string &data, WriteCallback callback) {
+    write(data.data(), data.size(), std::move(callback));
+}
+
+void SerialPort::write(const char *data, size_t size, WriteCallback callback) {
+    struct iovec segment = {const_cast<char *>(data), size};
+
+    write(&segment, 1, std::move(callback));
+}
+
+void SerialPort::write(const struct iovec *segments, size_t count, WriteCallback callback) {
+    size_t size = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        size += segments[i].iov_len;
+    }
+
     if (!is_open()) {
-        callback(common::NOT_OPEN);
+        if(callback) {
+            callback(common::NOT_OPEN);
+        }
         return;
     }
 
+    // counted before checking running, so a stopping port waits until this write is queued and the worker woken,
+    // and drains it after that, callbacks are called once uncounted as they may close the port
+    writers++;
+
     if(!running) {
+        writers--;
+
         // Ooops! serialport is open
         // but epoll worker is not running
-        callback(common::FAILURE);
+        if(callback) {
+            callback(common::FAILURE);
+        }
         return;
     }
 
-    IOEvent io_evt;
+    ASYNC_PYSERIAL_TRACE(trace::WRITE_SUBMIT, trace::INSTANT, serial_fd, size);
 
-    io_evt.callback = callback;
-    io_evt.bytes_written = 0;
-    io_evt.data = data;
+    if(!connected && options.reconnect_write_policy != RECONNECT_BUFFER_WRITES) {
+        writers--;
 
-    std::unique_lock<std::mutex> lock(w_mutex);
+        // supervised port waiting for its device
+        if(callback) {
+            callback(common::FAILURE);
+        }
+        return;
+    }
 
-    w_queue.push_back(std::move(io_evt));
+    // copied before queueing
+    std::string large;
 
-    serial_evt.events = EPOLLIN | EPOLLOUT;
+    if(size > IOEvent::INLINE_PAYLOAD) {
+        large.reserve(size);
 
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt) == -1) {
-        callback(common::FAILURE);
+        for(size_t i = 0; i < count; i++) {
+            large.append(static_cast<const char *>(segments[i].iov_base), segments[i].iov_len);
+        }
+    }
+
+    auto fill = [&](IOEvent &io_evt) {
+        if(size > IOEvent::INLINE_PAYLOAD) {
+            io_evt.assign(std::move(large));
+        } else {
+            io_evt.assign(segments, count, size);
+        }
+
+        io_evt.callback = std::move(callback);
+    };
+
+    bool wake = false;
+    bool drained = false;
+
+    // writers neither take w_mutex nor make a syscall, unless the worker is idle or WRITE_SUBMIT_SIZE writes behind
+    while(!submissions.push(fill, wake)) {
+        std::lock_guard<std::mutex> lock(w_mutex);
+
+        // makes room, writes never bypass the queue so each writer's writes stay in order
+        if(takeSubmissions()) {
+            // the head slot is still being filled
+            std::this_thread::yield();
+        }
+
+        drained = true;
+    }
+
+    if(wake || drained) {
+        wakeWriter();
+    }
+
+    writers--;
+}
+
+std::shared_ptr<ScheduledWrite> SerialPort::schedule_write(const std::string &data, uint64_t at_ns, uint64_t period_ns) {
+    if(!is_open() || !running || !schedule) {
+        throw common::SerialPortException("serial port is not open");
+    }
+
+    return schedule->add(data, at_ns, period_ns);
+}
+
+void SerialPort::fireSchedule() {
+    std::lock_guard<std::mutex> lock(w_mutex);
+
+    // writes submitted before the deadline go first
+    if(takeSubmissions()) {
+        wakeWriter();
+    }
+
+    schedule->fire([this](const std::string &data) {
+        if(!connected) {
+            // not buffered, a missed period
+            return false;
+        }
+
+        IOEvent io_evt;
+
+        if(data.size() > IOEvent::INLINE_PAYLOAD) {
+            io_evt.assign(std::string(data));
+        } else {
+            struct iovec segment = {const_cast<char *>(data.data()), data.size()};
+
+            io_evt.assign(&segment, 1, data.size());
+        }
+
+        ASYNC_PYSERIAL_TRACE(trace::WRITE_SUBMIT, trace::INSTANT, serial_fd, data.size());
+
+        queueWrite(std::move(io_evt));
+
+        return true;
+    });
+
+    if(!engine && connected && !w_queue.empty() && !w_queue.front().barrier) {
+        serial_evt.events = serialEvents(true);
+
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, serial_fd, &serial_evt);
+    }
+}
+
+void SerialPort::queueWrite(IOEvent &&submitted) {
+    size_t slabs = w_queue.slabs();
+
+    IOEvent &io_evt = w_queue.emplace_back();
+
+    io_evt = std::move(submitted);
+
+    write_counters.requests++;
+    write_counters.slab_allocations += w_queue.slabs() - slabs;
+
+    if(io_evt.size() > IOEvent::INLINE_PAYLOAD) {
+        write_counters.heap_payloads++;
+    }
+}
+
+bool SerialPort::takeSubmissions() {
+    return submissions.drain([this](IOEvent &io_evt) {
+        queueWrite(std::move(io_evt));
+    });
+}
+
+std::vector<WriteCallback> SerialPort::takeQueued() {
+    std::vector<WriteCallback> callbacks;
+
+    takeSubmissions();
+
+    while(w_queue.size() > 0) {
+        if(w_queue.front().callback) {
+            callbacks.push_back(std::move(w_queue.front().callback));
+        }
+
+        w_queue.pop_front();
+    }
+
+    return callbacks;
+}
+
+void SerialPort::wakeWriter() {
+    if(engine) {
+        engine->kick(uring_slot);
+        return;
+    }
+
+    uint64_t notify_val = 1;
+    ::write(notify_fd, &notify_val, sizeof(notify_val));
+}
+
+void SerialPort::waitWriters() {
+    while(writers > 0) {
+        std::this_thread::yield();
+    }
+}
+
+bool SerialPort::onIOThread() {
+    if(engine) {
+        return pthread_equal(pthread_self(), engine->native_handle());
+    }
+
+    return std::this_thread::get_id() == readThread.get_id();
+}
+
+WriteStats SerialPort::write_stats() {
+    std::lock_guard<std::mutex> lock(w_mutex);
+
+    // the worker still gets its wakeup for them
+    takeSubmissions();
+
+    WriteStats result = write_counters;
+
+    result.pooled = w_queue.capacity();
+
+    return result;
+}
+
+void IOEvent::assign(const struct iovec *segments, size_t count, size_t size) {
+    size_t offset = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        if(segments[i].iov_len > 0) {
+            memcpy(small + offset, segments[i].iov_base, segments[i].iov_len);
+        }
+
+        offset += segments[i].iov_len;
+    }
+
+    length = size;
+}
+
+void IOEvent::assign(std::string &&data) {
+    length = data.size();
+
+    if(length > INLINE_PAYLOAD) {
+        large = std::move(data);
+    } else {
+        memcpy(small, data.data(), length);
+    }
+}
+
+void IOEvent::reset() {
+    length = 0;
+    bytes_written = 0;
+    barrier = false;
+
+    callback.reset();
+
+    // a large payload is not kept around by the pool
+    std::string().swap(large);
+}
+
+void SerialPort::addSink(const std::shared_ptr<common::StreamSink> &sink) {
+    std::lock_guard<std::mutex> lock(sinks_mutex);
+
+    auto updated = std::make_shared<std::vector<std::shared_ptr<common::StreamSink>>>();
+
+    auto current = std::atomic_load(&sinks);
+    if(current) {
+        *updated = *current;
+    }
+
+    updated->push_back(sink);
+
+    std::atomic_store(&sinks, std::shared_ptr<const std::vector<std::shared_ptr<common::StreamSink>>>(updated));
+
+    has_sinks = true;
+}
+
+void SerialPort::removeSink(const std::shared_ptr<common::StreamSink> &sink) {
+    std::lock_guard<std::mutex> lock(sinks_mutex);
+
+    auto current = std::atomic_load(&sinks);
+    if(!current) {
         return;
     }
+
+    auto updated = std::make_shared<std::vector<std::shared_ptr<common::StreamSink>>>();
+
+    for(auto& s : *current) {
+        if(s != sink) {
+            updated->push_back(s);
+        }
+    }
+
+    has_sinks = !updated->empty();
+
+    std::atomic_store(&sinks, std::shared_ptr<const std::vector<std::shared_ptr<common::StreamSink>>>(updated));
+}
+
+void SerialPort::notifySinks(common::StreamDirection direction, const char *data, size_t size) {
+    auto current = std::atomic_load(&sinks);
+
+    if(!current) {
+        return;
+    }
+
+    uint64_t ts = common::monotonic_ns();
+
+    for(auto& sink : *current) {
+        sink->onChunk(direction, ts, data, size);
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
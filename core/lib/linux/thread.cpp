@@ -0,0 +1,92 @@
+#ifdef LINUX
+
+#include <linux/thread.h>
+
+#include <sched.h>
+#include <errno.h>
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+ThreadStatus async_pyserial::internal::applyThreadOptions(pthread_t thread, const base::SerialPortOptions &options, const std::string &default_name)
+{
+    ThreadStatus status;
+
+    status.applied = true;
+
+    if (!options.cpu_affinity.empty())
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+
+        for (int cpu : options.cpu_affinity)
+        {
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
+            {
+                status.affinity_error = EINVAL;
+                break;
+            }
+
+            CPU_SET(cpu, &cpus);
+        }
+
+        if (status.affinity_error == 0)
+        {
+            status.affinity_error = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+        }
+    }
+
+    if (options.sched_policy != SCHED_OTHER)
+    {
+        if (options.sched_policy != SCHED_FIFO && options.sched_policy != SCHED_RR)
+        {
+            status.sched_error = EINVAL;
+        }
+        else
+        {
+            struct sched_param param = {};
+            param.sched_priority = options.sched_priority;
+
+            status.sched_error = pthread_setschedparam(thread, options.sched_policy, &param);
+        }
+    }
+
+    std::string name = options.thread_name.empty() ? default_name : options.thread_name;
+
+    if (!name.empty())
+    {
+        name = name.substr(0, THREAD_NAME_MAX);
+        status.name_error = pthread_setname_np(thread, name.c_str());
+    }
+
+    // report what the thread actually ended up with
+    cpu_set_t cpus;
+    if (pthread_getaffinity_np(thread, sizeof(cpus), &cpus) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &cpus))
+            {
+                status.cpu_affinity.push_back(cpu);
+            }
+        }
+    }
+
+    int policy;
+    struct sched_param param = {};
+    if (pthread_getschedparam(thread, &policy, &param) == 0)
+    {
+        status.sched_policy = policy;
+        status.sched_priority = param.sched_priority;
+    }
+
+    char current[THREAD_NAME_MAX + 1] = {};
+    if (pthread_getname_np(thread, current, sizeof(current)) == 0)
+    {
+        status.name = current;
+    }
+
+    return status;
+}
+
+#endif
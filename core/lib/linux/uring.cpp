@@ -0,0 +1,1172 @@
+#ifdef LINUX
+
+#include <linux/uring.h>
+#include <linux/serialport.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+#include <common/common.h>
+#include <common/record.h>
+#include <common/trace.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+// not in older uapi headers, supported since linux 6.7
+#define URING_OP_READ_MULTISHOT 49
+
+#define URING_TAG(slot, op) ((static_cast<uint64_t>(slot) + 1) << 8 | (op))
+#define URING_ENGINE_TAG(op) (static_cast<uint64_t>(op))
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+namespace trace = async_pyserial::common::trace;
+
+static int io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_register(int fd, unsigned int opcode, void *arg, unsigned int nr_args)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+std::shared_ptr<UringEngine> UringEngine::shared(size_t buffer_size)
+{
+    static std::mutex shared_mutex;
+    static std::weak_ptr<UringEngine> instance;
+
+    std::lock_guard<std::mutex> lock(shared_mutex);
+
+    auto engine = instance.lock();
+
+    if (!engine || engine->hasFailed())
+    {
+        engine = std::make_shared<UringEngine>(buffer_size);
+        instance = engine;
+    }
+
+    return engine;
+}
+
+UringEngine::UringEngine(size_t buffer_size)
+    : ring_fd(-1), wake_fd(-1), sq_ptr(MAP_FAILED), sq_size(0), cq_ptr(MAP_FAILED), cq_size(0),
+      sqes(nullptr), sqes_size(0), sq_tail(0), to_submit(0), buf_ring(nullptr), buf_ring_size(0),
+      buffers(nullptr), buffer_size(std::clamp<size_t>(buffer_size, URING_BUFFER_MIN, URING_BUFFER_MAX)), buf_tail(0),
+      wake_val(0), timer_ts{}, timer_deadline(0), slot_count(0), wake_signaled(false), running(false), failed(false),
+      failing(false)
+{
+    try
+    {
+        setupRing();
+        setupBuffers();
+    }
+    catch (const common::OSException &)
+    {
+        release();
+        throw;
+    }
+
+    running = true;
+
+    engineThread = std::thread(&UringEngine::engineWorker, this);
+}
+
+UringEngine::~UringEngine()
+{
+    if (engineThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+
+        uint64_t notify_val = 1;
+        ::write(wake_fd, &notify_val, sizeof(notify_val));
+
+        // the last reference may be dropped by the engine thread once it failed, see engineWorker()
+        if (pthread_equal(pthread_self(), engineThread.native_handle()))
+        {
+            engineThread.detach();
+        }
+        else
+        {
+            engineThread.join();
+        }
+    }
+
+    release();
+}
+
+void UringEngine::release()
+{
+    // closing the ring cancels whatever is still in flight
+    if (ring_fd != -1) ::close(ring_fd);
+    if (wake_fd != -1) ::close(wake_fd);
+
+    if (buffers != nullptr) munmap(buffers, static_cast<size_t>(URING_BUFFER_COUNT) * buffer_size);
+    if (buf_ring != nullptr) munmap(buf_ring, buf_ring_size);
+    if (sqes != nullptr) munmap(sqes, sqes_size);
+    if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+    if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+
+    ring_fd = -1;
+    wake_fd = -1;
+    buffers = nullptr;
+    buf_ring = nullptr;
+    sqes = nullptr;
+    cq_ptr = MAP_FAILED;
+    sq_ptr = MAP_FAILED;
+}
+
+void UringEngine::setupRing()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_CQ_ENTRIES;
+
+    ring_fd = io_uring_setup(URING_SQ_ENTRIES, &params);
+
+    if (ring_fd < 0)
+    {
+        ring_fd = -1;
+        throw common::OSException(std::string("io_uring setup failure: ") + strerror(errno));
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP))
+    {
+        throw common::OSException("io_uring is too old");
+    }
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    sq_size = cq_size = std::max(sq_size, cq_size);
+
+    sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+
+    if (sq_ptr == MAP_FAILED)
+    {
+        throw common::OSException("io_uring map failure");
+    }
+
+    cq_ptr = sq_ptr;
+
+    sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *mapped = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+
+    if (mapped == MAP_FAILED)
+    {
+        throw common::OSException("io_uring map failure");
+    }
+
+    sqes = static_cast<struct io_uring_sqe *>(mapped);
+
+    char *sq = static_cast<char *>(sq_ptr);
+    sq_khead = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+    sq_ktail = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    sq_array = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+    sq_tail = *sq_ktail;
+
+    char *cq = static_cast<char *>(cq_ptr);
+    cq_khead = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+    cq_ktail = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    // blocking, so the pending read completes only when it is signaled
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (wake_fd == -1)
+    {
+        throw common::OSException("io_uring eventfd failure");
+    }
+}
+
+void UringEngine::setupBuffers()
+{
+    buf_ring_size = URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+
+    void *ring = mmap(nullptr, buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (ring == MAP_FAILED)
+    {
+        throw common::OSException("io_uring buffer ring failure");
+    }
+
+    buf_ring = static_cast<struct io_uring_buf_ring *>(ring);
+    memset(buf_ring, 0, buf_ring_size);
+
+    void *mapped = mmap(nullptr, static_cast<size_t>(URING_BUFFER_COUNT) * buffer_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (mapped == MAP_FAILED)
+    {
+        throw common::OSException("io_uring buffer failure");
+    }
+
+    buffers = static_cast<char *>(mapped);
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring);
+    reg.ring_entries = URING_BUFFER_COUNT;
+    reg.bgid = 0;
+
+    if (io_uring_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        throw common::OSException(std::string("io_uring register buffer ring failure: ") + strerror(errno));
+    }
+
+    for (uint16_t bid = 0; bid < URING_BUFFER_COUNT; bid++)
+    {
+        recycleBuffer(bid);
+    }
+}
+
+void UringEngine::recycleBuffer(uint16_t bid)
+{
+    // the entries start at the ring base, `bufs` is misplaced by the flexible array wrapper in c++
+    struct io_uring_buf *buf = reinterpret_cast<struct io_uring_buf *>(buf_ring) + (buf_tail & (URING_BUFFER_COUNT - 1));
+    buf->addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(bid) * buffer_size);
+    buf->len = static_cast<uint32_t>(buffer_size);
+    buf->bid = bid;
+
+    buf_tail++;
+
+    __atomic_store_n(&buf_ring->tail, buf_tail, __ATOMIC_RELEASE);
+}
+
+int UringEngine::enter(unsigned int submit, unsigned int min_complete, unsigned int flags)
+{
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, submit, min_complete, flags, nullptr, 0));
+
+    if (ret < 0)
+    {
+        return -errno;
+    }
+
+    to_submit -= std::min<unsigned int>(to_submit, ret);
+
+    return ret;
+}
+
+struct io_uring_sqe *UringEngine::getSqe()
+{
+    while (sq_tail - __atomic_load_n(sq_khead, __ATOMIC_ACQUIRE) >= sq_entries)
+    {
+        // the submission queue is full, hand it to the kernel
+        int ret = enter(to_submit, 0, 0);
+
+        if (ret < 0 && ret != -EINTR && ret != -EBUSY && ret != -EAGAIN)
+        {
+            throw common::OSException(std::string("io_uring submit failure: ") + strerror(-ret));
+        }
+    }
+
+    uint32_t index = sq_tail & sq_mask;
+
+    struct io_uring_sqe *sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+
+    sq_array[index] = index;
+    sq_tail++;
+    to_submit++;
+
+    __atomic_store_n(sq_ktail, sq_tail, __ATOMIC_RELEASE);
+
+    return sqe;
+}
+
+int UringEngine::attach(SerialPort *port, int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (failed)
+        {
+            throw common::OSException("io_uring engine failure");
+        }
+    }
+
+    Slot *state = new Slot();
+    state->port = port;
+    state->fd = fd;
+    state->schedule_fd = port->schedule ? port->schedule->fd() : -1;
+    state->read_budget = std::max<size_t>(port->options.read_budget, port->options.read_buffer_size);
+
+    bool signal;
+    int slot;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!free_slots.empty())
+        {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        }
+        else
+        {
+            slot = slot_count++;
+        }
+
+        requests.push_back({REQ_ATTACH, slot, state, nullptr});
+
+        signal = !wake_signaled;
+        wake_signaled = true;
+    }
+
+    if (signal)
+    {
+        uint64_t notify_val = 1;
+        ::write(wake_fd, &notify_val, sizeof(notify_val));
+    }
+
+    return slot;
+}
+
+void UringEngine::detach(int slot)
+{
+    bool detached = false;
+    bool signal;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (failed)
+    {
+        // nothing is in flight anymore, fail() skips the port once this is requested
+        requests.push_back({REQ_DETACH, slot, nullptr, nullptr});
+
+        if (!pthread_equal(pthread_self(), engineThread.native_handle()))
+        {
+            detach_cv.wait(lock, [this]() { return !failing; });
+        }
+
+        return;
+    }
+
+    requests.push_back({REQ_DETACH, slot, nullptr, &detached});
+
+    signal = !wake_signaled;
+    wake_signaled = true;
+
+    if (signal)
+    {
+        uint64_t notify_val = 1;
+        ::write(wake_fd, &notify_val, sizeof(notify_val));
+    }
+
+    detach_cv.wait(lock, [&detached]() { return detached; });
+}
+
+void UringEngine::kick(int slot)
+{
+    bool signal;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // the port was failed
+        if (failed)
+        {
+            return;
+        }
+
+        requests.push_back({REQ_KICK, slot, nullptr, nullptr});
+
+        signal = !wake_signaled;
+        wake_signaled = true;
+    }
+
+    // only the first request since the engine last looked costs a syscall
+    if (signal)
+    {
+        uint64_t notify_val = 1;
+        ::write(wake_fd, &notify_val, sizeof(notify_val));
+    }
+}
+
+void UringEngine::rearm(int slot)
+{
+    bool signal;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (failed)
+        {
+            return;
+        }
+
+        requests.push_back({REQ_REARM, slot, nullptr, nullptr});
+
+        signal = !wake_signaled;
+        wake_signaled = true;
+    }
+
+    if (signal)
+    {
+        uint64_t notify_val = 1;
+        ::write(wake_fd, &notify_val, sizeof(notify_val));
+    }
+}
+
+pthread_t UringEngine::native_handle()
+{
+    return engineThread.native_handle();
+}
+
+bool UringEngine::hasFailed()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    return failed;
+}
+
+bool UringEngine::detachRequested(int slot)
+{
+    for (auto &request : requests)
+    {
+        if (request.type == REQ_DETACH && request.slot == slot)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void UringEngine::fail(const std::string &reason)
+{
+    std::cerr << reason << std::endl;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        running = false;
+        failed = true;
+        failing = true;
+
+        for (auto &request : requests)
+        {
+            if (request.type == REQ_ATTACH)
+            {
+                // failed with the others
+                if (slots.size() <= static_cast<size_t>(request.slot))
+                {
+                    slots.resize(request.slot + 1);
+                }
+
+                slots[request.slot].reset(request.state);
+            }
+            else if (request.type == REQ_DETACH)
+            {
+                *request.done = true;
+            }
+        }
+
+        for (auto &state : slots)
+        {
+            if (state && state->detaching)
+            {
+                *state->detached = true;
+            }
+        }
+
+        detach_cv.notify_all();
+    }
+
+    for (size_t slot = 0; slot < slots.size(); slot++)
+    {
+        if (!slots[slot] || slots[slot]->detaching)
+        {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // closed since, possibly by a callback of another port
+            if (detachRequested(static_cast<int>(slot)))
+            {
+                continue;
+            }
+        }
+
+        slots[slot]->port->onEngineFailure();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    failing = false;
+
+    detach_cv.notify_all();
+}
+
+void UringEngine::handleRequests()
+{
+    std::vector<PendingRequest> pending;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        pending.swap(requests);
+        wake_signaled = false;
+    }
+
+    for (auto &request : pending)
+    {
+        if (request.type == REQ_ATTACH)
+        {
+            if (slots.size() <= static_cast<size_t>(request.slot))
+            {
+                slots.resize(request.slot + 1);
+            }
+
+            slots[request.slot].reset(request.state);
+
+            if (!request.state->port->read_paused)
+            {
+                armRead(request.slot);
+            }
+
+            if (request.state->schedule_fd != -1)
+            {
+                armSchedule(request.slot);
+            }
+
+            submitWrites(request.slot);
+        }
+        else if (request.type == REQ_DETACH)
+        {
+            Slot &state = *slots[request.slot];
+
+            state.detaching = true;
+            state.detached = request.done;
+
+            if (state.inflight > 0)
+            {
+                cancel(request.slot, 0);
+            }
+
+            // not on the port's fd
+            if (state.scheduling)
+            {
+                cancel(request.slot, OP_SCHEDULE);
+            }
+
+            maybeRelease(request.slot);
+        }
+        else if (request.type == REQ_KICK)
+        {
+            if (static_cast<size_t>(request.slot) < slots.size() && slots[request.slot] &&
+                !slots[request.slot]->detaching && slots[request.slot]->writes_inflight == 0)
+            {
+                submitWrites(request.slot);
+            }
+        }
+        else if (request.type == REQ_REARM)
+        {
+            if (static_cast<size_t>(request.slot) >= slots.size() || !slots[request.slot] ||
+                slots[request.slot]->detaching)
+            {
+                continue;
+            }
+
+            Slot &state = *slots[request.slot];
+
+            if (state.port->read_paused && state.reading)
+            {
+                cancel(request.slot, OP_READ);
+            }
+            else if (!state.port->read_paused && !state.reading)
+            {
+                armRead(request.slot);
+            }
+        }
+    }
+}
+
+void UringEngine::armWake()
+{
+    struct io_uring_sqe *sqe = getSqe();
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_val);
+    sqe->len = sizeof(wake_val);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->user_data = URING_ENGINE_TAG(OP_WAKE);
+}
+
+void UringEngine::armSchedule(int slot)
+{
+    Slot &state = *slots[slot];
+
+    struct io_uring_sqe *sqe = getSqe();
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = state.schedule_fd;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = URING_TAG(slot, OP_SCHEDULE);
+
+    state.scheduling = true;
+    state.inflight++;
+}
+
+void UringEngine::armRead(int slot)
+{
+    Slot &state = *slots[slot];
+
+    struct io_uring_sqe *sqe = getSqe();
+
+    sqe->opcode = state.multishot ? URING_OP_READ_MULTISHOT : IORING_OP_READ;
+    sqe->fd = state.fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->len = state.multishot ? 0 : static_cast<uint32_t>(buffer_size);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->user_data = URING_TAG(slot, OP_READ);
+
+    state.reading = true;
+    state.inflight++;
+}
+
+void UringEngine::submitWrites(int slot)
+{
+    Slot &state = *slots[slot];
+
+    SerialPort *port = state.port;
+
+    std::lock_guard<std::mutex> lock(port->w_mutex);
+
+    if (port->takeSubmissions())
+    {
+        // a writer is still filling its slot, come back once it is published
+        kick(slot);
+    }
+
+    size_t limit = std::min<size_t>(port->w_queue.size(), URING_WRITE_CHAIN);
+    size_t count = 0;
+
+    auto first = port->w_queue.begin();
+
+    // the chain stops at a reconfigure barrier
+    for (auto it = first; count < limit && !it->barrier; ++it)
+    {
+        count++;
+    }
+
+    if (count == 0)
+    {
+        if (limit > 0)
+        {
+            // parked until reconfigure() pops the barrier and kicks again
+            port->w_queue.front().callback(common::SUCCESS);
+        }
+
+        return;
+    }
+
+    // a chain must not be split over two submissions, that would cut the link
+    if (sq_tail - __atomic_load_n(sq_khead, __ATOMIC_ACQUIRE) + count > sq_entries)
+    {
+        enter(to_submit, 0, 0);
+    }
+
+    auto it = first;
+
+    for (size_t i = 0; i < count; i++, ++it)
+    {
+        IOEvent &io_evt = *it;
+
+        struct io_uring_sqe *sqe = getSqe();
+
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = state.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(io_evt.data() + io_evt.bytes_written);
+        sqe->len = static_cast<uint32_t>(io_evt.size() - io_evt.bytes_written);
+        sqe->off = static_cast<uint64_t>(-1);
+        sqe->user_data = URING_TAG(slot, OP_WRITE);
+
+        // a short write breaks the chain, the rest completes with -ECANCELED and is resubmitted
+        if (i + 1 < count)
+        {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+    }
+
+    state.writes_inflight = count;
+    state.inflight += count;
+
+    // as on epoll the deadline covers the front write, it restarts when the chain comes back after progress
+    state.write_deadline = port->writeDeadline(first->size() - first->bytes_written);
+
+    if (state.write_deadline != 0)
+    {
+        armTimer(state.write_deadline);
+    }
+}
+
+void UringEngine::completeWrites(int slot)
+{
+    Slot &state = *slots[slot];
+
+    SerialPort *port = state.port;
+
+    std::vector<std::pair<WriteCallback, unsigned long>> completed;
+    bool more;
+    bool progress = false;
+
+    {
+        std::lock_guard<std::mutex> lock(port->w_mutex);
+
+        for (int res : state.write_results)
+        {
+            if (port->w_queue.empty())
+            {
+                break;
+            }
+
+            IOEvent &io_evt = port->w_queue.front();
+
+            if (res >= 0)
+            {
+                if (res > 0 && port->has_sinks)
+                {
+                    port->notifySinks(common::TX, io_evt.data() + io_evt.bytes_written, res);
+                }
+
+                if (res > 0 && port->options.rs485_suppress_echo)
+                {
+                    port->recordEcho(io_evt.data() + io_evt.bytes_written, res);
+                }
+
+                io_evt.bytes_written += res;
+                progress = progress || res > 0;
+
+                if (io_evt.bytes_written < io_evt.size())
+                {
+                    break;
+                }
+
+                completed.emplace_back(std::move(io_evt.callback), common::SUCCESS);
+                port->w_queue.pop_front();
+
+                continue;
+            }
+
+            if (res == -ECANCELED || res == -EINTR || res == -EAGAIN)
+            {
+                // only a write the driver took nothing of since the deadline was set fails
+                if (state.write_timed_out && !progress)
+                {
+                    completed.emplace_back(std::move(io_evt.callback), common::FAILURE);
+                    port->w_queue.pop_front();
+                }
+
+                break;
+            }
+
+            // write failure, like the epoll worker every queued write fails
+            while (!port->w_queue.empty())
+            {
+                completed.emplace_back(std::move(port->w_queue.front().callback), common::FAILURE);
+                port->w_queue.pop_front();
+            }
+
+            break;
+        }
+
+        state.write_results.clear();
+        state.write_timed_out = false;
+        state.write_deadline = 0;
+
+        // submitted while these were in flight, their kick was ignored
+        bool later = port->takeSubmissions();
+
+        more = later || !port->w_queue.empty();
+    }
+
+    // outside the lock, so callbacks may write again
+    for (auto &entry : completed)
+    {
+        ASYNC_PYSERIAL_TRACE(trace::WRITE_COMPLETE, trace::INSTANT, state.fd, entry.second);
+
+        if (entry.first)
+        {
+            entry.first(entry.second);
+        }
+    }
+
+    if (more && !state.detaching)
+    {
+        submitWrites(slot);
+    }
+}
+
+void UringEngine::cancel(int slot, uint8_t op)
+{
+    Slot &state = *slots[slot];
+
+    struct io_uring_sqe *sqe = getSqe();
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->user_data = URING_TAG(slot, OP_CANCEL);
+
+    if (op != 0)
+    {
+        sqe->addr = URING_TAG(slot, op);
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+    }
+    else
+    {
+        sqe->fd = state.fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    }
+
+    state.inflight++;
+}
+
+void UringEngine::armTimer(uint64_t deadline)
+{
+    if (timer_deadline != 0 && timer_deadline <= deadline)
+    {
+        return;
+    }
+
+    timer_ts.tv_sec = deadline / 1000000000ULL;
+    timer_ts.tv_nsec = deadline % 1000000000ULL;
+
+    struct io_uring_sqe *sqe = getSqe();
+
+    if (timer_deadline == 0)
+    {
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->addr = reinterpret_cast<uint64_t>(&timer_ts);
+        sqe->len = 1;
+        sqe->timeout_flags = IORING_TIMEOUT_ABS;
+        sqe->user_data = URING_ENGINE_TAG(OP_TIMER);
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+        sqe->addr = URING_ENGINE_TAG(OP_TIMER);
+        sqe->addr2 = reinterpret_cast<uint64_t>(&timer_ts);
+        sqe->timeout_flags = IORING_TIMEOUT_UPDATE | IORING_TIMEOUT_ABS;
+        sqe->user_data = URING_ENGINE_TAG(OP_TIMER_UPDATE);
+    }
+
+    timer_deadline = deadline;
+}
+
+void UringEngine::checkDeadlines()
+{
+    uint64_t now = common::monotonic_ns();
+    uint64_t next = 0;
+
+    for (size_t slot = 0; slot < slots.size(); slot++)
+    {
+        if (!slots[slot] || slots[slot]->write_deadline == 0)
+        {
+            continue;
+        }
+
+        Slot &state = *slots[slot];
+
+        if (state.write_deadline <= now)
+        {
+            if (!state.write_timed_out && !state.detaching)
+            {
+                state.write_timed_out = true;
+                cancel(slot, OP_WRITE);
+            }
+
+            continue;
+        }
+
+        if (next == 0 || state.write_deadline < next)
+        {
+            next = state.write_deadline;
+        }
+    }
+
+    if (next != 0)
+    {
+        armTimer(next);
+    }
+}
+
+void UringEngine::maybeRelease(int slot)
+{
+    Slot &state = *slots[slot];
+
+    if (!state.detaching || state.inflight > 0)
+    {
+        return;
+    }
+
+    deliver(slot);
+
+    bool *detached = state.detached;
+
+    slots[slot].reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    free_slots.push_back(slot);
+
+    *detached = true;
+
+    detach_cv.notify_all();
+}
+
+void UringEngine::receive(int slot, const char *data, size_t size)
+{
+    Slot &state = *slots[slot];
+
+    if (state.received.empty())
+    {
+        receiving.push_back(slot);
+    }
+
+    state.received.append(data, size);
+
+    if (state.received.size() >= state.read_budget)
+    {
+        deliver(slot);
+    }
+}
+
+void UringEngine::deliver(int slot)
+{
+    Slot &state = *slots[slot];
+
+    if (state.received.empty())
+    {
+        return;
+    }
+
+    // keeps its capacity for the next reads, onReceive copies it
+    state.port->onReceive(state.received.data(), state.received.size());
+
+    state.received.clear();
+}
+
+void UringEngine::deliverReceived()
+{
+    for (int slot : receiving)
+    {
+        // released since
+        if (static_cast<size_t>(slot) < slots.size() && slots[slot])
+        {
+            deliver(slot);
+        }
+    }
+
+    receiving.clear();
+}
+
+void UringEngine::handleCompletion(uint64_t user_data, int res, uint32_t flags)
+{
+    Op op = static_cast<Op>(user_data & 0xff);
+
+    if ((user_data >> 8) == 0)
+    {
+        if (op == OP_WAKE)
+        {
+            armWake();
+        }
+        else if (op == OP_TIMER)
+        {
+            timer_deadline = 0;
+            checkDeadlines();
+        }
+
+        return;
+    }
+
+    int slot = static_cast<int>((user_data >> 8) - 1);
+
+    Slot &state = *slots[slot];
+
+    bool more = flags & IORING_CQE_F_MORE;
+
+    if (op == OP_READ)
+    {
+        if (res > 0 && (flags & IORING_CQE_F_BUFFER))
+        {
+            uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+
+            receive(slot, buffers + static_cast<size_t>(bid) * buffer_size, res);
+
+            recycleBuffer(bid);
+        }
+
+        if (more)
+        {
+            return;
+        }
+
+        // what arrived before the end of the read
+        deliver(slot);
+
+        state.inflight--;
+        state.reading = false;
+
+        if (state.detaching)
+        {
+            maybeRelease(slot);
+            return;
+        }
+
+        if (state.port->read_paused)
+        {
+            // rearmed by resume_reading()
+        }
+        else if (res == -EINVAL && state.multishot)
+        {
+            // multishot read is not supported by this kernel
+            state.multishot = false;
+            armRead(slot);
+        }
+        else if (res > 0 || res == -ENOBUFS || res == -EINTR || res == -EAGAIN || res == -ECANCELED)
+        {
+            armRead(slot);
+        }
+        else
+        {
+            std::cerr << "io_uring read error on fd " << state.fd << ": " << (res == 0 ? "end of file" : strerror(-res)) << std::endl;
+        }
+    }
+    else if (op == OP_WRITE)
+    {
+        state.inflight--;
+        state.write_results.push_back(res);
+
+        if (--state.writes_inflight == 0)
+        {
+            completeWrites(slot);
+        }
+
+        maybeRelease(slot);
+    }
+    else if (op == OP_SCHEDULE)
+    {
+        state.inflight--;
+        state.scheduling = false;
+
+        if (state.detaching)
+        {
+            maybeRelease(slot);
+            return;
+        }
+
+        if (res >= 0)
+        {
+            state.port->fireSchedule();
+
+            if (state.writes_inflight == 0)
+            {
+                submitWrites(slot);
+            }
+        }
+
+        armSchedule(slot);
+    }
+    else if (op == OP_CANCEL)
+    {
+        state.inflight--;
+
+        maybeRelease(slot);
+    }
+}
+
+void UringEngine::engineWorker()
+{
+    trace::set_thread_name("io_uring worker");
+
+    try
+    {
+        work();
+    }
+    catch (const common::OSException &err)
+    {
+        // a port closed by a callback may drop the last reference, the engine is destroyed on return
+        auto self = weak_from_this().lock();
+
+        fail(err.what());
+    }
+}
+
+void UringEngine::work()
+{
+    armWake();
+
+    while (true)
+    {
+        handleRequests();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!running)
+            {
+                break;
+            }
+        }
+
+        bool ready = __atomic_load_n(cq_ktail, __ATOMIC_ACQUIRE) != *cq_khead;
+
+        // submits everything prepared and waits in a single syscall
+        int ret = enter(to_submit, ready ? 0 : 1, IORING_ENTER_GETEVENTS);
+
+        if (ret < 0 && ret != -EINTR && ret != -EBUSY && ret != -EAGAIN && ret != -ETIME)
+        {
+            throw common::OSException(std::string("io_uring_enter error: ") + strerror(-ret));
+        }
+
+        uint32_t head = *cq_khead;
+        uint32_t tail = __atomic_load_n(cq_ktail, __ATOMIC_ACQUIRE);
+
+        ASYNC_PYSERIAL_TRACE(trace::EPOLL_WAKEUP, trace::INSTANT, -1, tail - head);
+
+        while (head != tail)
+        {
+            struct io_uring_cqe *cqe = &cqes[head & cq_mask];
+
+            uint64_t user_data = cqe->user_data;
+            int res = cqe->res;
+            uint32_t flags = cqe->flags;
+
+            head++;
+
+            // release the entry first, the handler may reap more by submitting
+            __atomic_store_n(cq_khead, head, __ATOMIC_RELEASE);
+
+            handleCompletion(user_data, res, flags);
+
+            if (head == tail)
+            {
+                tail = __atomic_load_n(cq_ktail, __ATOMIC_ACQUIRE);
+            }
+        }
+
+        // nothing else was reaped, as the epoll worker delivers once the driver is drained
+        deliverReceived();
+    }
+}
+
+#endif
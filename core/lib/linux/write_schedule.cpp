@@ -0,0 +1,168 @@
+#ifdef LINUX
+
+#include <linux/write_schedule.h>
+#include <common/record.h>
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace async_pyserial;
+using namespace async_pyserial::internal;
+
+ScheduledWrite::ScheduledWrite(const std::string &data, uint64_t period_ns, const std::shared_ptr<std::mutex> &schedule_mutex)
+    : data(data), period_ns(period_ns), schedule_mutex(schedule_mutex) {}
+
+void ScheduledWrite::cancel()
+{
+    // not between the check in WriteSchedule::fire and the write it queues
+    std::lock_guard<std::mutex> lock(*schedule_mutex);
+
+    cancelled = true;
+}
+
+bool ScheduledWrite::active() const
+{
+    return !cancelled && !done;
+}
+
+uint64_t ScheduledWrite::fired() const
+{
+    return fired_count.load(std::memory_order_relaxed);
+}
+
+uint64_t ScheduledWrite::missed() const
+{
+    return missed_count.load(std::memory_order_relaxed);
+}
+
+WriteSchedule::WriteSchedule()
+{
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+    if (timer_fd == -1)
+    {
+        throw common::OSException("create write timerfd failure");
+    }
+}
+
+WriteSchedule::~WriteSchedule()
+{
+    ::close(timer_fd);
+}
+
+std::shared_ptr<ScheduledWrite> WriteSchedule::add(const std::string &data, uint64_t at_ns, uint64_t period_ns)
+{
+    auto write = std::make_shared<ScheduledWrite>(data, period_ns, mutex);
+
+    std::lock_guard<std::mutex> lock(*mutex);
+
+    // a zero it_value would disarm the timer instead of firing at once
+    entries.push({std::max<uint64_t>(at_ns, 1), sequence++, write});
+
+    rearm();
+
+    return write;
+}
+
+int WriteSchedule::fd()
+{
+    return timer_fd;
+}
+
+void WriteSchedule::fire(const std::function<bool(const std::string &)> &write)
+{
+    uint64_t expirations;
+    ::read(timer_fd, &expirations, sizeof(expirations));
+
+    std::lock_guard<std::mutex> lock(*mutex);
+
+    uint64_t now = common::monotonic_ns();
+
+    while (!entries.empty() && entries.top().deadline <= now)
+    {
+        Entry entry = entries.top();
+        entries.pop();
+
+        ScheduledWrite &scheduled = *entry.write;
+
+        if (scheduled.cancelled)
+        {
+            continue;
+        }
+
+        if (write(scheduled.data))
+        {
+            scheduled.fired_count++;
+        }
+        else
+        {
+            scheduled.missed_count++;
+        }
+
+        if (scheduled.period_ns == 0)
+        {
+            scheduled.done = true;
+            continue;
+        }
+
+        entry.deadline += scheduled.period_ns;
+
+        // late by more than a period, the periods in between are skipped rather than written in a burst
+        if (entry.deadline <= now)
+        {
+            uint64_t skipped = (now - entry.deadline) / scheduled.period_ns + 1;
+
+            scheduled.missed_count += skipped;
+            entry.deadline += skipped * scheduled.period_ns;
+        }
+
+        entry.sequence = sequence++;
+        entries.push(entry);
+    }
+
+    // the timerfd fired, so it is disarmed
+    armed = 0;
+
+    rearm();
+}
+
+void WriteSchedule::clear()
+{
+    std::lock_guard<std::mutex> lock(*mutex);
+
+    while (!entries.empty())
+    {
+        // cancel() would take the mutex again
+        entries.top().write->cancelled = true;
+        entries.pop();
+    }
+
+    rearm();
+}
+
+void WriteSchedule::rearm()
+{
+    // cancelled writes are dropped once they reach the top
+    while (!entries.empty() && entries.top().write->cancelled)
+    {
+        entries.pop();
+    }
+
+    uint64_t deadline = entries.empty() ? 0 : entries.top().deadline;
+
+    if (deadline == armed)
+    {
+        return;
+    }
+
+    struct itimerspec spec = {};
+
+    spec.it_value.tv_sec = deadline / 1000000000ULL;
+    spec.it_value.tv_nsec = deadline % 1000000000ULL;
+
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    armed = deadline;
+}
+
+#endif
@@ -0,0 +1,157 @@
+// C++20, see docs/INSTRUCTIONS.rst
+#include <common/coro.h>
+
+#ifdef LINUX
+
+#include <linux/loopback.h>
+
+#include <iostream>
+#include <string>
+
+using namespace async_pyserial;
+using namespace async_pyserial::common::coro;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::wstring widen(const std::string &name) {
+    return std::wstring(name.begin(), name.end());
+}
+
+Task<std::string> request(Port &port, std::string_view line) {
+    co_await port.write(line);
+
+    co_return co_await port.read_until("\r\n", 256);
+}
+
+Task<void> client(Port &port, Executor &executor) {
+    for (int i = 0; i < 20; i++) {
+        check(co_await request(port, "PING\r\n") == "PONG\r\n", "read_until returns the reply");
+    }
+
+    // back on the executor thread
+    co_await executor.schedule();
+
+    co_await port.write("QUIT\r\n");
+
+    std::string rest;
+
+    while (rest.size() < 3) {
+        rest += co_await port.read(3 - rest.size());
+    }
+
+    check(rest == "END", "read returns what was written");
+}
+
+Task<void> server(Port &port) {
+    while (true) {
+        std::string line = co_await port.read_until("\r\n", 256);
+
+        if (line == "QUIT\r\n") {
+            break;
+        }
+
+        // two writes, read back as one reply
+        co_await port.write("PO");
+        co_await port.write("NG\r\n");
+    }
+
+    co_await port.write("END");
+}
+
+Task<void> reader(Port &port, bool &cancelled) {
+    try {
+        co_await port.read(1);
+    } catch (const common::SerialPortException &) {
+        cancelled = true;
+    }
+}
+
+Task<void> canceller(Port &port) {
+    port.cancel();
+
+    co_return;
+}
+
+Task<void> failing() {
+    throw common::SerialPortException("failing task");
+
+    co_return;
+}
+
+int main() {
+    internal::Loopback loopback(internal::LoopbackOptions{});
+
+    auto pairs = loopback.open(1);
+
+    base::SerialPortOptions options{};
+    options.baudrate = 115200;
+    options.bytesize = 8;
+    options.stopbits = 1;
+    options.parity = 0;
+
+    internal::SerialPort a(widen(pairs[0].port_a), options);
+    internal::SerialPort b(widen(pairs[0].port_b), options);
+
+    {
+        Port port_a(a);
+        Port port_b(b);
+
+        a.open();
+        b.open();
+
+        Executor executor;
+
+        executor.spawn(server(port_b));
+        executor.spawn(client(port_a, executor));
+        executor.run();
+
+        // the reader waits before the canceller runs, spawned tasks start in order
+        bool cancelled = false;
+
+        executor.spawn(reader(port_a, cancelled));
+        executor.spawn(canceller(port_a));
+        executor.run();
+
+        check(cancelled, "cancel fails the waiting read");
+
+        Executor failing_executor;
+
+        failing_executor.spawn(failing());
+
+        bool rethrown = false;
+
+        try {
+            failing_executor.run();
+        } catch (const common::SerialPortException &) {
+            rethrown = true;
+        }
+
+        check(rethrown, "run rethrows the exception of a task");
+
+        a.close();
+        b.close();
+    }
+
+    loopback.close();
+
+    if (failures == 0) {
+        std::cout << "coro_test passed" << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include <common/trace.h>
+
+#include <iostream>
+#include <thread>
+
+using namespace async_pyserial::common;
+
+int main() {
+    trace::enable(16);
+
+    trace::set_thread_name("main");
+    trace::set_port_name(3, "/dev/ttyUSB0");
+
+    for (int i = 0; i < 20; i++) {
+        ASYNC_PYSERIAL_TRACE(trace::READ, trace::BEGIN, 3, 0);
+        ASYNC_PYSERIAL_TRACE(trace::READ, trace::END, 3, i);
+    }
+
+    std::thread worker([]() {
+        trace::set_thread_name("worker");
+
+        ASYNC_PYSERIAL_TRACE(trace::WRITE_SUBMIT, trace::INSTANT, -1, 42);
+    });
+
+    worker.join();
+
+    // closed and reused by another port
+    trace::clear_port_name(3);
+    ASYNC_PYSERIAL_TRACE(trace::READ, trace::INSTANT, 3, 0);
+
+    trace::set_port_name(3, "/dev/ttyUSB1");
+    ASYNC_PYSERIAL_TRACE(trace::READ, trace::INSTANT, 3, 0);
+
+    trace::disable();
+
+    // not recorded
+    ASYNC_PYSERIAL_TRACE(trace::WRITE, trace::BEGIN, 3, 0);
+
+    std::cout << trace::dump_chrome_json() << std::endl;
+
+    trace::clear();
+}
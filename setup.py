@@ -8,12 +8,16 @@ with open("README.rst", "r", encoding="utf-8") as fh:
     long_description = fh.read()
     
 
+os_specific_libraries = []
+
 if sys.platform.startswith('win32'):
     os_specific_macros = [('Win32', None)]
 elif sys.platform.startswith('darwin'):
     os_specific_macros = [('__darwin__', None)]
 elif sys.platform.startswith('linux'):
     os_specific_macros = [('LINUX', None)]
+    # openpty() for the loopback ports
+    os_specific_libraries = ['util']
 elif 'bsd' in sys.platform.system().lower():
     os_specific_macros = [('__bsd__', None)]
 else:
@@ -43,6 +47,7 @@ ext_modules = [
         language='c++',
         extra_compile_args=['/std:c++17'] if sys.platform == 'win32' else ['-std=c++17'],
         define_macros=os_specific_macros,
+        libraries=os_specific_libraries,
         extra_link_args=[],
     ),
 ]
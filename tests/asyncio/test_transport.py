@@ -0,0 +1,175 @@
+import pytest
+import sys
+import asyncio
+
+from async_pyserial import SerialPortOptions
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='serial transports are linux only')
+
+from async_pyserial.aio import create_serial_connection, open_serial_connection
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    yield port1, port2
+
+    loopback.close()
+
+class RecordingProtocol(asyncio.Protocol):
+    def __init__(self) -> None:
+        self.transport = None
+        self.received = bytearray()
+        self.batches = 0
+        self.data_event = asyncio.Event()
+        self.lost = asyncio.get_running_loop().create_future()
+        self.paused = 0
+        self.resumed = 0
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def data_received(self, data):
+        self.received += data
+        self.batches += 1
+        self.data_event.set()
+
+    def pause_writing(self):
+        self.paused += 1
+
+    def resume_writing(self):
+        self.resumed += 1
+
+    def connection_lost(self, exc):
+        self.lost.set_result(exc)
+
+    async def wait_for(self, size, timeout=2):
+        async def wait():
+            while len(self.received) < size:
+                self.data_event.clear()
+                await self.data_event.wait()
+
+        await asyncio.wait_for(wait(), timeout)
+
+@pytest.mark.asyncio
+async def test_transport_read_write(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    loop = asyncio.get_running_loop()
+
+    transport1, protocol1 = await create_serial_connection(loop, RecordingProtocol, port1)
+    transport2, protocol2 = await create_serial_connection(loop, RecordingProtocol, port2)
+
+    await asyncio.sleep(0)
+
+    assert protocol1.transport is transport1
+    assert transport1.get_extra_info('serial') is not None
+
+    for i in range(100):
+        transport1.write(b'%03d' % i)
+
+    await protocol2.wait_for(300)
+
+    assert bytes(protocol2.received) == b''.join(b'%03d' % i for i in range(100))
+    # delivered in batches, not per write
+    assert protocol2.batches < 100
+
+    transport1.close()
+    transport2.close()
+
+    assert await asyncio.wait_for(protocol1.lost, 2) is None
+    assert await asyncio.wait_for(protocol2.lost, 2) is None
+
+@pytest.mark.asyncio
+async def test_transport_pause_reading(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    loop = asyncio.get_running_loop()
+
+    transport1, protocol1 = await create_serial_connection(loop, RecordingProtocol, port1)
+    transport2, protocol2 = await create_serial_connection(loop, RecordingProtocol, port2)
+
+    transport2.pause_reading()
+
+    assert not transport2.is_reading()
+
+    transport1.write(b'paused')
+
+    await asyncio.sleep(0.2)
+
+    assert protocol2.received == b''
+
+    transport2.resume_reading()
+
+    await protocol2.wait_for(6)
+
+    assert bytes(protocol2.received) == b'paused'
+
+    transport1.abort()
+    transport2.abort()
+
+    await asyncio.wait_for(protocol2.lost, 2)
+
+@pytest.mark.asyncio
+async def test_transport_write_buffer_limits(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    loop = asyncio.get_running_loop()
+
+    options = SerialPortOptions()
+    options.write_timeout = 1000
+
+    transport1, protocol1 = await create_serial_connection(loop, RecordingProtocol, port1, options)
+    transport2, protocol2 = await create_serial_connection(loop, RecordingProtocol, port2)
+
+    transport1.set_write_buffer_limits(high=1024, low=256)
+
+    assert transport1.get_write_buffer_limits() == (256, 1024)
+
+    transport1.write(b'x' * 65536)
+
+    assert protocol1.paused == 1
+
+    await protocol2.wait_for(65536, timeout=5)
+
+    # the completion wakes the loop
+    for _ in range(100):
+        if protocol1.resumed:
+            break
+
+        await asyncio.sleep(0.01)
+
+    assert protocol1.resumed == 1
+    assert transport1.get_write_buffer_size() == 0
+
+    transport1.close()
+    transport2.close()
+
+    await asyncio.wait_for(protocol1.lost, 2)
+
+@pytest.mark.asyncio
+async def test_open_serial_connection(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    reader1, writer1 = await open_serial_connection(port1)
+    reader2, writer2 = await open_serial_connection(port2)
+
+    writer1.write(b'AT\r\n')
+    await writer1.drain()
+
+    assert await asyncio.wait_for(reader2.readuntil(b'\r\n'), 2) == b'AT\r\n'
+
+    writer2.write(b'OK\r\n')
+    await writer2.drain()
+
+    assert await asyncio.wait_for(reader1.readuntil(b'\r\n'), 2) == b'OK\r\n'
+
+    writer1.close()
+    writer2.close()
+
+    await writer1.wait_closed()
+    await writer2.wait_closed()
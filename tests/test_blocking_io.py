@@ -0,0 +1,135 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='loopback ports are linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_read_timeout(virtual_serial_ports):
+    port1, _ = virtual_serial_ports
+
+    serial_port = SerialPort(port1, SerialPortOptions())
+    serial_port.open()
+
+    start = time.monotonic()
+
+    with pytest.raises(TimeoutError):
+        serial_port.read(16, timeout=0.1)
+
+    assert time.monotonic() - start >= 0.09
+
+    serial_port.close()
+
+def test_read_write_all(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    test_data = b'Hello, world!' * 100
+
+    sender.write_all(test_data, timeout=2)
+
+    received = b''
+
+    while len(received) < len(test_data):
+        received += receiver.read(len(test_data) - len(received), timeout=2)
+
+    assert received == test_data
+
+    sender.close()
+    receiver.close()
+
+def test_read_unblocked_by_close(virtual_serial_ports):
+    port1, _ = virtual_serial_ports
+
+    serial_port = SerialPort(port1, SerialPortOptions())
+    serial_port.open()
+
+    threading.Timer(0.1, serial_port.close).start()
+
+    with pytest.raises(SerialPortError):
+        serial_port.read(16)
+
+def test_write_all_not_open(virtual_serial_ports):
+    port1, _ = virtual_serial_ports
+
+    serial_port = SerialPort(port1, SerialPortOptions())
+
+    with pytest.raises(SerialPortError):
+        serial_port.write_all(b'data', timeout=1)
+
+def test_read_until(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    # delimiters split over writes
+    for chunk in [b'$GPGGA,123\r', b'\n$GPRMC', b',456\r\nAT', b'OK\r\n']:
+        sender.write_all(chunk, timeout=2)
+
+    assert receiver.read_until(b'\r\n', timeout=2) == b'$GPGGA,123\r\n'
+    assert receiver.read_until(b'\r\n', timeout=2) == b'$GPRMC,456\r\n'
+    assert receiver.read_until(b'\r\n', timeout=2) == b'ATOK\r\n'
+
+    sender.write_all(b'abcdef', timeout=2)
+
+    assert receiver.read_until(b'\n', max_bytes=4, timeout=2) == b'abcd'
+
+    with pytest.raises(TimeoutError):
+        receiver.read_until(b'\n', timeout=0.1)
+
+    assert receiver.read(16, timeout=2) == b'ef'
+
+    sender.close()
+    receiver.close()
+
+def test_lines(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    sender.write_all(b'one\ntwo\nthree\n', timeout=2)
+
+    threading.Timer(0.2, receiver.close).start()
+
+    assert list(receiver.lines()) == [b'one\n', b'two\n', b'three\n']
+
+    sender.close()
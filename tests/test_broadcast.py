@@ -0,0 +1,121 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortLagPolicy, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='subscriptions are linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def read_exactly(subscriber, size):
+    data = b''
+
+    while len(data) < size:
+        data += subscriber.read(size - len(data), timeout=2)
+
+    return data
+
+def test_subscribers_see_full_stream(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    parser = receiver.subscribe()
+    logger = receiver.subscribe()
+
+    data = bytes(range(256)) * 16
+
+    sender.write_all(data, timeout=2)
+
+    assert read_exactly(parser, len(data)) == data
+
+    buffer = bytearray(len(data))
+    view = memoryview(buffer)
+    size = 0
+
+    while size < len(data):
+        size += logger.read_into(view[size:], timeout=2)
+
+    assert bytes(buffer) == data
+
+    with pytest.raises(TimeoutError):
+        parser.read(timeout=0.1)
+
+    sender.close()
+    receiver.close()
+
+    # the port was closed
+    with pytest.raises(SerialPortError):
+        logger.read(timeout=1)
+
+def test_subscriber_lag_policies(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.broadcast_bufsize = 1024
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    skipping = receiver.subscribe(SerialPortLagPolicy.SKIP)
+    dropping = receiver.subscribe(SerialPortLagPolicy.DROP)
+
+    data = bytes(range(256)) * 8
+
+    sender.write_all(data, timeout=2)
+
+    # let everything arrive before the subscribers read
+    time.sleep(0.5)
+
+    received = b''
+
+    while len(received) + skipping.lost < len(data):
+        received += skipping.read(timeout=2)
+
+    # only the last buffered bytes are left
+    assert skipping.lost == len(data) - 1024
+    assert received == data[-1024:]
+
+    with pytest.raises(SerialPortError):
+        dropping.read(timeout=1)
+
+    assert dropping.is_dropped()
+
+    sender.close()
+    receiver.close()
+
+def test_subscriber_close_wakes_reader(virtual_serial_ports):
+    _, port2 = virtual_serial_ports
+
+    receiver = SerialPort(port2, SerialPortOptions())
+    receiver.open()
+
+    subscriber = receiver.subscribe()
+
+    threading.Timer(0.1, subscriber.close).start()
+
+    assert list(subscriber) == []
+
+    receiver.close()
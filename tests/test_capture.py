@@ -0,0 +1,93 @@
+import pytest
+import sys
+import os
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='capture log is linux only')
+
+from async_pyserial.loopback import Loopback
+from async_pyserial.capture import CaptureLog, read_segment, RX, TX
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_capture_log(virtual_serial_ports, tmp_path):
+    port1, port2 = virtual_serial_ports
+
+    device = SerialPort(port1, SerialPortOptions())
+    serial = SerialPort(port2, SerialPortOptions())
+
+    device.open()
+    serial.open()
+
+    log = CaptureLog(str(tmp_path), segment_size=4096)
+
+    serial.attach_capture_log(log, channel=7)
+
+    for i in range(50):
+        device.write(f'chunk{i:02};'.encode() * 4)
+        time.sleep(0.002)
+
+    serial.write(b'request')
+
+    time.sleep(0.05)
+
+    # the segment being written is readable up to its committed tail
+    assert list(read_segment(log.current_segment()))
+
+    serial.detach_capture_log()
+    log.close()
+
+    device.close()
+    serial.close()
+
+    segments = sorted(os.listdir(tmp_path))
+
+    # 50 * 40 bytes plus headers don't fit in one 4 KiB segment
+    assert len(segments) > 1
+    assert log.stats()['segments'] == len(segments)
+
+    rx = b''
+    tx = b''
+
+    for name in segments:
+        for ts_ns, channel, direction, data in read_segment(str(tmp_path / name)):
+            assert channel == 7
+
+            if direction == RX:
+                rx += data
+            else:
+                assert direction == TX
+                tx += data
+
+    assert rx == b''.join(f'chunk{i:02};'.encode() * 4 for i in range(50))
+    assert tx == b'request'
+
+def test_capture_log_max_segments(tmp_path):
+    log = CaptureLog(str(tmp_path), prefix='bounded', segment_size=4096, max_segments=2)
+
+    serial = SerialPort('/dev/null', SerialPortOptions())
+    serial.attach_capture_log(log)
+
+    log.close()
+
+    # a second run continues after the existing segments
+    log = CaptureLog(str(tmp_path), prefix='bounded', segment_size=4096, max_segments=2)
+    log.close()
+
+    log = CaptureLog(str(tmp_path), prefix='bounded', segment_size=4096, max_segments=2)
+    log.close()
+
+    assert sorted(os.listdir(tmp_path)) == ['bounded-00000001.seg', 'bounded-00000002.seg']
@@ -0,0 +1,38 @@
+import os
+import pytest
+import sys
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='list_ports is linux only')
+
+from async_pyserial.list_ports import list_ports
+from async_pyserial.loopback import Loopback
+
+def test_list_ports():
+    ports = list_ports()
+
+    assert [port.device for port in ports] == sorted(port.device for port in ports)
+
+    for port in ports:
+        assert port.device == f'/dev/{port.name}'
+        assert os.path.exists(f'/sys/class/tty/{port.name}/device')
+
+        if port.vid is not None:
+            assert port.subsystem in ('usb', 'usb-serial')
+            assert 0 <= port.vid <= 0xffff
+            assert 0 <= port.pid <= 0xffff
+
+def test_list_ports_cached():
+    first = [port.device for port in list_ports()]
+    second = [port.device for port in list_ports()]
+    refreshed = [port.device for port in list_ports(refresh=True)]
+
+    assert first == second == refreshed
+
+def test_list_ports_skips_ptys():
+    with Loopback() as loopback:
+        (port1, port2), = loopback.open(1)
+
+        devices = [port.device for port in list_ports(refresh=True)]
+
+        assert port1 not in devices
+        assert port2 not in devices
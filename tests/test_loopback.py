@@ -0,0 +1,240 @@
+import pytest
+import sys
+import time
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortReconfigure, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='loopback ports are linux only')
+
+from async_pyserial.loopback import Loopback, LoopbackOptions
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_loopback_open_close():
+    loopback = Loopback()
+
+    pairs = loopback.open(4)
+
+    assert len(pairs) == 4
+    assert loopback.is_open() == True
+
+    loopback.close()
+
+    assert loopback.is_open() == False
+
+def test_loopback_transfer(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+    options = SerialPortOptions()
+
+    sender = SerialPort(port1, options)
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    test_data = b'Hello, loopback!'
+    received = b''
+    event = threading.Event()
+
+    def on_data(data):
+        nonlocal received
+        received += data
+
+        if len(received) >= len(test_data):
+            event.set()
+
+    receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+    sender.write(test_data)
+
+    assert event.wait(timeout=2)
+    assert received == test_data
+
+    sender.close()
+    receiver.close()
+
+def test_loopback_line_rate():
+    options = LoopbackOptions()
+    options.baudrate = 9600
+    options.chunk_size = 4
+
+    with Loopback(options) as loopback:
+        (port1, port2), = loopback.open(1)
+
+        sender = SerialPort(port1, SerialPortOptions())
+        receiver = SerialPort(port2, SerialPortOptions())
+
+        sender.open()
+        receiver.open()
+
+        chunks = []
+        event = threading.Event()
+
+        def on_data(data):
+            chunks.append(data)
+
+            if sum(len(c) for c in chunks) >= 96:
+                event.set()
+
+        receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+        start = time.monotonic()
+
+        sender.write(b'x' * 96)
+
+        assert event.wait(timeout=2)
+
+        # 96 bytes at 960 bytes/s
+        assert time.monotonic() - start >= 0.08
+        assert max(len(c) for c in chunks) <= 4
+
+        sender.close()
+        receiver.close()
+
+def test_loopback_drop():
+    options = LoopbackOptions()
+    options.drop_rate = 1.0
+
+    with Loopback(options) as loopback:
+        (port1, port2), = loopback.open(1)
+
+        sender = SerialPort(port1, SerialPortOptions())
+        sender.open()
+
+        sender.write(b'dropped')
+
+        time.sleep(0.1)
+
+        stats = loopback.stats()
+
+        assert stats['forwarded'] == 0
+        assert stats['dropped'] == len(b'dropped')
+
+        sender.close()
+
+def test_read_budget(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_budget = 256
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    test_data = bytes(range(256)) * 40
+
+    chunks = []
+    event = threading.Event()
+
+    def on_data(data):
+        chunks.append(data)
+
+        if sum(len(c) for c in chunks) >= len(test_data):
+            event.set()
+
+    receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+    sender.write(test_data)
+
+    assert event.wait(timeout=2)
+    assert b''.join(chunks) == test_data
+    assert max(len(c) for c in chunks) <= 256
+
+    sender.close()
+    receiver.close()
+
+def test_reconfigure(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    received = b''
+    event = threading.Event()
+
+    def on_data(data):
+        nonlocal received
+        received += data
+
+        if len(received) >= 10:
+            event.set()
+
+    receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+    sender.write(b'hello')
+
+    options = SerialPortOptions()
+    options.baudrate = 115200
+
+    # the port stays open, the queued write goes out before the new settings apply
+    sender.reconfigure(options, SerialPortReconfigure.DRAIN)
+    receiver.reconfigure(options, SerialPortReconfigure.NOW)
+
+    assert sender.options.baudrate == 115200
+
+    sender.write(b'world')
+
+    assert event.wait(timeout=2)
+    assert received == b'helloworld'
+
+    options.baudrate = 12345
+
+    with pytest.raises(SerialPortError):
+        sender.reconfigure(options)
+
+    sender.close()
+    receiver.close()
+
+def test_reconfigure_drain_in_callback(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    errors = []
+    event = threading.Event()
+
+    options = SerialPortOptions()
+    options.baudrate = 115200
+
+    def on_data(data):
+        # DRAIN would wait for the I/O thread running this callback, NOW does not wait
+        try:
+            receiver.reconfigure(options, SerialPortReconfigure.DRAIN)
+        except SerialPortError as err:
+            errors.append(err)
+
+        receiver.reconfigure(options, SerialPortReconfigure.NOW)
+
+        event.set()
+
+    receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+    sender.write(b'hello')
+
+    assert event.wait(timeout=2)
+    assert errors
+
+    sender.close()
+    receiver.close()
@@ -0,0 +1,100 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortOverflowPolicy, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='overflow accounting is linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_overflow_drop(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 16
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    dropped = []
+    done = threading.Event()
+
+    def on_overflow(increment):
+        dropped.append(increment.dropped)
+
+        if sum(dropped) >= 48:
+            done.set()
+
+    receiver.on(SerialPortEvent.ON_OVERFLOW, on_overflow)
+
+    sender.open()
+    receiver.open()
+
+    data = bytes(range(64))
+
+    sender.write_all(data, timeout=2)
+
+    assert done.wait(2)
+    assert sum(dropped) == 48
+
+    assert receiver.read(64, timeout=2) == data[:16]
+
+    stats = receiver.receive_stats()
+
+    assert stats.dropped == 48
+    # ptys have no driver counters
+    assert stats.overrun == 0
+
+    sender.close()
+    receiver.close()
+
+def test_overflow_pause(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 16
+    options.overflow_policy = SerialPortOverflowPolicy.PAUSE
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    overflows = []
+
+    receiver.on(SerialPortEvent.ON_OVERFLOW, lambda increment: overflows.append(increment))
+
+    sender.open()
+    receiver.open()
+
+    data = bytes(range(256)) * 4
+
+    sender.write_all(data, timeout=2)
+
+    # reading stopped, the rest waits in the kernel
+    time.sleep(0.1)
+
+    received = b''
+
+    while len(received) < len(data):
+        received += receiver.read(8, timeout=2)
+
+    assert received == data
+    assert overflows == []
+    assert receiver.receive_stats().dropped == 0
+
+    sender.close()
+    receiver.close()
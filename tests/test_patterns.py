@@ -0,0 +1,119 @@
+import pytest
+import sys
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='pattern matching is linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_watch_matches_across_chunks(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    patterns = [b'ALARM', b'\x7e\x7e', b'ARM']
+
+    found = []
+    calls = []
+    done = threading.Event()
+
+    def on_match(matches):
+        calls.append(len(matches))
+        found.extend((patterns[match.pattern], match.offset, match.context, match.context_offset) for match in matches)
+
+        if len(found) >= 4:
+            done.set()
+
+    watch = receiver.watch(patterns, on_match, context=4)
+
+    noise = b'.' * 1000
+    data = noise + b'ALARM' + noise + b'\x7e\x7e\x7e' + noise
+
+    # split inside the patterns
+    for i in range(0, len(data), 7):
+        sender.write_all(data[i:i + 7], timeout=2)
+
+    assert done.wait(2)
+
+    first = len(noise)
+    second = 2 * len(noise) + 5
+
+    expected = [
+        (b'ALARM', first, b'....ALARM....', 4),
+        (b'ARM', first + 2, b'..ALARM....', 4),
+        (b'\x7e\x7e', second, b'....\x7e\x7e\x7e...', 4),
+        (b'\x7e\x7e', second + 1, b'...\x7e\x7e\x7e....', 4),
+    ]
+
+    # reported with the chunk completing them, the context after a match ends with that chunk
+    for match, (pattern, offset, context, context_offset) in zip(sorted(found, key=lambda match: (match[1], match[0])), expected):
+        assert match[0] == pattern and match[1] == offset and match[3] == context_offset
+        assert context.startswith(match[2]) and len(match[2]) >= context_offset + len(pattern)
+
+    # python is only woken for chunks completing matches
+    assert sum(calls) == 4 and len(calls) <= 4
+
+    assert watch.matches() == 4
+    assert watch.position() == len(data)
+
+    watch.close()
+
+    sender.close()
+    receiver.close()
+
+def test_watch_reports_match_without_trailing_bytes(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    found = []
+    done = threading.Event()
+
+    def on_match(matches):
+        found.extend(match.context for match in matches)
+        done.set()
+
+    watch = receiver.watch([b'OK'], on_match, context=16)
+
+    # a prompt followed by silence
+    sender.write_all(b'AT\r\nOK', timeout=2)
+
+    assert done.wait(2)
+
+    assert found == [b'AT\r\nOK']
+
+    watch.close()
+
+    sender.close()
+    receiver.close()
+
+def test_watch_rejects_empty_patterns(virtual_serial_ports):
+    _, port2 = virtual_serial_ports
+
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    with pytest.raises(SerialPortError):
+        receiver.watch([b''], lambda matches: None)
@@ -0,0 +1,125 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='the poll scheduler is linux only')
+
+from async_pyserial.loopback import Loopback
+from async_pyserial.poll import PollScheduler
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def answer(device, stop, silent):
+    # a bus of slaves answering b'Q<n>\n' with b'R<n>\n', except the silent ones
+    while not stop.is_set():
+        try:
+            request = device.read_until(b'\n', timeout=0.05)
+        except TimeoutError:
+            continue
+
+        if request[1:-1] not in silent:
+            device.write(b'R' + request[1:])
+
+def test_poll_table(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    master = SerialPort(port1, SerialPortOptions())
+    device = SerialPort(port2, SerialPortOptions())
+
+    master.open()
+    device.open()
+
+    stop = threading.Event()
+    responder = threading.Thread(target=answer, args=(device, stop, {b'3'}))
+    responder.start()
+
+    results = []
+
+    def on_results(batch):
+        results.extend(batch)
+
+    table = [
+        (master, b'Q1\n', b'\n', 0.02, 0.2, 'one'),
+        (master, b'Q2\n', 3, 0.02, 0.2, 'two'),
+        (master, b'Q3\n', b'\n', 0.05, 0.05, 'silent'),
+    ]
+
+    with PollScheduler(on_results, table, max_results=16, max_delay=0.01) as scheduler:
+        time.sleep(0.5)
+
+        stats = scheduler.stats()
+
+    stop.set()
+    responder.join()
+
+    by_key = {}
+
+    for key, status, response, latency in results:
+        by_key.setdefault(key, []).append((status, response))
+        assert latency >= 0
+
+    assert by_key['one'] and all(result == (PollScheduler.OK, b'R1\n') for result in by_key['one'])
+    assert by_key['two'] and all(result == (PollScheduler.OK, b'R2\n') for result in by_key['two'])
+    assert by_key['silent'] and all(result == (PollScheduler.TIMEOUT, b'') for result in by_key['silent'])
+
+    # every entry keeps its period, none is starved by the others
+    assert 5 <= len(by_key['one']) <= 30
+    assert 5 <= len(by_key['two']) <= 30
+
+    assert stats.responses >= len(by_key['one']) + len(by_key['two']) - 2
+    assert stats.errors == 0
+
+    master.close()
+    device.close()
+
+def test_poll_changes_only(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    master = SerialPort(port1, SerialPortOptions())
+    device = SerialPort(port2, SerialPortOptions())
+
+    master.open()
+    device.open()
+
+    stop = threading.Event()
+    responder = threading.Thread(target=answer, args=(device, stop, set()))
+    responder.start()
+
+    results = []
+
+    scheduler = PollScheduler(results.extend, changes_only=True)
+
+    with pytest.raises(ValueError):
+        scheduler.add(master, b'Q1\n', b'')
+
+    scheduler.add(master, b'Q1\n', b'\n', period=0.01, key='one')
+
+    time.sleep(0.3)
+
+    scheduler.close()
+
+    stop.set()
+    responder.join()
+
+    assert results == [('one', PollScheduler.OK, b'R1\n', results[0][3])]
+    assert scheduler.stats().suppressed >= 5
+
+    with pytest.raises(SerialPortError):
+        scheduler.add(master, b'Q1\n', b'\n')
+
+    master.close()
+    device.close()
@@ -0,0 +1,136 @@
+import pytest
+import sys
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='the loopback is linux only')
+
+from async_pyserial.loopback import Loopback
+from async_pyserial.group import PortGroup
+
+# Fixture to set up and tear down pairs of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    pairs = loopback.open(3)
+
+    set_async_worker('none')
+
+    yield pairs
+
+    loopback.close()
+
+def test_group_batches_data(virtual_serial_ports):
+    senders = [SerialPort(a, SerialPortOptions()) for a, _ in virtual_serial_ports]
+    receivers = [SerialPort(b, SerialPortOptions()) for _, b in virtual_serial_ports]
+
+    for serial in senders + receivers:
+        serial.open()
+
+    received = {}
+    batches = []
+    done = threading.Event()
+
+    size = 4096
+
+    def on_events(events):
+        batches.append(len(events))
+
+        for key, kind, payload in events:
+            assert kind == PortGroup.DATA
+            received[key] = received.get(key, b'') + payload
+
+        if all(len(received.get(i, b'')) >= size for i in range(len(receivers))):
+            done.set()
+
+    listener_calls = []
+    receivers[0].on(SerialPortEvent.ON_DATA, listener_calls.append)
+
+    group = PortGroup(on_events, max_events=64, max_delay=0.01)
+
+    for i, serial in enumerate(receivers):
+        group.add(serial, i)
+
+    data = bytes(range(256)) * (size // 256)
+
+    for serial in senders:
+        for i in range(0, size, 64):
+            serial.write_all(data[i:i + 64], timeout=2)
+
+    assert done.wait(2)
+
+    assert received == {i: data for i in range(len(receivers))}
+    assert sum(batches) > len(batches)
+
+    # the group took over the listener
+    assert listener_calls == []
+
+    group.close()
+
+    for serial in senders + receivers:
+        serial.close()
+
+def test_group_write_completions(virtual_serial_ports):
+    (port1, _), = virtual_serial_ports[:1]
+
+    sender = SerialPort(port1, SerialPortOptions())
+    sender.open()
+
+    events = []
+    results = []
+    done = threading.Event()
+
+    def on_events(batch):
+        events.extend(batch)
+
+        if len(events) >= 3:
+            done.set()
+
+    with PortGroup(on_events, max_events=16, max_delay=0.005) as group:
+        group.add(sender, 'tx')
+
+        for i in range(3):
+            sender.write(b'ping', lambda err, i=i: results.append((i, err)))
+
+        assert done.wait(2)
+
+        # the write callbacks ran before the group callback, in order
+        assert results == [(0, None), (1, None), (2, None)]
+        assert events == [('tx', PortGroup.WRITE, 0)] * 3
+
+        with pytest.raises(SerialPortError):
+            PortGroup(lambda batch: None).add(sender)
+
+    sender.close()
+
+def test_group_add_after_remove(virtual_serial_ports):
+    (port1, _), = virtual_serial_ports[:1]
+
+    sender = SerialPort(port1, SerialPortOptions())
+    sender.open()
+
+    keys = []
+    delivered = threading.Semaphore(0)
+
+    def on_events(batch):
+        keys.extend(key for key, _, _ in batch)
+
+        for _ in batch:
+            delivered.release()
+
+    with PortGroup(on_events, max_events=1, max_delay=0) as group:
+        # the entries of removed ports are reused, each event still has the key of its add()
+        for i in range(50):
+            group.add(sender, i)
+
+            sender.write(b'ping', lambda err: None)
+
+            assert delivered.acquire(timeout=2)
+
+            group.remove(sender)
+
+        assert keys == list(range(50))
+
+    sender.close()
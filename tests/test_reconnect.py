@@ -0,0 +1,117 @@
+import os
+import pytest
+import sys
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortReconnectPolicy, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='reconnect is linux only')
+
+from async_pyserial.loopback import Loopback
+
+def relink(target, link):
+    # like udev, the symlink is replaced atomically
+    os.symlink(target, f'{link}.new')
+    os.replace(f'{link}.new', link)
+
+def test_reconnect(tmp_path):
+    set_async_worker('none')
+
+    link = str(tmp_path / 'serial0')
+
+    first = Loopback()
+    (port1, port2), = first.open(1)
+
+    os.symlink(port2, link)
+
+    options = SerialPortOptions()
+    options.reconnect = True
+    options.reconnect_write_policy = SerialPortReconnectPolicy.BUFFER_WRITES
+
+    serial_port = SerialPort(link, options)
+
+    disconnected = threading.Event()
+    reconnected = threading.Event()
+
+    serial_port.on(SerialPortEvent.ON_DISCONNECT, lambda: disconnected.set())
+    serial_port.on(SerialPortEvent.ON_RECONNECT, lambda: reconnected.set())
+
+    serial_port.open()
+
+    # unplug
+    first.close()
+
+    assert disconnected.wait(timeout=2)
+    assert serial_port.is_connected() == False
+
+    written = threading.Event()
+
+    serial_port.write(b'buffered', lambda err: written.set())
+
+    # plug in again
+    second = Loopback()
+    (port1, port2), = second.open(1)
+
+    peer = SerialPort(port1, SerialPortOptions())
+    peer.open()
+
+    received = b''
+    event = threading.Event()
+
+    def on_data(data):
+        nonlocal received
+        received += data
+
+        if len(received) >= len(b'buffered'):
+            event.set()
+
+    peer.on(SerialPortEvent.ON_DATA, on_data)
+
+    relink(port2, link)
+
+    assert reconnected.wait(timeout=2)
+    assert serial_port.is_connected() == True
+
+    assert written.wait(timeout=2)
+    assert event.wait(timeout=2)
+    assert received == b'buffered'
+
+    peer.close()
+    serial_port.close()
+
+    second.close()
+
+def test_disconnect_fail_writes(tmp_path):
+    set_async_worker('none')
+
+    loopback = Loopback()
+    (port1, port2), = loopback.open(1)
+
+    options = SerialPortOptions()
+    options.reconnect = True
+
+    serial_port = SerialPort(port2, options)
+
+    disconnected = threading.Event()
+
+    serial_port.on(SerialPortEvent.ON_DISCONNECT, lambda: disconnected.set())
+
+    serial_port.open()
+
+    loopback.close()
+
+    assert disconnected.wait(timeout=2)
+
+    results = []
+    done = threading.Event()
+
+    def on_written(err):
+        results.append(err)
+        done.set()
+
+    serial_port.write(b'lost', on_written)
+
+    assert done.wait(timeout=2)
+    assert results[0] is not None
+
+    serial_port.close()
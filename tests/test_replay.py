@@ -0,0 +1,146 @@
+import pytest
+import sys
+import time
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='record and replay are linux only')
+
+from async_pyserial.loopback import Loopback
+from async_pyserial.replay import Replayer, ReplayOptions
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+@pytest.fixture
+def record_file(virtual_serial_ports, tmp_path):
+    port1, port2 = virtual_serial_ports
+
+    device = SerialPort(port1, SerialPortOptions())
+    serial = SerialPort(port2, SerialPortOptions())
+
+    device.open()
+    serial.open()
+
+    path = str(tmp_path / 'capture.bin')
+
+    serial.start_recording(path)
+
+    for i in range(5):
+        device.write(f'chunk{i};'.encode())
+        time.sleep(0.02)
+
+    serial.write(b'request')
+
+    time.sleep(0.05)
+
+    serial.stop_recording()
+
+    device.close()
+    serial.close()
+
+    return path
+
+def collect(serial, expected_size):
+    received = b''
+    event = threading.Event()
+
+    def on_data(data):
+        nonlocal received
+        received += data
+
+        if len(received) >= expected_size:
+            event.set()
+
+    serial.on(SerialPortEvent.ON_DATA, on_data)
+
+    return event, lambda: received
+
+EXPECTED = b'chunk0;chunk1;chunk2;chunk3;chunk4;'
+
+def test_replay_into_pty(record_file):
+    replayer = Replayer()
+
+    options = ReplayOptions()
+    options.speed = 0
+
+    path = replayer.add_pty(record_file, options)
+
+    serial = SerialPort(path, SerialPortOptions())
+    serial.open()
+
+    event, received = collect(serial, len(EXPECTED))
+
+    replayer.start()
+
+    assert replayer.wait(timeout=2)
+    assert event.wait(timeout=2)
+    assert received() == EXPECTED
+
+    serial.close()
+    replayer.stop()
+
+def test_replay_into_port_with_timing(record_file):
+    replayer = Replayer()
+
+    serial = SerialPort('/dev/null', SerialPortOptions())
+
+    event, received = collect(serial, len(EXPECTED))
+
+    replayer.add_port(record_file, serial)
+
+    start = time.monotonic()
+
+    replayer.start()
+
+    assert replayer.wait(timeout=2)
+
+    # the chunks were recorded about 20ms apart
+    assert time.monotonic() - start >= 0.06
+    assert received() == EXPECTED
+
+    replayer.stop()
+
+def test_replay_many(record_file):
+    replayer = Replayer()
+
+    options = ReplayOptions()
+    options.speed = 0
+    options.include_tx = True
+
+    count = [0]
+    lock = threading.Lock()
+
+    serials = []
+
+    for _ in range(50):
+        serial = SerialPort('/dev/null', SerialPortOptions())
+
+        def on_data(data):
+            with lock:
+                count[0] += len(data)
+
+        serial.on(SerialPortEvent.ON_DATA, on_data)
+
+        replayer.add_port(record_file, serial, options)
+
+        serials.append(serial)
+
+    replayer.start()
+
+    assert replayer.wait(timeout=5)
+    assert replayer.active() == 0
+    assert count[0] == 50 * (len(EXPECTED) + len(b'request'))
+
+    replayer.stop()
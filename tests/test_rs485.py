@@ -0,0 +1,105 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortRS485, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='rs485 is linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def echo_bus(device, stop):
+    # a transceiver that hears its own transmissions, and a slave answering every line
+    while not stop.is_set():
+        try:
+            request = device.read_until(b'\n', timeout=0.05)
+        except TimeoutError:
+            continue
+
+        device.write(request + b'ACK\n')
+
+def test_rs485_software_fallback_suppresses_echo(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+    options.rs485 = SerialPortRS485.KERNEL
+    options.rs485_delay_after_send = 20
+    options.rs485_suppress_echo = True
+
+    master = SerialPort(port1, options)
+    device = SerialPort(port2, SerialPortOptions())
+
+    master.open()
+    device.open()
+
+    # a pty has no RS-485 mode
+    assert master.rs485_mode() == SerialPortRS485.SOFTWARE
+
+    stop = threading.Event()
+    bus = threading.Thread(target=echo_bus, args=(device, stop))
+    bus.start()
+
+    done = threading.Event()
+    start = time.monotonic()
+
+    master.write(b'READ 1\n', callback=lambda err: done.set())
+
+    assert done.wait(timeout=2)
+    # completed once the bus was released
+    assert time.monotonic() - start >= 0.02
+
+    assert master.read_until(b'\n', timeout=2) == b'ACK\n'
+
+    master.write(b'READ 2\n')
+
+    assert master.read_until(b'\n', timeout=2) == b'ACK\n'
+
+    stop.set()
+    bus.join()
+
+    master.close()
+    device.close()
+
+def test_rs485_off_keeps_echo(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+
+    master = SerialPort(port1, options)
+    device = SerialPort(port2, SerialPortOptions())
+
+    master.open()
+    device.open()
+
+    assert master.rs485_mode() == SerialPortRS485.OFF
+
+    stop = threading.Event()
+    bus = threading.Thread(target=echo_bus, args=(device, stop))
+    bus.start()
+
+    master.write(b'READ 1\n')
+
+    assert master.read_until(b'\n', timeout=2) == b'READ 1\n'
+    assert master.read_until(b'\n', timeout=2) == b'ACK\n'
+
+    stop.set()
+    bus.join()
+
+    master.close()
+    device.close()
@@ -0,0 +1,100 @@
+import pytest
+import sys
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortError, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='scheduled writes are linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_schedule_write_in_deadline_order(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    now = time.monotonic_ns()
+
+    second = sender.schedule_write(b'second', now + 60_000_000)
+    first = sender.schedule_write(b'first', now + 20_000_000)
+    cancelled = sender.schedule_write(b'cancelled', now + 40_000_000)
+
+    cancelled.cancel()
+
+    received = b''
+
+    while len(received) < len(b'firstsecond'):
+        received += receiver.read(len(b'firstsecond') - len(received), timeout=2)
+
+    assert received == b'firstsecond'
+    # the writes were not queued before they were due
+    assert time.monotonic_ns() - now >= 60_000_000
+
+    assert not first.active() and first.fired() == 1
+    assert not second.active() and second.fired() == 1
+    assert not cancelled.active() and cancelled.fired() == 0
+
+    sender.close()
+    receiver.close()
+
+def test_write_periodic_until_cancelled(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, SerialPortOptions())
+
+    sender.open()
+    receiver.open()
+
+    with pytest.raises(ValueError):
+        sender.write_periodic(b'ping', 0)
+
+    heartbeat = sender.write_periodic(b'ping', 10_000)
+
+    time.sleep(0.2)
+
+    heartbeat.cancel()
+    fired = heartbeat.fired()
+
+    time.sleep(0.05)
+
+    assert not heartbeat.active()
+    assert heartbeat.fired() == fired
+    # deadlines do not drift, so only late wakeups lose periods
+    assert fired + heartbeat.missed() >= 15
+
+    size = fired * len(b'ping')
+    received = b''
+
+    while len(received) < size:
+        received += receiver.read(size - len(received), timeout=2)
+
+    assert received == b'ping' * fired
+
+    forever = sender.write_periodic(b'ping', 10_000)
+
+    sender.close()
+    receiver.close()
+
+    # closing the port cancels its scheduled writes
+    assert not forever.active()
+
+    with pytest.raises(SerialPortError):
+        sender.schedule_write(b'closed')
@@ -0,0 +1,93 @@
+import errno
+import os
+import pytest
+import sys
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortSchedPolicy, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='worker thread options are linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_thread_options_default(virtual_serial_ports):
+    port1, _ = virtual_serial_ports
+
+    serial_port = SerialPort(port1, SerialPortOptions())
+    serial_port.open()
+
+    status = serial_port.thread_status()
+
+    assert status.applied
+    assert status.name == f'serial:{os.path.basename(port1)}'[:15]
+    assert status.affinity_error == 0
+    assert status.sched_error == 0
+
+    serial_port.close()
+
+def test_thread_options_applied(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    cpu = sorted(os.sched_getaffinity(0))[0]
+
+    options = SerialPortOptions()
+    options.cpu_affinity = [cpu]
+    options.thread_name = 'serial-test'
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    status = receiver.thread_status()
+
+    assert status.affinity_error == 0
+    assert status.cpu_affinity == [cpu]
+    assert status.name == 'serial-test'
+
+    # the pinned worker still delivers data
+    event = threading.Event()
+
+    receiver.on(SerialPortEvent.ON_DATA, lambda data: event.set())
+
+    sender.write(b'pinned')
+
+    assert event.wait(timeout=2)
+
+    sender.close()
+    receiver.close()
+
+def test_thread_options_degrade(virtual_serial_ports):
+    port1, _ = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.cpu_affinity = [1 << 20]
+    options.sched_policy = SerialPortSchedPolicy.FIFO
+    options.sched_priority = 1000
+
+    serial_port = SerialPort(port1, options)
+
+    # invalid or unpermitted options never fail the open
+    serial_port.open()
+
+    status = serial_port.thread_status()
+
+    assert status.affinity_error == errno.EINVAL
+    assert status.sched_error in (errno.EINVAL, errno.EPERM)
+    assert status.sched_policy == SerialPortSchedPolicy.OTHER
+
+    serial_port.close()
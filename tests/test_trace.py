@@ -0,0 +1,82 @@
+import pytest
+import subprocess
+import time
+import json
+import os
+
+from async_pyserial import SerialPort, SerialPortOptions, set_async_worker
+from async_pyserial import trace
+
+from tests.test_util import get_port_pair
+
+# Fixture to set up and tear down a pair of virtual serial ports using socat
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    port1, port2 = get_port_pair()
+
+    # Create virtual serial ports using socat
+    socat_process = subprocess.Popen([
+        'socat', '-d', '-d', f'PTY,link={port1},raw,echo=0', f'PTY,link={port2},raw,echo=0'
+    ], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+    # Give socat some time to set up the ports
+    time.sleep(2)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    # Terminate the socat process and clean up
+    socat_process.terminate()
+    socat_process.wait()
+
+    if os.path.exists(port1):
+        os.remove(port1)
+    if os.path.exists(port2):
+        os.remove(port2)
+
+def test_trace_disabled_records_nothing():
+    trace.disable()
+    trace.clear()
+
+    events = json.loads(trace.dump())['traceEvents']
+
+    assert all(evt['ph'] == 'M' for evt in events)
+
+def test_trace_dump(virtual_serial_ports, tmp_path):
+    port1, port2 = virtual_serial_ports
+
+    trace.clear()
+    trace.enable()
+
+    options = SerialPortOptions()
+    options.read_bufsize = 512
+    serial = SerialPort(port1, options)
+    serial.open()
+
+    serial.write(b'Hello, world!')
+
+    with open(port2, 'rb') as f:
+        f.read(13)
+
+    with open(port2, 'wb') as f:
+        f.write(b'Hello, trace!')
+
+    assert serial.read() == b'Hello, trace!'
+
+    serial.close()
+
+    trace.disable()
+
+    path = tmp_path / 'trace.json'
+
+    data = trace.dump(str(path))
+
+    assert json.loads(path.read_text()) == json.loads(data)
+
+    names = {evt['name'] for evt in json.loads(data)['traceEvents']}
+
+    for name in ('epoll_wakeup', 'read', 'write', 'write_submit', 'gil_acquire', 'py_callback'):
+        assert name in names
+
+    trace.clear()
@@ -0,0 +1,83 @@
+import pytest
+import sys
+import threading
+import time
+
+from async_pyserial import SerialPort, SerialPortOptions, SerialPortEvent, SerialPortIOEngine, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='io_uring is linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down virtual serial port pairs using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    pairs = loopback.open(8)
+
+    set_async_worker('none')
+
+    yield pairs
+
+    loopback.close()
+
+def uring_options():
+    options = SerialPortOptions()
+    options.io_engine = SerialPortIOEngine.IO_URING
+
+    return options
+
+def test_uring_many_ports(virtual_serial_ports):
+    senders = []
+    receivers = []
+
+    expected = b''.join(f'message{i};'.encode() for i in range(50))
+
+    events = []
+
+    for port1, port2 in virtual_serial_ports:
+        sender = SerialPort(port1, uring_options())
+        receiver = SerialPort(port2, uring_options())
+
+        sender.open()
+        receiver.open()
+
+        # falls back to epoll where io_uring is disabled, the rest must behave the same
+        assert receiver.io_engine() in (SerialPortIOEngine.EPOLL, SerialPortIOEngine.IO_URING)
+
+        received = []
+        event = threading.Event()
+
+        def on_data(data, received=received, event=event):
+            received.append(data)
+
+            if len(b''.join(received)) >= len(expected):
+                event.set()
+
+        receiver.on(SerialPortEvent.ON_DATA, on_data)
+
+        senders.append(sender)
+        receivers.append(receiver)
+        events.append((event, received))
+
+    completed = []
+
+    for i in range(50):
+        for sender in senders:
+            sender.write(f'message{i};'.encode(), callback=lambda err: completed.append(err))
+
+    for event, received in events:
+        assert event.wait(timeout=5)
+        assert b''.join(received) == expected
+
+    # the last callbacks may still be on their way after the data arrived
+    deadline = time.monotonic() + 2
+
+    while len(completed) < 50 * len(senders) and time.monotonic() < deadline:
+        time.sleep(0.01)
+
+    for port in senders + receivers:
+        port.close()
+
+    assert completed == [None] * (50 * len(senders))
@@ -0,0 +1,172 @@
+import pytest
+import sys
+import threading
+
+from async_pyserial import SerialPort, SerialPortOptions, set_async_worker
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith('linux'), reason='write stats are linux only')
+
+from async_pyserial.loopback import Loopback
+
+# Fixture to set up and tear down a pair of virtual serial ports using the native loopback
+@pytest.fixture(scope="module")
+def virtual_serial_ports():
+    loopback = Loopback()
+
+    (port1, port2), = loopback.open(1)
+
+    set_async_worker('none')
+
+    yield port1, port2
+
+    loopback.close()
+
+def test_small_writes_reuse_pooled_requests(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 1 << 16
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    done = threading.Semaphore(0)
+    errors = []
+
+    def written(err):
+        if err is not None:
+            errors.append(err)
+
+        done.release()
+
+    expected = b''
+
+    for round in range(20):
+        for i in range(50):
+            # every tenth payload is too large to be stored in the request
+            data = bytes([i]) * (200 if i % 10 == 0 else 16)
+            expected += data
+
+            sender.write(memoryview(bytearray(data)), callback=written)
+
+        for _ in range(50):
+            assert done.acquire(timeout=2)
+
+    received = b''
+
+    while len(received) < len(expected):
+        received += receiver.read(len(expected) - len(received), timeout=2)
+
+    assert errors == []
+    assert received == expected
+
+    stats = sender.write_stats()
+
+    assert stats.requests == 1000
+    assert stats.heap_payloads == 100
+    # at most 50 writes are queued at once, so the first slab is never outgrown
+    assert stats.slab_allocations == 1
+    assert stats.pooled == 64
+
+    sender.close()
+    receiver.close()
+
+def test_concurrent_writers_keep_their_order(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 1 << 20
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    # more writes than the submission queue holds, writers may find it full
+    count = 2000
+    done = threading.Semaphore(0)
+
+    def writer(index):
+        for seq in range(count):
+            sender.write(b'%d:%05d\n' % (index, seq), callback=lambda err: done.release())
+
+    threads = [threading.Thread(target=writer, args=(index,)) for index in range(4)]
+
+    for thread in threads:
+        thread.start()
+
+    for thread in threads:
+        thread.join()
+
+    for _ in range(4 * count):
+        assert done.acquire(timeout=5)
+
+    size = 4 * count * 8
+    received = b''
+
+    while len(received) < size:
+        received += receiver.read(size - len(received), timeout=2)
+
+    sequences = {}
+
+    for line in received.splitlines():
+        index, seq = line.split(b':')
+        sequences.setdefault(index, []).append(int(seq))
+
+    assert len(sequences) == 4
+    assert all(seqs == list(range(count)) for seqs in sequences.values())
+
+    sender.close()
+    receiver.close()
+
+def test_write_many_is_one_request(virtual_serial_ports):
+    port1, port2 = virtual_serial_ports
+
+    options = SerialPortOptions()
+    options.read_bufsize = 4096
+
+    sender = SerialPort(port1, SerialPortOptions())
+    receiver = SerialPort(port2, options)
+
+    sender.open()
+    receiver.open()
+
+    header = b'\x02\x10'
+    payload = bytearray(range(100))
+    trailer = memoryview(b'\xab\xcd')
+
+    results = []
+    done = threading.Event()
+
+    def written(err):
+        results.append(err)
+        done.set()
+
+    before = sender.write_stats().requests
+
+    sender.write_many([header, payload, trailer], callback=written)
+
+    assert done.wait(timeout=2)
+    assert results == [None]
+
+    sender.write_many([b'sync', b''])
+
+    assert sender.write_stats().requests == before + 2
+
+    expected = header + bytes(payload) + bytes(trailer) + b'sync'
+    received = b''
+
+    while len(received) < len(expected):
+        received += receiver.read(len(expected) - len(received), timeout=2)
+
+    assert received == expected
+
+    with pytest.raises(ValueError):
+        sender.write_many([memoryview(b'abcdef')[::2]])
+
+    sender.close()
+    receiver.close()